@@ -0,0 +1,118 @@
+/**
+ *	@file sdd_stable_pool.h	Value storage shared by the value-stable maps.
+ *	@date					18. Oct 2026
+ *	@author					Mihkel Aaremäe
+ */
+#ifndef SDD_STABLE_POOL_H
+#define SDD_STABLE_POOL_H
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+ *	@cond false
+ */
+
+/**
+ *	@brief	Chunks of values that are never reallocated.
+ */
+typedef struct sdd_stable_pool
+{
+	/**
+	 *	Newest chunk of values, every chunk starts with a pointer to the
+	 *	chunk before it.
+	 */
+	void *chunks;
+
+	/**
+	 *	Erased values, every one starts with a pointer to the next one.
+	 */
+	void *free_values;
+
+	/**
+	 *	How many values the newest chunk has room for.
+	 */
+	size_t chunk_capacity;
+
+	/**
+	 *	How many values of the newest chunk have been handed out.
+	 */
+	size_t chunk_used;
+} sdd_stable_pool;
+
+#define detail_sdd_stable_pool_round_up(size, align) (((size) + (align) - 1) / (align) * (align))
+
+static inline void detail_sdd_stable_pool_new(sdd_stable_pool *pool)
+{
+	pool->chunks = NULL;
+	pool->free_values = NULL;
+	pool->chunk_capacity = 0;
+	pool->chunk_used = 0;
+}
+
+/*Returns NULL only if malloc_func did*/
+static inline void *detail_sdd_stable_pool_alloc(
+	sdd_stable_pool *pool,
+	size_t value_size,
+	size_t value_align,
+	size_t first_capacity,
+	void *(*malloc_func)(size_t))
+{
+	void *result;
+	void *chunk;
+	size_t align;
+	size_t cell_size;
+	size_t offset;
+	size_t capacity;
+	if (pool->free_values != NULL)
+	{
+		result = pool->free_values;
+		memcpy(&pool->free_values, result, sizeof(void *));
+		return result;
+	}
+	/*Erased values link the free list through their first bytes*/
+	align = value_align > _Alignof(void *) ? value_align : _Alignof(void *);
+	cell_size = detail_sdd_stable_pool_round_up(value_size > sizeof(void *) ? value_size : sizeof(void *), align);
+	offset = detail_sdd_stable_pool_round_up(sizeof(void *), align);
+	if (pool->chunk_used == pool->chunk_capacity)
+	{
+		/*Chunks double in size and are never reallocated, so values never move*/
+		capacity = pool->chunk_capacity > 0 ? pool->chunk_capacity * 2 : first_capacity;
+		chunk = malloc_func(offset + capacity * cell_size);
+		if (chunk == NULL)
+		{
+			return NULL;
+		}
+		pool->chunk_capacity = capacity;
+		pool->chunk_used = 0;
+		memcpy(chunk, &pool->chunks, sizeof(void *));
+		pool->chunks = chunk;
+	}
+	return (char *)pool->chunks + offset + cell_size * pool->chunk_used++;
+}
+
+static inline void detail_sdd_stable_pool_release(sdd_stable_pool *pool, void *value)
+{
+	memcpy(value, &pool->free_values, sizeof(void *));
+	pool->free_values = value;
+}
+
+static inline void detail_sdd_stable_pool_delete(sdd_stable_pool *pool, void (*free_func)(void *))
+{
+	void *chunk;
+	void *previous;
+	chunk = pool->chunks;
+	while (chunk != NULL)
+	{
+		memcpy(&previous, chunk, sizeof(void *));
+		free_func(chunk);
+		chunk = previous;
+	}
+	detail_sdd_stable_pool_new(pool);
+}
+
+/**
+ *	@endcond
+ */
+
+#endif
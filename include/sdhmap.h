@@ -98,7 +98,8 @@
 #ifndef sdhmap_index
 /**
  * A user-defineable type for indexes in the map, defaults to uint32_t.
- * This type is also used interchangeably for hash types.
+ * This type is also used interchangeably for hash types. uint16_t shrinks
+ * the slots of small maps.
  */
 #define sdhmap_index uint32_t
 #endif
@@ -163,6 +164,46 @@
 			}) * element_count + \
 		sizeof(void *) - 1) / sizeof(void *)])
 
+/**
+ *	@hideinitializer
+ *	@brief		Inline-type simple dynamic hashmap type generator
+ *
+ *	@details	Inline-type maps are declared like stack-type maps and keep up
+ *				to element_count elements inside the object itself. Inserting
+ *				more rehashes the elements into a heap block instead of
+ *				tripping an assert, @ref sdhmap_shrink moves them back once
+ *				they fit again. They have to be constructed with
+ *				@ref sdhmap_new and should be freed with @ref sdhmap_delete.
+ *				A byte copy of the object is only a separate map while the
+ *				elements are inside it, once they live in a heap block the
+ *				copy shares that block, so copies should be made with
+ *				@ref sdhmap_duplicate.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *	@param[in]	element_count	Amount of elements stored without allocating.
+ *
+ *	@return		Type to sdhmap object that satisfies the input parameters
+ */
+#define sdhmap_inline(key_type, value_type, element_count)\
+	sdhmap_typeof(struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			detail_sdhmap_inline_type storage_type;\
+			struct {\
+				sdhmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	}[(sizeof(sdhmap_inline_header) + sizeof(struct {\
+				sdhmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			}) * element_count + \
+		sizeof(void *) - 1) / sizeof(void *)])
+
 /**
  *	@hideinitializer
  *	@brief		Retrieve the amount of elements in the map.
@@ -177,7 +218,9 @@
 	detail_sdhmap_heap_type :\
 		detail_sdhmap_count_impl((void *)map),\
 	detail_sdhmap_stack_type :\
-		((const sdhmap_index)((sdhmap_header *)((void *)map))->count))
+		((const sdhmap_index)((sdhmap_header *)((void *)map))->count),\
+	detail_sdhmap_inline_type :\
+		detail_sdhmap_count_impl(detail_sdhmap_m2h(map)))
 
 /**
  *	@hideinitializer
@@ -188,7 +231,9 @@
  *				automatically to make space for more elements.\n
  *				For stack-type maps the capacity is fixed and cannot be
  *				changed. Attempting to do so by adding more elements will
- *				trip an assert.
+ *				trip an assert.\n
+ *				Inline-type maps report the capacity of the heap block once
+ *				they have outgrown their own storage.
  *
  *	@param[in]	map		Map object to retrieve the capacity from.
  *	
@@ -201,6 +246,10 @@
 			sizeof(map[0].type_data->slot)),\
 	detail_sdhmap_stack_type :\
 		((sdhmap_index)(sizeof(map) - sizeof(sdhmap_header)) /\
+			sizeof(map[0].type_data->slot)),\
+	detail_sdhmap_inline_type :\
+		detail_sdhmap_capacity_impl(\
+			detail_sdhmap_m2h(map),\
 			sizeof(map[0].type_data->slot)))
 
 /**
@@ -245,6 +294,11 @@
 		sizeof(map[0].type_data->slot),\
 		sizeof(map[0].type_data->key),\
 		sdhmap_capacity(map),\
+		capacity),\
+	detail_sdhmap_inline_type : detail_sdhmap_reserve_inline_impl(\
+		detail_sdhmap_m2hp(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
 		capacity)\
 	)
 
@@ -270,7 +324,8 @@
  *	@param[in]	capacity	(OPTIONAL, OMITTED) amount of elements to reserve 
  *							space for. Defaults to 
  *							@ref SDHMAP_DEFAULT_CAPACITY. This option is 
- *							omitted for stack-type maps.
+ *							omitted for stack-type maps, inline-type maps
+ *							only allocate if it exceeds their own storage.
  *	
  */
 #define sdhmap_new(...) detail_sdhmap_getter_upto_4(\
@@ -281,14 +336,16 @@
  *	@hideinitializer
  *	@brief		Duplicate an existing map.
  *	
- *	@details	Average time complexity - `O(count)`
+ *	@details	Average time complexity - `O(count)`\n
+ *				The destination is treated as unconstructed, a map that still
+ *				holds an allocation has to be deleted first.
  *
  *	@param		map		Destination map
  *	@param		source	Source map
  *
  */
 #define sdhmap_duplicate(map, source)\
-	_Generic(source.type_data->storage_type,\
+	_Generic(source[0].type_data->storage_type,\
 		detail_sdhmap_heap_type : _Generic(map[0].type_data->storage_type,\
 			detail_sdhmap_heap_type :\
 				detail_sdhmap_duplicate_heap_heap_impl(\
@@ -299,6 +356,15 @@
 					detail_sdhmap_m2h(map),\
 					sdhmap_capacity(map),\
 					sizeof(map[0].type_data->slot),\
+					detail_sdhmap_m2h(source)),\
+			detail_sdhmap_inline_type :\
+				detail_sdhmap_duplicate_inline_impl(\
+					detail_sdhmap_m2hp(map),\
+					detail_sdhmap_inline_capacity(map),\
+					sizeof(map[0].type_data->slot),\
+					sizeof(map[0].type_data->key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), value),\
 					detail_sdhmap_m2h(source))\
 			),\
 		detail_sdhmap_stack_type : _Generic(map[0].type_data->storage_type,\
@@ -314,7 +380,38 @@
 					detail_sdhmap_m2h(map),\
 					sdhmap_capacity(map),\
 					sizeof(map[0].type_data->slot),\
+					detail_sdhmap_m2h(source)),\
+			detail_sdhmap_inline_type :\
+				detail_sdhmap_duplicate_inline_impl(\
+					detail_sdhmap_m2hp(map),\
+					detail_sdhmap_inline_capacity(map),\
+					sizeof(map[0].type_data->slot),\
+					sizeof(map[0].type_data->key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), value),\
+					detail_sdhmap_m2h(source))\
+			),\
+		detail_sdhmap_inline_type : _Generic(map[0].type_data->storage_type,\
+			detail_sdhmap_heap_type :\
+				detail_sdhmap_duplicate_heap_heap_impl(\
+					detail_sdhmap_m2hp(map),\
+					detail_sdhmap_m2h(source)),\
+			detail_sdhmap_stack_type :\
+				detail_sdhmap_duplicate_stack_heap_impl(\
+					detail_sdhmap_m2h(map),\
+					sdhmap_capacity(map),\
+					sizeof(map[0].type_data->slot),\
+					detail_sdhmap_m2h(source)),\
+			detail_sdhmap_inline_type :\
+				detail_sdhmap_duplicate_inline_impl(\
+					detail_sdhmap_m2hp(map),\
+					detail_sdhmap_inline_capacity(map),\
+					sizeof(map[0].type_data->slot),\
+					sizeof(map[0].type_data->key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+					offsetof(sdhmap_typeof(map[0].type_data->slot), value),\
 					detail_sdhmap_m2h(source))\
+			))
 
 /**
  *	@hideinitializer
@@ -357,7 +454,13 @@
 				sizeof(map[0].type_data->slot),\
 				sizeof(map[0].type_data->key),\
 				detail_sdhmap_keyexpr_to_pointer(map, key_expr),\
-				sdhmap_capacity(map)))))
+				sdhmap_capacity(map)),\
+		detail_sdhmap_inline_type :\
+			detail_sdhmap_set_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				sizeof(map[0].type_data->slot),\
+				sizeof(map[0].type_data->key),\
+				detail_sdhmap_keyexpr_to_pointer(map, key_expr)))))
 
 /**
  *	@hideinitializer
@@ -423,6 +526,8 @@
  *	@brief		Optimize and shrink the map down as much as possible.
  *	
  *	@details	Average time complexity - `O(capacity)`\n
+ *				Inline-type maps that fit into their own storage again are
+ *				moved back into it.\n
  *				Calling this function invalidates all pointers retrieved with
  *				any function for this object in this library.
  *				
@@ -437,7 +542,11 @@
 		detail_sdhmap_m2h(map),\
 		sizeof(map[0].type_data->slot),\
 		sizeof(map[0].type_data->key),\
-		sdhmap_capacity(map))\
+		sdhmap_capacity(map)),\
+	detail_sdhmap_inline_type : detail_sdhmap_shrink_inline_impl(\
+		detail_sdhmap_m2hp(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key))\
 	)
 
 /**
@@ -481,13 +590,18 @@
  *	
  *	@details	Average time complexity - same as @ref sdhmap_free\n
  *				This function call may be omitted for stack type maps.
+ *				Inline-type maps release their heap block, if they have one,
+ *				and are left empty.
  *
  *	@param[in]	map		Map object to free
  */
 #define sdhmap_delete(map) _Generic(map[0].type_data->storage_type,\
 	detail_sdhmap_heap_type: detail_sdhmap_delete_impl(\
 		detail_sdhmap_m2hp(map)),\
-	detail_sdhmap_stack_type: detail_sdhmap_dummy_impl())
+	detail_sdhmap_stack_type: detail_sdhmap_dummy_impl(),\
+	detail_sdhmap_inline_type: detail_sdhmap_delete_inline_impl(\
+		detail_sdhmap_m2hp(map),\
+		sizeof(map[0].type_data->slot)))
 	
 /*
  *	Detail functions
@@ -531,6 +645,12 @@ typedef struct sdhmap_header
 	 * Equality function. May be NULL.
 	 */
 	int (*eq_func)(const void *, const void *);
+
+	/**
+	 * Offsets of the key and the value from the start of a slot.
+	 */
+	uint32_t key_offset;
+	uint32_t value_offset;
 } sdhmap_header;
 
 /**
@@ -538,10 +658,31 @@ typedef struct sdhmap_header
  */
 typedef struct sdhmap_heap
 {
-	sdhmap_index capacity;
+	size_t capacity;
 	sdhmap_header header;
 } sdhmap_heap;
 
+/**
+ *	@brief	sdhmap inline object.
+ *
+ *	The storage is laid out like a heap block so that the functions that only
+ *	read a map work on it without knowing where it lives.
+ */
+typedef struct sdhmap_inline_header
+{
+	/**
+	 * The header of the heap block in use, NULL while the elements are in
+	 * storage. The address of storage is taken from the object itself so
+	 * that a copy of an in-place map does not point back into the original.
+	 */
+	sdhmap_header *active;
+
+	/**
+	 * Storage inside the object, the slots follow it.
+	 */
+	sdhmap_heap storage;
+} sdhmap_inline_header;
+
 /*
  * slot -> location of key and value
  * slot == -1 -> slot is empty
@@ -557,18 +698,34 @@ typedef struct sdhmap_slot
 
 #define detail_sdhmap_stack_type short
 
+#define detail_sdhmap_inline_type long
+
 #define detail_sdhmap_m2h(map) ((sdhmap_header *)((void *) _Generic(\
 		map[0].type_data->storage_type,\
 	detail_sdhmap_heap_type : map,\
-	detail_sdhmap_stack_type : map))\
+	detail_sdhmap_stack_type : map,\
+	detail_sdhmap_inline_type : detail_sdhmap_inline_active(map)))\
 	)
 
 #define detail_sdhmap_m2hp(map) ((sdhmap_header **)((void *) _Generic(\
 		map[0].type_data->storage_type,\
 	detail_sdhmap_heap_type : &map,\
-	detail_sdhmap_stack_type : map))\
+	detail_sdhmap_stack_type : map,\
+	detail_sdhmap_inline_type : map))\
 	)
 
+#define detail_sdhmap_inline_in_place(map)\
+	(((sdhmap_inline_header *)((void *)(map)))->active == NULL)
+
+#define detail_sdhmap_inline_active(map)\
+	(detail_sdhmap_inline_in_place(map) ?\
+		&((sdhmap_inline_header *)((void *)(map)))->storage.header :\
+		((sdhmap_inline_header *)((void *)(map)))->active)
+
+#define detail_sdhmap_inline_capacity(map)\
+	(sdhmap_index)((sizeof(map) - sizeof(sdhmap_inline_header)) /\
+		sizeof(map[0].type_data->slot))
+
 #define detail_sdhmap_key_to_complit2(map, key_value)\
 	_Generic(key_value, \
 		sdhmap_typeof(sdhmap_typeof(map[0].type_data->key)) : key_value,\
@@ -576,8 +733,8 @@ typedef struct sdhmap_slot
 	)
 
 #define detail_sdhmap_key_to_complit(map, key_value)\
-	((const void *)(&((sdhmap_typeof(map[0].type_data->key))\
-		{detail_sdhmap_key_to_complit2(map, key_value)})))
+	((const void *)((sdhmap_typeof(map[0].type_data->key)[1])\
+		{detail_sdhmap_key_to_complit2(map, key_value)}))
 
 #define detail_sdhmap_keyexpr_to_pointer(map, key_expr) _Generic(key_expr,\
 	sdhmap_typeof(map[0].type_data->key) :\
@@ -596,10 +753,26 @@ typedef struct sdhmap_slot
 				hash_func,\
 				eq_func,\
 				capacity,\
-				sizeof(map[0].type_data->slot)),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
 		detail_sdhmap_stack_type : \
 			sdhmap_assert(\"Stack-type sdhmap_new hashmap called with 4 \
-				arguments."))\
+				arguments."),\
+		detail_sdhmap_inline_type : \
+			(detail_sdhmap_new_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				hash_func,\
+				eq_func,\
+				detail_sdhmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
+			detail_sdhmap_reserve_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				sizeof(map[0].type_data->slot),\
+				sizeof(map[0].type_data->key),\
+				capacity)))\
 
 #define detail_sdhmap_new3(map, hash_func, eq_func)\
 	_Generic(map[0].type_data->storage_type,\
@@ -609,14 +782,27 @@ typedef struct sdhmap_slot
 				hash_func,\
 				eq_func,\
 				SDHMAP_DEFAULT_CAPACITY,\
-				sizeof(map[0].type_data->slot)),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
 		detail_sdhmap_stack_type : \
 			detail_sdhmap_new_stack_impl(\
 				detail_sdhmap_m2h(map),\
 				hash_func,\
 				eq_func,\
 				sdhmap_capacity(map),\
-				sizeof(map[0].type_data->slot)))\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
+		detail_sdhmap_inline_type : \
+			detail_sdhmap_new_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				hash_func,\
+				eq_func,\
+				detail_sdhmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)))\
 
 #define detail_sdhmap_new2(map, hash_func)\
 	_Generic(map[0].type_data->storage_type,\
@@ -626,14 +812,27 @@ typedef struct sdhmap_slot
 				hash_func,\
 				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 				SDHMAP_DEFAULT_CAPACITY,\
-				sizeof(map[0].type_data->slot)),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
 		detail_sdhmap_stack_type : \
 			detail_sdhmap_new_stack_impl(\
 				detail_sdhmap_m2h(map),\
 				hash_func,\
 				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 				sdhmap_capacity(map),\
-				sizeof(map[0].type_data->slot)))\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
+		detail_sdhmap_inline_type : \
+			detail_sdhmap_new_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				hash_func,\
+				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
+				detail_sdhmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)))\
 
 #define detail_sdhmap_new1(map)\
 	_Generic(map[0].type_data->storage_type,\
@@ -643,14 +842,27 @@ typedef struct sdhmap_slot
 				detail_sdhmap_pick_hash_func(map[0].type_data->key),\
 				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 				SDHMAP_DEFAULT_CAPACITY,\
-				sizeof(map[0].type_data->slot)),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
 		detail_sdhmap_stack_type : \
 			detail_sdhmap_new_stack_impl(\
 				detail_sdhmap_m2h(map),\
 				detail_sdhmap_pick_hash_func(map[0].type_data->key),\
 				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 				sdhmap_capacity(map),\
-				sizeof(map[0].type_data->slot)))\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)),\
+		detail_sdhmap_inline_type : \
+			detail_sdhmap_new_inline_impl(\
+				detail_sdhmap_m2hp(map),\
+				detail_sdhmap_pick_hash_func(map[0].type_data->key),\
+				detail_sdhmap_pick_eq_func(map[0].type_data->key),\
+				detail_sdhmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdhmap_typeof(map[0].type_data->slot), value)))\
 
 #define detail_sdhmap_ensure_initialized(map)\
 	detail_sdhmap_ensure_initialized_impl(\
@@ -658,7 +870,9 @@ typedef struct sdhmap_slot
 		detail_sdhmap_pick_hash_func(map[0].type_data->key),\
 		detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 		SDHMAP_DEFAULT_CAPACITY,\
-		sizeof(map[0].type_data->slot))
+		sizeof(map[0].type_data->slot),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), value))
 
 #define detail_sdhmap_ensure_initialized_capacity(map, capacity)\
 	detail_sdhmap_ensure_initialized_impl(\
@@ -666,7 +880,9 @@ typedef struct sdhmap_slot
 		detail_sdhmap_pick_hash_func(map[0].type_data->key),\
 		detail_sdhmap_pick_eq_func(map[0].type_data->key),\
 		capacity,\
-		sizeof(map[0].type_data->slot))
+		sizeof(map[0].type_data->slot),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), value))
 
 #define detail_sdhmap_pick_hash_func(key) _Generic(key,\
 	uint8_t: detail_sdhmap_hash_uint8_t,\
@@ -719,14 +935,18 @@ SDHMAP_API void detail_sdhmap_new_heap_impl(
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size);
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDHMAP_API void detail_sdhmap_new_stack_impl(
 	sdhmap_header *header,
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size);
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDHMAP_API void detail_sdhmap_duplicate_heap_heap_impl(
 	sdhmap_header **header,
@@ -755,7 +975,9 @@ SDHMAP_API sdhmap_header **detail_sdhmap_ensure_initialized_impl(
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size);
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDHMAP_API int detail_sdhmap_contains_impl(
 	sdhmap_header *header,
@@ -837,6 +1059,57 @@ SDHMAP_API void *detail_sdhmap_next_impl(
 
 SDHMAP_API void detail_sdhmap_delete_impl(sdhmap_header **header);
 
+SDHMAP_API void detail_sdhmap_new_inline_impl(
+	sdhmap_header **header,
+	sdhmap_index (*hash_func)(const void *),
+	int (*eq_func)(const void *, const void *),
+	sdhmap_index count,
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset);
+
+SDHMAP_API void detail_sdhmap_rehash(
+	sdhmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_header *source);
+
+SDHMAP_API void detail_sdhmap_inline_spill(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_index target);
+
+SDHMAP_API void detail_sdhmap_duplicate_inline_impl(
+	sdhmap_header **header,
+	sdhmap_index capacity,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
+	sdhmap_header *source);
+
+SDHMAP_API void *detail_sdhmap_set_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDHMAP_API void detail_sdhmap_reserve_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_index target);
+
+SDHMAP_API void detail_sdhmap_shrink_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size);
+
+SDHMAP_API void detail_sdhmap_delete_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size);
+
 SDHMAP_API void detail_sdhmap_dummy_impl(void);
 
 /*
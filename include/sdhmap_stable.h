@@ -0,0 +1,225 @@
+/**
+ * @file sdhmap_stable.h	Simple dynamic hash map object for C whose values
+ *							never move in memory.
+ * @date					18. Oct 2026
+ * @author					Mihkel Aaremäe
+ */
+#ifndef SDHMAP_STABLE_H
+#define SDHMAP_STABLE_H
+
+#include <sdhmap.h>
+#include <sdd_stable_pool.h>
+
+/**
+ *	@hideinitializer
+ *	@brief		Value-stable simple dynamic hashmap type generator
+ *
+ *	@details	The buckets only hold a pointer to every value, the values
+ *				themselves live in chunks that are never reallocated. Erased
+ *				values are reused by later insertions.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdhmap_stable object that satisfies the input
+ *				parameters
+ */
+#define sdhmap_stable(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			struct {\
+				sdhmap_slot slot;\
+				key_type key;\
+				value_type *value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of elements in the map.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	map		Map to retrieve the count from.
+ *
+ *	@return		Amount of elements in map `(sdhmap_index)`.
+ */
+#define sdhmap_stable_count(map) detail_sdhmap_stable_count_impl(\
+	(sdhmap_stable_header *)((void *)map))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to a value associated with a key, if key
+ *				doesn't exist returns NULL.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				The pointer stays valid until the key is erased or the map
+ *				is deleted.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Pointer to object associated with `key_expr`, NULL if key
+ *				isn't found
+ */
+#define sdhmap_stable_getp(map, key_expr)\
+	((sdhmap_typeof(map[0].type_data->value) *)\
+	detail_sdhmap_stable_getp_impl(\
+		(sdhmap_stable_header *)((void *)map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		detail_sdhmap_keyexpr_to_pointer(map, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if a key exists in the map.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	map			Map to perform the test on
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdhmap_stable_contains(map, key_expr)\
+	(sdhmap_stable_getp(map, key_expr) != NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve an lvalue associated with a key, if it doesn't exist
+ *				then it is inserted with all bytes set to 0.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Pointers to values retrieved before stay valid.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		lvalue object associated with `key_expr`
+ */
+#define sdhmap_stable_get(map, key_expr) (*((sdhmap_typeof(map[0].type_data->value) *)\
+	detail_sdhmap_stable_get_impl(\
+		detail_sdhmap_stable_ensure_initialized(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		_Alignof(sdhmap_typeof(map[0].type_data->value)),\
+		detail_sdhmap_keyexpr_to_pointer(map, key_expr))))
+
+/**
+ *	@hideinitializer
+ *	@brief		Set a value to a key. If the key already exists in the map,
+ *				then it is overwritten.
+ *
+ *	@details	Average time complexity - same as @ref sdhmap_stable_get
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[in]	value_expr	Value to set
+ *
+ */
+#define sdhmap_stable_set(map, key_expr, value_expr)\
+	(sdhmap_stable_get(map, key_expr) = value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase a key from the map. If the key doesn't exist, then
+ *				nothing is done.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Only pointers to the value of the erased key are
+ *				invalidated.
+ *
+ *	@param[in]	map			Map to erase from
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ */
+#define sdhmap_stable_erase(map, key_expr)\
+	detail_sdhmap_stable_erase_impl(\
+		(sdhmap_stable_header *)((void *)map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		detail_sdhmap_keyexpr_to_pointer(map, key_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a map.
+ *
+ *	@details	Average time complexity - `O(chunks)`
+ *
+ *	@param[in]	map		Map object to free
+ *
+ */
+#define sdhmap_stable_delete(map)\
+	detail_sdhmap_stable_delete_impl((sdhmap_stable_header **)((void *)(&map)))
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+/**
+ *	@brief	Value-stable sdhmap header object.
+ */
+typedef struct sdhmap_stable_header
+{
+	/**
+	 * Header of the heap-type map from keys to value pointers.
+	 */
+	sdhmap_header *map;
+
+	/**
+	 * Values the map points to.
+	 */
+	sdd_stable_pool values;
+} sdhmap_stable_header;
+
+#define detail_sdhmap_stable_ensure_initialized(map)\
+	detail_sdhmap_stable_ensure_initialized_impl(\
+		(sdhmap_stable_header **)((void *)(&map)),\
+		detail_sdhmap_pick_hash_func(map[0].type_data->key),\
+		detail_sdhmap_pick_eq_func(map[0].type_data->key),\
+		sizeof(map[0].type_data->slot),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdhmap_typeof(map[0].type_data->slot), value))
+
+SDHMAP_API sdhmap_stable_header *detail_sdhmap_stable_ensure_initialized_impl(
+	sdhmap_stable_header **header,
+	sdhmap_index (*hash_func)(const void *),
+	int (*eq_func)(const void *, const void *),
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset);
+
+SDHMAP_API sdhmap_index detail_sdhmap_stable_count_impl(sdhmap_stable_header *header);
+
+SDHMAP_API void *detail_sdhmap_stable_getp_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDHMAP_API void *detail_sdhmap_stable_get_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_align,
+	const void *key);
+
+SDHMAP_API void detail_sdhmap_stable_erase_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDHMAP_API void detail_sdhmap_stable_delete_impl(sdhmap_stable_header **header);
+
+/**
+ *	@endcond
+ */
+
+#endif
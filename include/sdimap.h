@@ -0,0 +1,227 @@
+/**
+ *	@file sdimap.h	Interval map for C built on the sdmap AVL tree, finds
+ *					every interval overlapping a range without scanning the
+ *					whole map.
+ *	@date			18. Oct 2026
+ *	@author			Mihkel Aaremäe
+ */
+#ifndef SDIMAP_H
+#define SDIMAP_H
+
+#include <sdmap.h>
+
+/**
+ *	@hideinitializer
+ *	@brief		Interval map type generator
+ *
+ *	@details	Every element is a half-open interval `[start, end)` with a
+ *				value. The same interval can be inserted any amount of times.
+ *				Intervals are ordered by start and then by end, every node
+ *				also remembers the largest end in its subtree so searches can
+ *				skip subtrees that end too early. Functions for heap-type
+ *				sdmaps that do not insert, like @ref sdmap_count,
+ *				@ref sdmap_min, @ref sdmap_next and @ref sdmap_delete, work
+ *				with it when given key pointers.
+ *
+ *	@param[in]	bound_type		Type of the interval bounds, any type with a
+ *								default compare function.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdimap object that satisfies the input parameters
+ */
+#define sdimap(bound_type, value_type)\
+	struct {\
+		struct {\
+			sdimap_interval(bound_type) key;\
+			value_type value;\
+			detail_sdmap_heap_type storage_type;\
+			struct {\
+				sdmap_slot slot;\
+				sdimap_interval(bound_type) key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Interval type generator, the keys of a sdimap point to one
+ *
+ *	@param[in]	bound_type		Type of the interval bounds.
+ *
+ *	@return		Type with the `start` and `end` of an interval
+ */
+#define sdimap_interval(bound_type)\
+	struct {\
+		bound_type start;\
+		bound_type end;\
+		bound_type max_end;\
+	}
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert an interval, even if it already exists.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Map to insert into
+ *	@param[in]	start_expr	First point in the interval
+ *	@param[in]	end_expr	First point past the interval
+ *	@param[in]	value_expr	Value of the new element
+ *
+ */
+#define sdimap_insert(map, start_expr, end_expr, value_expr)\
+	(*((sdmap_typeof(map[0].type_data->value) *)\
+		detail_sdimap_insert_impl(\
+			detail_sdimap_ensure_initialized(map),\
+			sizeof(map[0].type_data->slot),\
+			sizeof(map[0].type_data->key.start),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+			detail_sdimap_interval(map, start_expr, end_expr))) = value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase one interval that is equal to `[start_expr, end_expr)`.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Map to erase from
+ *	@param[in]	start_expr	First point in the interval
+ *	@param[in]	end_expr	First point past the interval
+ *
+ */
+#define sdimap_erase(map, start_expr, end_expr)\
+	detail_sdimap_erase_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key.start),\
+		detail_sdimap_interval(map, start_expr, end_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Call a function for every interval overlapping `[lo, hi)`.
+ *
+ *	@details	Average time complexity - `O(log(count) + result)`\n
+ *				Intervals are visited in order. The map must not be modified
+ *				from the function.
+ *
+ *	@param[in]	map			Map to search
+ *	@param[in]	lo			First point of the range
+ *	@param[in]	hi			First point past the range
+ *	@param[in]	function	Function to call. Default prototype is
+ *							`void (const void *key, void *value)`, key points
+ *							to a `sdimap_interval(bound_type)`.
+ *	@param[in]	user		(OPTIONAL) User pointer `(void *)`, if specified,
+ *							then function prototype changes to
+ *							`void (const void *key, void *value, void *user)`.
+ *
+ */
+#define sdimap_overlaps(map, lo, hi, ...)\
+	detail_sdmap_getter_upto_2(\
+		__VA_ARGS__,\
+		detail_sdimap_overlaps2,\
+		detail_sdimap_overlaps1,\
+		dummy)\
+	(map, lo, hi, 0, __VA_ARGS__)
+
+/**
+ *	@hideinitializer
+ *	@brief		Call a function for every interval containing a point.
+ *
+ *	@details	Average time complexity - `O(log(count) + result)`\n
+ *				Intervals are visited in order. The map must not be modified
+ *				from the function.
+ *
+ *	@param[in]	map			Map to search
+ *	@param[in]	point		Point to look for
+ *	@param[in]	function	Function to call, same as for
+ *							@ref sdimap_overlaps.
+ *	@param[in]	user		(OPTIONAL) User pointer `(void *)`.
+ *
+ */
+#define sdimap_stab(map, point, ...)\
+	detail_sdmap_getter_upto_2(\
+		__VA_ARGS__,\
+		detail_sdimap_overlaps2,\
+		detail_sdimap_overlaps1,\
+		dummy)\
+	(map, point, point, 1, __VA_ARGS__)
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+#define detail_sdimap_ensure_initialized(map)\
+	detail_sdmap_ensure_initialized_impl(\
+		(void *)(&map),\
+		(sizeof(map[0].type_data->slot)) * SDMAP_DEFAULT_CAPACITY,\
+		detail_sdmap_pick_compare_func(map[0].type_data->key.start),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value))
+
+#define detail_sdimap_interval(map, start, end)\
+	((const void *)((sdmap_typeof(map[0].type_data->key)[1]){{start, end, end}}))
+
+#define detail_sdimap_overlaps1(map, lo, hi, closed, function)\
+	detail_sdimap_overlaps_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key.start),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		detail_sdimap_interval(map, lo, hi),\
+		closed,\
+		function)
+
+#define detail_sdimap_overlaps2(map, lo, hi, closed, function, user)\
+	detail_sdimap_overlaps_ex_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key.start),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		detail_sdimap_interval(map, lo, hi),\
+		closed,\
+		function,\
+		user)
+
+SDMAP_API void *detail_sdimap_insert_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *interval);
+
+SDMAP_API void detail_sdimap_erase_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	const void *interval);
+
+SDMAP_API void detail_sdimap_overlaps_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *range,
+	int closed,
+	void (*function)(const void *key, void *value));
+
+SDMAP_API void detail_sdimap_overlaps_ex_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *range,
+	int closed,
+	void (*function)(const void *key, void *value, void *user),
+	void *user);
+
+/**
+ *	@endcond
+ */
+
+#endif
@@ -33,6 +33,56 @@
 #define SDMAP_ENABLE_AUTOSHRINK 1
 #endif
 
+#ifndef SDMAP_SMALL_MAX
+/**
+ *	Amount of elements a @ref sdmap_small keeps in sorted arrays before it
+ *	turns into a tree.
+ */
+#define SDMAP_SMALL_MAX 32
+#endif
+
+#ifndef SDMAP_GETP_MANY_LANES
+/**
+ *	Amount of lookups @ref sdmap_getp_many keeps in flight at once.
+ */
+#define SDMAP_GETP_MANY_LANES 8
+#endif
+
+#ifndef SDMAP_PACKED_SLOT
+/**
+ *	Should the height of a node be kept in the top bits of its parent index
+ *	instead of a byte of its own. This saves the padding after the height, a
+ *	quarter of every slot with the default @ref sdmap_index, but a map can
+ *	then only address `2^(bits - 6)` slots, `2^(16 - 5)` for 16 bit indexes.
+ */
+#define SDMAP_PACKED_SLOT 0
+#endif
+
+/**
+ *	Keep the slots in whatever order they were inserted in.
+ */
+#define SDMAP_LAYOUT_NONE 0
+
+/**
+ *	Renumber the slots in breadth-first order, top levels of the tree come
+ *	first in memory.
+ */
+#define SDMAP_LAYOUT_BFS 1
+
+/**
+ *	Renumber the slots in van Emde Boas order, subtrees are clustered together
+ *	recursively in memory.
+ */
+#define SDMAP_LAYOUT_VEB 2
+
+#ifndef SDMAP_SHRINK_LAYOUT
+/**
+ *	Slot layout that @ref sdmap_shrink should apply to the map after
+ *	compacting it. See @ref sdmap_relayout for more info.
+ */
+#define SDMAP_SHRINK_LAYOUT SDMAP_LAYOUT_NONE
+#endif
+
 #ifndef sdmap_malloc
 #ifndef sdd_malloc
 #include <stdlib.h>
@@ -90,6 +140,8 @@
 #ifndef sdmap_index
 /**
  *	A user-defineable type for indexes in the map, defaults to `uint32_t`.
+ *	`uint16_t` halves the slots of maps with less than 65535 elements,
+ *	`uint64_t` is needed for maps with more than 4294967295 elements.
  */
 #define sdmap_index uint32_t
 #endif
@@ -154,6 +206,45 @@
 			}) * element_count + \
 		sizeof(void *) - 1) / sizeof(void *)])
 
+/**
+ *	@hideinitializer
+ *	@brief		Inline-type simple dynamic map type generator
+ *
+ *	@details	Inline-type maps are declared like stack-type maps and keep up
+ *				to element_count elements inside the object itself. Inserting
+ *				more moves the elements to a heap block instead of tripping an
+ *				assert, @ref sdmap_shrink moves them back once they fit again.
+ *				They have to be constructed with @ref sdmap_new and should be
+ *				freed with @ref sdmap_delete. A byte copy of the object is only
+ *				a separate map while the elements are inside it, once they
+ *				live in a heap block the copy shares that block, so copies
+ *				should be made with @ref sdmap_duplicate.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *	@param[in]	element_count	Amount of elements stored without allocating.
+ *
+ *	@return		Type to sdmap object that satisfies the input parameters
+ */
+#define sdmap_inline(key_type, value_type, element_count)\
+	sdmap_typeof(struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			detail_sdmap_inline_type storage_type;\
+			struct {\
+				sdmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	}[(sizeof(sdmap_inline_header) + sizeof(struct {\
+				sdmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			}) * element_count + \
+		sizeof(void *) - 1) / sizeof(void *)])
+
 /**
  *	@hideinitializer
  *	@brief		Retrieve the amount of elements in the map.
@@ -168,7 +259,9 @@
 	detail_sdmap_heap_type :\
 		detail_sdmap_count_impl(detail_sdmap_m2h(map)),\
 	detail_sdmap_stack_type :\
-		((const sdmap_index)(detail_sdmap_m2h(map)->count))\
+		((const sdmap_index)(detail_sdmap_m2h(map)->count)),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_count_impl(detail_sdmap_m2h(map))\
 	)
 
 /**
@@ -180,7 +273,9 @@
  *				automatically to make space for more elements.\n
  *				For stack-type maps the capacity is fixed and cannot be
  *				changed. Attempting to do so by adding more elements will
- *				trip an assert.
+ *				trip an assert.\n
+ *				Inline-type maps report the capacity of the heap block once
+ *				they have outgrown their own storage.
  *
  *	@param[in]	map		Map object to retrieve the capacity from.
  *	
@@ -193,6 +288,10 @@
 			sizeof(map[0].type_data->slot)),\
 	detail_sdmap_stack_type :\
 		((sdmap_index)(sizeof(map) - sizeof(sdmap_header)) /\
+			sizeof(map[0].type_data->slot)),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_capacity_impl(\
+			detail_sdmap_m2h(map),\
 			sizeof(map[0].type_data->slot))\
 	)
 
@@ -233,8 +332,15 @@
 		detail_sdmap_ensure_initialized_impl(\
 			detail_sdmap_m2hp(map),\
 			sizeof(map[0].type_data->slot) * capacity,\
-			detail_sdmap_pick_compare_func(map[0].type_data->key)),\
-	detail_sdmap_stack_type : detail_sdmap_dummy_impl()\
+			detail_sdmap_pick_compare_func(map[0].type_data->key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
+	detail_sdmap_stack_type : detail_sdmap_dummy_impl(),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_reserve_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			sizeof(map[0].type_data->slot),\
+			sizeof(map[0].type_data->slot) * capacity)\
 	)
 
 /**
@@ -254,7 +360,8 @@
  *	@param[in]	capacity	(OPTIONAL, OMITTED) amount of elements to reserve 
  *							space for. Defaults to 
  *							@ref SDMAP_DEFAULT_CAPACITY. This option is 
- *							omitted for stack-type maps.
+ *							omitted for stack-type maps, inline-type maps
+ *							only allocate if it exceeds their own storage.
  *	
  */
 #define sdmap_new(...) detail_sdmap_getter_upto_3(\
@@ -265,13 +372,15 @@
  *	@hideinitializer
  *	@brief		Duplicate an existing map.
  *	
- *	@details	Average time complexity - `O(count)`
+ *	@details	Average time complexity - `O(count)`\n
+ *				The destination is treated as unconstructed, a map that still
+ *				holds an allocation has to be deleted first.
  *
  *	@param		map		Destination map
  *	@param		source	Source map
  *
  */
-#define sdmap_duplicate(map, source) _Generic(source.type_data->storage_type,\
+#define sdmap_duplicate(map, source) _Generic(source[0].type_data->storage_type,\
 	detail_sdmap_heap_type : _Generic(map[0].type_data->storage_type,\
 		detail_sdmap_heap_type :\
 			detail_sdmap_duplicate_heap_heap_impl(\
@@ -282,6 +391,16 @@
 				detail_sdmap_m2h(map),\
 				sdmap_capacity(map),\
 				sizeof(map[0].type_data->slot),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+				detail_sdmap_m2h(source)),\
+		detail_sdmap_inline_type :\
+			detail_sdmap_duplicate_inline_impl(\
+				detail_sdmap_m2hp(map),\
+				detail_sdmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), value),\
 				detail_sdmap_m2h(source))\
 		),\
 	detail_sdmap_stack_type : _Generic(map[0].type_data->storage_type,\
@@ -297,6 +416,36 @@
 				detail_sdmap_m2h(map),\
 				sdmap_capacity(map),\
 				sizeof(map[0].type_data->slot),\
+				detail_sdmap_m2h(source)),\
+		detail_sdmap_inline_type :\
+			detail_sdmap_duplicate_inline_impl(\
+				detail_sdmap_m2hp(map),\
+				detail_sdmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+				detail_sdmap_m2h(source))\
+		),\
+	detail_sdmap_inline_type : _Generic(map[0].type_data->storage_type,\
+		detail_sdmap_heap_type :\
+			detail_sdmap_duplicate_heap_heap_impl(\
+				detail_sdmap_m2hp(map),\
+				detail_sdmap_m2h(source)),\
+		detail_sdmap_stack_type :\
+			detail_sdmap_duplicate_stack_heap_impl(\
+				detail_sdmap_m2h(map),\
+				sdmap_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+				detail_sdmap_m2h(source)),\
+		detail_sdmap_inline_type :\
+			detail_sdmap_duplicate_inline_impl(\
+				detail_sdmap_m2hp(map),\
+				detail_sdmap_inline_capacity(map),\
+				sizeof(map[0].type_data->slot),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+				offsetof(sdmap_typeof(map[0].type_data->slot), value),\
 				detail_sdmap_m2h(source))\
 		))
 
@@ -317,7 +466,7 @@
  *	
  *	@return		lvalue object associated with `key_expr`
  */
-#define sdmap_get(map, key_expr) (*((sdmap_typeof(map[0].type_data->key) *)\
+#define sdmap_get(map, key_expr) (*((sdmap_typeof(map[0].type_data->value) *)\
 	_Generic(map[0].type_data->storage_type,\
 	detail_sdmap_heap_type :\
 		detail_sdmap_set_heap_impl(\
@@ -331,7 +480,13 @@
 			sizeof(map[0].type_data->slot),\
 			sizeof(map[0].type_data->key),\
 			detail_sdmap_keyexpr_to_pointer(map, key_expr),\
-			sdmap_capacity(map))\
+			sdmap_capacity(map)),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_set_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			sizeof(map[0].type_data->slot),\
+			sizeof(map[0].type_data->key),\
+			detail_sdmap_keyexpr_to_pointer(map, key_expr))\
 	)))
 
 /**
@@ -369,13 +524,39 @@
  *	@return		Pointer to object associated with `key_expr`, NULL if key
  *				isn't found
  */
-#define sdmap_getp(map, key_expr) ((sdmap_typeof(map[0].type_data->key) *)\
+#define sdmap_getp(map, key_expr) ((sdmap_typeof(map[0].type_data->value) *)\
 	detail_sdmap_getp_impl(\
-		detail_sdmap_ensure_initialized(map),\
+		detail_sdmap_m2h(map),\
 		sizeof(map[0].type_data->slot),\
 		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
 		detail_sdmap_keyexpr_to_pointer(map, key_expr)))
 
+/**
+ *	@hideinitializer
+ *	@brief		Look up many keys at once, like calling @ref sdmap_getp for
+ *				every one of them.
+ *
+ *	@details	Average time complexity - `O(count * log(map count))`\n
+ *				Up to @ref SDMAP_GETP_MANY_LANES lookups descend the tree in
+ *				turns and prefetch the next node they need, so on maps that
+ *				don't fit into the cache their misses overlap.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	keys		Pointer to the first of the keys to look up
+ *	@param[in]	count		Amount of keys
+ *	@param[out]	out			Array of count value pointers, NULL for keys
+ *							that aren't found
+ */
+#define sdmap_getp_many(map, keys, count, out)\
+	detail_sdmap_getp_many_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		(const sdmap_typeof(map[0].type_data->key) *){keys},\
+		count,\
+		(void **)(sdmap_typeof(map[0].type_data->value) **){out})
+
 #if SDMAP_ENABLE_AUTOSHRINK
 /**
  *	@hideinitializer
@@ -407,11 +588,13 @@
 			detail_sdmap_heap_type :\
 				detail_sdmap_shrink_impl(\
 					detail_sdmap_m2hp(map),\
-					sizeof(sdmap_slot) +\
-						sizeof(map[0].type_data->key) +\
-						sizeof(map[0].type_data->value)),\
+					sizeof(map[0].type_data->slot)),\
 			detail_sdmap_stack_type :\
-				detail_sdmap_dummy_impl());\
+				detail_sdmap_dummy_impl(),\
+			detail_sdmap_inline_type :\
+				detail_sdmap_shrink_inline_impl(\
+					detail_sdmap_m2hp(map),\
+					sizeof(map[0].type_data->slot)));\
 	}
 #else
 #define sdmap_erase(map, key_expr)\
@@ -426,6 +609,9 @@
  *	@brief		Optimize and shrink the map down as much as possible.
  *	
  *	@details	Average time complexity - `O(capacity)`\n
+ *				If @ref SDMAP_SHRINK_LAYOUT is defined then the slots are also
+ *				renumbered, see @ref sdmap_relayout. Inline-type maps that
+ *				fit into their own storage again are moved back into it.\n
  *				Calling this function invalidates all pointers retrieved with
  *				any function for this object in this library.
  *				
@@ -435,12 +621,175 @@
 #define sdmap_shrink(map) _Generic(map[0].type_data->storage_type,\
 	detail_sdmap_heap_type :\
 		detail_sdmap_shrink_impl(\
-			detail_sdmap_m2h(map),\
+			detail_sdmap_m2hp(map),\
 			sizeof(map[0].type_data->slot)),\
 	detail_sdmap_stack_type :\
-		detail_sdmap_dummy_impl()\
+		detail_sdmap_dummy_impl(),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_shrink_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			sizeof(map[0].type_data->slot))\
 	)
 
+/**
+ *	@hideinitializer
+ *	@brief		Renumber the slots of the map so that lookups touch fewer cache
+ *				lines and pages.
+ *	
+ *	@details	Average time complexity - `O(capacity)`\n
+ *				The map is compacted first, then its nodes are moved around in
+ *				memory so that the root is the first slot and the top levels of
+ *				the tree are contiguous. With @ref SDMAP_LAYOUT_VEB every
+ *				subtree is also clustered together recursively, which works
+ *				well regardless of the cache line or page size. Best used on
+ *				large maps that are mostly read from after being built.\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *				
+ *	@param[in]	map		Map to relayout
+ *	@param[in]	layout	One of @ref SDMAP_LAYOUT_NONE, @ref SDMAP_LAYOUT_BFS
+ *						or @ref SDMAP_LAYOUT_VEB
+ *	
+ */
+#define sdmap_relayout(map, layout)\
+	detail_sdmap_relayout_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		layout)
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert every element of source into map.
+ *	
+ *	@details	Average time complexity - `O(count(map) + count(source))`\n
+ *				Both maps are walked in order at the same time and the result
+ *				is built as a perfectly balanced tree, which is faster than
+ *				setting the elements one by one unless source is much smaller
+ *				than map. For keys that exist in both maps conflict_func is
+ *				called with the key, the value in map and the value in source,
+ *				if it is NULL then the value from source is taken.\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *				
+ *	@param[in]	map				Map to merge into
+ *	@param[in]	source			Map of the same type to merge from
+ *	@param[in]	conflict_func	`void (*)(const void *key, void *value,
+ *								const void *source_value)` or NULL
+ *	
+ */
+#define sdmap_merge(map, source, conflict_func)\
+	detail_sdmap_combine(map, source, detail_sdmap_combine_merge, conflict_func)
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase every element of map whose key doesn't exist in source.
+ *	
+ *	@details	Average time complexity - `O(count(map) + count(source))`\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *				
+ *	@param[in]	map		Map to erase from
+ *	@param[in]	source	Map of the same type to compare the keys against
+ *	
+ */
+#define sdmap_intersect(map, source)\
+	detail_sdmap_combine(map, source, detail_sdmap_combine_intersect, NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase every element of map whose key exists in source.
+ *	
+ *	@details	Average time complexity - `O(count(map) + count(source))`\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *				
+ *	@param[in]	map		Map to erase from
+ *	@param[in]	source	Map of the same type to compare the keys against
+ *	
+ */
+#define sdmap_difference(map, source)\
+	detail_sdmap_combine(map, source, detail_sdmap_combine_difference, NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Split a map in two around a key.
+ *	
+ *	@details	Average time complexity -
+ *				`O(log(count) + min(count(left), count(right)))`\n
+ *				The tree is cut apart with AVL joins, then the smaller half is
+ *				moved to a new block while the larger half keeps the original
+ *				one. Afterwards map is NULL, if left or right contains a
+ *				previously used map then it should be freed with
+ *				@ref sdmap_delete. Only heap-type maps can be split.
+ *				
+ *	@param[in]	map			Heap-type map to split
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[out]	left		Map of the same type to receive keys less than
+ *							`key_expr`
+ *	@param[out]	right		Map of the same type to receive the rest
+ *	
+ */
+#define sdmap_split(map, key_expr, left, right)\
+	(detail_sdmap_require_heap(map, "sdmap_split"),\
+	detail_sdmap_require_heap(left, "sdmap_split"),\
+	detail_sdmap_require_heap(right, "sdmap_split"),\
+	detail_sdmap_split_impl(\
+		(sdmap_header **)((void *)(&map)),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr),\
+		(sdmap_header **)((void *)(&left)),\
+		(sdmap_header **)((void *)(&right))))
+
+/**
+ *	@hideinitializer
+ *	@brief		Join two maps whose key ranges don't overlap.
+ *	
+ *	@details	Average time complexity -
+ *				`O(log(count) + min(count(map), count(other)))`\n
+ *				Every key in map has to be less than every key in other. The
+ *				smaller map is appended to the block of the larger one as a
+ *				balanced subtree and the two trees are joined with AVL
+ *				rotations. The result is stored in map and other is NULL
+ *				afterwards. Only heap-type maps can be joined.\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for both objects in this library.
+ *				
+ *	@param[in]	map		Heap-type map holding the smaller keys
+ *	@param[in]	other	Heap-type map of the same type holding the larger keys
+ *	
+ */
+#define sdmap_join(map, other)\
+	(detail_sdmap_require_heap(map, "sdmap_join"),\
+	detail_sdmap_require_heap(other, "sdmap_join"),\
+	detail_sdmap_join_impl(\
+		(sdmap_header **)((void *)(&map)),\
+		sizeof(map[0].type_data->slot),\
+		(sdmap_header **)((void *)(&other))))
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase every key in the range `[first_expr, last_expr)`.
+ *	
+ *	@details	Average time complexity - `O(log(count) + erased)`\n
+ *				Only heap-type maps can erase ranges.\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *				
+ *	@param[in]	map			Heap-type map to erase from
+ *	@param[in]	first_expr	Either a key or a pointer to a key, the first
+ *							key to erase
+ *	@param[in]	last_expr	Either a key or a pointer to a key, the first
+ *							key past the range
+ *	
+ */
+#define sdmap_erase_range(map, first_expr, last_expr)\
+	(detail_sdmap_require_heap(map, "sdmap_erase_range"),\
+	detail_sdmap_erase_range_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, first_expr),\
+		detail_sdmap_keyexpr_to_pointer(map, last_expr)))
+
 /**
  *	@hideinitializer
  *	@brief		Retrieve a pointer to the smallest key
@@ -693,53 +1042,719 @@
  *	
  *	@details	Average time complexity - same as @ref sdmap_free
  *				This function call may be omitted for stack type maps.
+ *				Inline-type maps release their heap block, if they have one,
+ *				and are left empty.
  *
  *	@param[in]	map		Map object to free
  *	
  */
 #define sdmap_delete(map) _Generic(map[0].type_data->storage_type,\
 	detail_sdmap_heap_type: detail_sdmap_delete_impl((void *)(&map)),\
-	detail_sdmap_stack_type: detail_sdmap_dummy_impl()\
+	detail_sdmap_stack_type: detail_sdmap_dummy_impl(),\
+	detail_sdmap_inline_type: detail_sdmap_delete_inline_impl(\
+		detail_sdmap_m2hp(map))\
 	)
 
-/*
- *	Detail functions
- *	@cond false
+/**
+ *	@hideinitializer
+ *	@brief		Frozen simple dynamic map type generator
+ *
+ *	@details	Frozen maps are read-only. The keys are stored in a single
+ *				array in Eytzinger (breadth-first) order and the values in a
+ *				parallel array, there is no per-element slot overhead.
+ *				They are created with @ref sdmap_freeze and turned back into
+ *				a regular map with @ref sdmap_thaw.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to frozen sdmap object that satisfies the input
+ *				parameters
  */
+#define sdmap_frozen(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+		} *type_data;\
+	} *
 
-#ifndef SDMAP_API
-#define SDMAP_API
-#endif
+/**
+ *	@hideinitializer
+ *	@brief		Build a frozen copy of a map.
+ *	
+ *	@details	Average time complexity - `O(count)`\n
+ *				The source map is left untouched and can be deleted
+ *				afterwards. If frozen contains a previously frozen map then it
+ *				should be freed with @ref sdmap_frozen_delete.
+ *
+ *	@param[out]	frozen	Frozen map to initialize
+ *	@param[in]	map		Map to freeze
+ *	
+ */
+#define sdmap_freeze(frozen, map) detail_sdmap_freeze_impl(\
+	(sdmap_frozen_header **)((void *)(&frozen)),\
+	detail_sdmap_m2h(map),\
+	sizeof(map[0].type_data->slot),\
+	sizeof(map[0].type_data->key),\
+	sizeof(map[0].type_data->value),\
+	offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+	_Alignof(sdmap_typeof(map[0].type_data->value)))
 
 /**
- *	@brief		sdmap header object.
+ *	@hideinitializer
+ *	@brief		Build a heap-type map out of a frozen map.
+ *	
+ *	@details	Average time complexity - `O(count)`\n
+ *				The resulting tree is perfectly balanced. If map contains a
+ *				previously used map then it should be freed with
+ *				@ref sdmap_delete.
+ *
+ *	@param[out]	map		Heap-type map to initialize
+ *	@param[in]	frozen	Frozen map to thaw
+ *	
  */
-typedef struct sdmap_header
+#define sdmap_thaw(map, frozen) detail_sdmap_thaw_impl(\
+	(sdmap_header **)((void *)(&map)),\
+	sizeof(map[0].type_data->slot),\
+	sizeof(map[0].type_data->key),\
+	sizeof(map[0].type_data->value),\
+	offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+	offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+	(void *)frozen)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of elements in the frozen map.
+ *	
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	frozen	Frozen map object to retrieve the count from.
+ *	
+ *	@return		Amount of elements in map `(sdmap_index)`.
+ */
+#define sdmap_frozen_count(frozen)\
+	detail_sdmap_frozen_count_impl((void *)frozen)
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if a key exists in the frozen map.
+ *	
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	frozen		Frozen map to perform the test on
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdmap_frozen_contains(frozen, key_expr)\
+	(sdmap_frozen_getp(frozen, key_expr) != NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to a value associated with a key, if key
+ *				doesn't exist returns NULL.
+ *	
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				The search is branchless and prefetches the keys a few levels
+ *				ahead. Basic key types are compared inline, other key types
+ *				go through the compare function of the source map.
+ *				
+ *	@param[in]	frozen		Frozen map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	
+ *	@return		Pointer to object associated with `key_expr`, NULL if key
+ *				isn't found
+ */
+#define sdmap_frozen_getp(frozen, key_expr)\
+	((sdmap_typeof(frozen[0].type_data->value) *)\
+	detail_sdmap_frozen_getp_impl(\
+		(void *)frozen,\
+		detail_sdmap_pick_frozen_search(frozen[0].type_data->key),\
+		sizeof(frozen[0].type_data->key),\
+		sizeof(frozen[0].type_data->value),\
+		detail_sdmap_keyexpr_to_pointer(frozen, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to the smallest key that is not less than
+ *				the given key.
+ *	
+ *	@details	Average time complexity - `O(log(count))`
+ *				
+ *	@param[in]	frozen		Frozen map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	
+ *	@return		Pointer to key, NULL if all keys are less than `key_expr`
+ */
+#define sdmap_frozen_lower_bound(frozen, key_expr)\
+	((const sdmap_typeof(frozen[0].type_data->key) *)\
+	detail_sdmap_frozen_lower_bound_impl(\
+		(void *)frozen,\
+		detail_sdmap_pick_frozen_search(frozen[0].type_data->key),\
+		sizeof(frozen[0].type_data->key),\
+		detail_sdmap_keyexpr_to_pointer(frozen, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a frozen map.
+ *	
+ *	@details	Average time complexity - same as @ref sdmap_free
+ *
+ *	@param[in]	frozen	Frozen map object to free
+ *	
+ */
+#define sdmap_frozen_delete(frozen)\
+	detail_sdmap_frozen_delete_impl((sdmap_frozen_header **)((void *)(&frozen)))
+
+/**
+ *	@brief		String key that keeps its first bytes inline.
+ *
+ *	@details	Use as the key type instead of `char *` to make most
+ *				comparisons resolve without touching the string itself. The
+ *				first 8 bytes are packed big-endian into prefix so that
+ *				comparing two prefixes as integers orders them like `strcmp`,
+ *				the string is only followed when the prefixes tie. Create keys
+ *				with @ref sdmap_pstr_from, the string must outlive the key.
+ */
+typedef struct sdmap_pstr
 {
 	/**
-	 *	How many elements exist in the map.
+	 *	First 8 bytes of the string, big-endian and padded with zeroes.
 	 */
-	sdmap_index count;
+	uint64_t prefix;
 
 	/**
-	 *	How many slots exist in the map.
+	 *	Length of the string.
 	 */
-	sdmap_index slot_count;
+	size_t length;
 
 	/**
-	 *	Index of the root element.
+	 *	The string itself.
 	 */
-	sdmap_index root_slot;
+	const char *str;
+} sdmap_pstr;
 
-	/**
-	 *	Index of the topmost empty element.
-	 */
-	sdmap_index empty_slot;
+/**
+ *	@hideinitializer
+ *	@brief		Create a @ref sdmap_pstr key out of a string.
+ *	
+ *	@details	Average time complexity - `O(length)`
+ *
+ *	@param[in]	str		Null-terminated string
+ *	
+ *	@return		Key for the string `(sdmap_pstr)`
+ */
+#define sdmap_pstr_from(str) detail_sdmap_pstr_from_impl(str)
+
+/**
+ *	@hideinitializer
+ *	@brief		Comparison of @ref sdmap_pstr keys for @ref SDMAP_DEFINE.
+ *
+ *	@details	The prefixes are compared inline.
+ *
+ *	@param[in]	a	First key, an lvalue
+ *	@param[in]	b	Second key, an lvalue
+ *
+ *	@return		Negative, zero or positive `(int)` like `strcmp`
+ */
+#define SDMAP_COMPARE_PSTR(a, b) ((a).prefix != (b).prefix ?\
+	SDMAP_COMPARE_NATURAL((a).prefix, (b).prefix) :\
+	detail_sdmap_pstrcmp(&(a), &(b)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Natural order comparison for @ref SDMAP_DEFINE.
+ *
+ *	@param[in]	a	First key
+ *	@param[in]	b	Second key
+ *
+ *	@return		Negative, zero or positive `(int)` if a is less than, equal
+ *				to or greater than b
+ */
+#define SDMAP_COMPARE_NATURAL(a, b) (((a) > (b)) - ((a) < (b)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Generate a heap-type map type with specialized operations.
+ *
+ *	@details	Defines the map type `name`, its slot type `name##_slot` and
+ *				the following static inline functions in which the
+ *				comparison is inlined and the slot size is a constant:\n
+ *				`value_type *name##_getp(name map, key_type key)`\n
+ *				`int name##_contains(name map, key_type key)`\n
+ *				`value_type *name##_get(name *map, key_type key)`\n
+ *				`void name##_set(name *map, key_type key, value_type value)`\n
+ *				`void name##_erase(name *map, key_type key)`\n
+ *				`name##_get` inserts the key if it doesn't exist yet. Every
+ *				other macro in this library works on the generated type,
+ *				however insertions should go through the generated functions
+ *				as they install a compare function that wraps `compare`.\n
+ *				Use at file scope followed by a semicolon.
+ *
+ *	@param[in]	name		Name of the generated type, also used as the
+ *							prefix of the generated functions.
+ *	@param[in]	key_type	Type of the key in the map.
+ *	@param[in]	value_type	Type of the value in the map.
+ *	@param[in]	compare		Function or function-like macro that takes two
+ *							keys by value and returns an `int` like
+ *							@ref SDMAP_COMPARE_NATURAL.
+ */
+#define SDMAP_DEFINE(name, key_type, value_type, compare)\
+typedef sdmap(key_type, value_type) name;\
+typedef sdmap_typeof(((name)NULL)[0].type_data->slot) name##_slot;\
+static inline int name##_compare_func(const void *a, const void *b)\
+{\
+	return compare(*(const key_type *)a, *(const key_type *)b);\
+}\
+static inline sdmap_index name##_find(\
+	sdmap_header *header, key_type key, int *compare_result)\
+{\
+	name##_slot *slots = (name##_slot *)(void *)(header + 1);\
+	sdmap_index index = header->root_slot;\
+	sdmap_index next;\
+	while (1)\
+	{\
+		*compare_result = compare(slots[index].key, key);\
+		if (*compare_result == 0)\
+		{\
+			return index;\
+		}\
+		next = *compare_result > 0 ?\
+			slots[index].slot.left : slots[index].slot.right;\
+		if (next == index)\
+		{\
+			return index;\
+		}\
+		index = next;\
+	}\
+}\
+static inline value_type *name##_getp(name map, key_type key)\
+{\
+	sdmap_header *header = (sdmap_header *)(void *)map;\
+	sdmap_index index;\
+	int compare_result;\
+	if (header == NULL || header->count == 0)\
+	{\
+		return NULL;\
+	}\
+	index = name##_find(header, key, &compare_result);\
+	if (compare_result != 0)\
+	{\
+		return NULL;\
+	}\
+	return &((name##_slot *)(void *)(header + 1))[index].value;\
+}\
+static inline int name##_contains(name map, key_type key)\
+{\
+	return name##_getp(map, key) != NULL;\
+}\
+static inline value_type *name##_get(name *map, key_type key)\
+{\
+	sdmap_header **header = (sdmap_header **)(void *)map;\
+	sdmap_index index;\
+	int compare_result;\
+	detail_sdmap_ensure_initialized_impl(header,\
+		sizeof(name##_slot) * SDMAP_DEFAULT_CAPACITY, name##_compare_func,\
+		offsetof(name##_slot, key), offsetof(name##_slot, value));\
+	if ((*header)->count == 0)\
+	{\
+		return detail_sdmap_set_heap_impl(header, sizeof(name##_slot),\
+			sizeof(key_type), &key);\
+	}\
+	index = name##_find(*header, key, &compare_result);\
+	if (compare_result == 0)\
+	{\
+		return &((name##_slot *)(void *)(*header + 1))[index].value;\
+	}\
+	return detail_sdmap_attach_heap_impl(header, sizeof(name##_slot),\
+		sizeof(key_type), &key, index, compare_result);\
+}\
+static inline void name##_set(name *map, key_type key, value_type value)\
+{\
+	*name##_get(map, key) = value;\
+}\
+static inline void name##_erase(name *map, key_type key)\
+{\
+	sdmap_header **header = (sdmap_header **)(void *)map;\
+	sdmap_index index;\
+	int compare_result;\
+	if (*header == NULL || (*header)->count == 0)\
+	{\
+		return;\
+	}\
+	index = name##_find(*header, key, &compare_result);\
+	if (compare_result != 0)\
+	{\
+		return;\
+	}\
+	detail_sdmap_erase_impl(*header, sizeof(name##_slot),\
+		&((name##_slot *)(void *)(*header + 1))[index].key);\
+	if (SDMAP_ENABLE_AUTOSHRINK &&\
+		detail_sdmap_capacity_impl(*header, sizeof(name##_slot)) >=\
+			(*header)->count * SDMAP_SHRINK_DENOMINATOR)\
+	{\
+		detail_sdmap_shrink_impl(header, sizeof(name##_slot));\
+	}\
+}\
+static inline int name##_compare_func(const void *a, const void *b)
+
+/**
+ *	@hideinitializer
+ *	@brief		Heap-type ordered multimap type generator
+ *
+ *	@details	A multimap is a regular heap-type map in which a key can occur
+ *				any amount of times. Equal keys are kept as adjacent nodes of
+ *				the tree in the order they were inserted, so no extra
+ *				allocations are made per key. All the functions for heap-type
+ *				maps that do not insert work with it. To reach a specific
+ *				element among equal keys pass a pointer retrieved by a
+ *				function in this library instead of a key.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdmultimap object that satisfies the input
+ *				parameters
+ */
+#define sdmultimap(key_type, value_type) sdmap(key_type, value_type)
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert an element, even if the key already exists.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				The element goes after all elements with an equal key.
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Multimap to insert into
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[in]	value_expr	Value of the new element
+ *
+ */
+#define sdmultimap_insert(map, key_expr, value_expr)\
+	(*((sdmap_typeof(map[0].type_data->value) *)\
+		detail_sdmultimap_insert_impl(\
+			detail_sdmap_ensure_initialized(map),\
+			sizeof(map[0].type_data->slot),\
+			sizeof(map[0].type_data->key),\
+			detail_sdmap_keyexpr_to_pointer(map, key_expr))) = value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert many elements at once.
+ *
+ *	@details	Average time complexity -\n
+ *					`O(count * log(count))` for a new or empty multimap\n
+ *					`O(count * log(count + sdmap_count(map)))` otherwise\n
+ *				Space is reserved once for all elements. If the multimap is
+ *				empty the elements are sorted and linked into a balanced tree
+ *				directly. Elements with equal keys keep their order.
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Multimap to insert into
+ *	@param[in]	keys		Array of keys
+ *	@param[in]	values		Array of values, in the same order as the keys
+ *	@param[in]	count		Amount of elements in the arrays
+ *
+ */
+#define sdmultimap_insert_many(map, keys, values, count)\
+	detail_sdmultimap_insert_many_impl(\
+		detail_sdmap_ensure_initialized(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		(const sdmap_typeof(map[0].type_data->key) *){keys},\
+		(const sdmap_typeof(map[0].type_data->value) *){values},\
+		count)
+
+/**
+ *	@hideinitializer
+ *	@brief		Count the elements with a key.
+ *
+ *	@details	Average time complexity - `O(log(count) + result)`
+ *
+ *	@param[in]	map			Multimap to count in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Amount of elements with a key equal to `key_expr`
+ *				`(sdmap_index)`.
+ */
+#define sdmultimap_count(map, key_expr)\
+	detail_sdmultimap_count_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Find the range of elements with a key.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				The elements are `[first, last)` when walked with
+ *				@ref sdmap_next, values are retrieved by passing the key
+ *				pointers to @ref sdmap_getp.
+ *
+ *	@param[in]	map			Multimap to search
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[out]	first		Pointer to the first key equal to `key_expr`,
+ *							`NULL` if there is no larger or equal key
+ *	@param[out]	last		Pointer to the first key larger than `key_expr`,
+ *							`NULL` if there is none
+ *
+ */
+#define sdmultimap_equal_range(map, key_expr, first, last)\
+	detail_sdmultimap_equal_range_impl(\
+		detail_sdmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr),\
+		(const void **)((void *)&(first)),\
+		(const void **)((void *)&(last)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Adaptive simple dynamic map type generator
+ *
+ *	@details	While the map has at most @ref SDMAP_SMALL_MAX elements the
+ *				keys and values are kept in two packed sorted arrays with no
+ *				per element overhead. Primitive keys are searched with a
+ *				branch-free loop compilers turn into vector compares, other
+ *				keys with a binary search. Once the map grows past that it is
+ *				turned into a regular heap-type map and stays one.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdmap_small object that satisfies the input
+ *				parameters
+ */
+#define sdmap_small(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			struct {\
+				sdmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of elements in the map.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	map		Map to retrieve the count from.
+ *
+ *	@return		Amount of elements in map `(sdmap_index)`.
+ */
+#define sdmap_small_count(map)\
+	detail_sdmap_small_count_impl((sdmap_small_header *)((void *)map))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to a value associated with a key, if key
+ *				doesn't exist returns NULL.
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Pointer to object associated with `key_expr`, NULL if key
+ *				isn't found
+ */
+#define sdmap_small_getp(map, key_expr)\
+	((sdmap_typeof(map[0].type_data->value) *)\
+	detail_sdmap_small_getp_impl(\
+		(sdmap_small_header *)((void *)map),\
+		detail_sdmap_pick_small_find(map[0].type_data->key),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if a key exists in the map.
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map			Map to perform the test on
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdmap_small_contains(map, key_expr)\
+	(sdmap_small_getp(map, key_expr) != NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve an lvalue associated with a key, if it doesn't exist
+ *				then it is inserted.
+ *
+ *	@details	Average time complexity -\n
+ *					`O(count)` while the map is small\n
+ *					`O(log(count))` afterwards\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		lvalue object associated with `key_expr`
+ */
+#define sdmap_small_get(map, key_expr) (*((sdmap_typeof(map[0].type_data->value) *)\
+	detail_sdmap_small_set_impl(\
+		detail_sdmap_small_ensure_initialized(map),\
+		detail_sdmap_pick_small_find(map[0].type_data->key),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		_Alignof(sdmap_typeof(map[0].type_data->value)),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))))
+
+/**
+ *	@hideinitializer
+ *	@brief		Set a value to a key. If the key already exists in the map,
+ *				then it is overwritten.
+ *
+ *	@details	Average time complexity - same as @ref sdmap_small_get
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[in]	value_expr	Value to set
+ *
+ */
+#define sdmap_small_set(map, key_expr, value_expr)\
+	sdmap_small_get(map, key_expr) = value_expr
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase a key from the map.
+ *
+ *	@details	Average time complexity -\n
+ *					`O(count)` while the map is small\n
+ *					`O(log(count))` afterwards\n
+ *				Calling this function invalidates all pointers retrieved with
+ *				any function for this object in this library.
+ *
+ *	@param[in]	map			Map to erase from
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ */
+#define sdmap_small_erase(map, key_expr)\
+	detail_sdmap_small_erase_impl(\
+		(sdmap_small_header *)((void *)map),\
+		detail_sdmap_pick_small_find(map[0].type_data->key),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to the smallest key
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map		Map to retrieve key from
+ *
+ *	@return		Pointer to key, `NULL` if map is empty
+ */
+#define sdmap_small_min(map) ((const sdmap_typeof(map[0].type_data->key) *)\
+	detail_sdmap_small_min_impl(\
+		(sdmap_small_header *)((void *)map),\
+		sizeof(map[0].type_data->slot)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to the key that comes after key
+ *
+ *	@details	Average time complexity -\n
+ *					`O(log(count))`\n
+ *					`O(1)` if `key_expr` is a pointer retrieved by any
+ *					function in this library.
+ *
+ *	@param[in]	map			Map to retrieve key from
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Pointer to key, `NULL` if key is largest in map
+ */
+#define sdmap_small_next(map, key_expr)\
+	((const sdmap_typeof(map[0].type_data->key) *)\
+	detail_sdmap_small_next_impl(\
+		(sdmap_small_header *)((void *)map),\
+		detail_sdmap_pick_small_find(map[0].type_data->key),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a map.
+ *
+ *	@details	Average time complexity - same as @ref sdmap_free
+ *
+ *	@param[in]	map		Map object to free
+ *
+ */
+#define sdmap_small_delete(map)\
+	detail_sdmap_small_delete_impl((sdmap_small_header **)((void *)(&map)))
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+#ifndef SDMAP_API
+#define SDMAP_API
+#endif
+
+/**
+ *	@brief		sdmap header object.
+ */
+typedef struct sdmap_header
+{
+	/**
+	 *	How many elements exist in the map.
+	 */
+	sdmap_index count;
+
+	/**
+	 *	How many slots exist in the map.
+	 */
+	sdmap_index slot_count;
+
+	/**
+	 *	Index of the root element.
+	 */
+	sdmap_index root_slot;
+
+	/**
+	 *	Index of the topmost empty element.
+	 */
+	sdmap_index empty_slot;
 
 	/**
 	 *	Compare function.
 	 */
 	int (*compare_func)(const void *, const void *);
+
+	/**
+	 *	Offsets of the key and the value from the start of a slot.
+	 */
+	uint32_t key_offset;
+	uint32_t value_offset;
 } sdmap_header;
 
 /**
@@ -747,10 +1762,31 @@ typedef struct sdmap_header
  */
 typedef struct sdmap_heap
 {
-	sdmap_index capacity;
+	size_t capacity;
 	sdmap_header header;
 } sdmap_heap;
 
+/**
+ *	@brief		sdmap inline object.
+ *
+ *	The storage is laid out like a heap block so that the heap-type functions
+ *	work on it for as long as they don't have to grow it.
+ */
+typedef struct sdmap_inline_header
+{
+	/**
+	 *	The header of the heap block in use, NULL while the elements are in
+	 *	storage. The address of storage is taken from the object itself so
+	 *	that a copy of an in-place map does not point back into the original.
+	 */
+	sdmap_header *active;
+
+	/**
+	 *	Storage inside the object, the slots follow it.
+	 */
+	sdmap_heap storage;
+} sdmap_inline_header;
+
 /*
  *	@brief		sdmap slot object.
  *
@@ -766,8 +1802,18 @@ typedef struct sdmap_heap
  *		left == index_of_self -> no child on the left
  *		right == index_of_self -> no child on the right
  *		parent == -1 -> root node
- *			
+ *
+ *	Use detail_sdmap_parent and detail_sdmap_height to access parent and
+ *	height, with @ref SDMAP_PACKED_SLOT they share a single index.
  */
+#if SDMAP_PACKED_SLOT
+typedef struct sdmap_slot
+{
+	sdmap_index left;
+	sdmap_index right;
+	sdmap_index parent_height;
+} sdmap_slot;
+#else
 typedef struct sdmap_slot
 {
 	sdmap_index left;
@@ -775,11 +1821,114 @@ typedef struct sdmap_slot
 	sdmap_index parent;
 	int8_t height;
 } sdmap_slot;
+#endif
+
+/**
+ *	@brief		Frozen sdmap header object.
+ *
+ *	Keys follow the header in Eytzinger order, key number `k` (starting from
+ *	1) has its children at `2k` and `2k + 1`. Values are in the same order
+ *	starting at value_offset bytes from the start of the header.
+ */
+typedef struct sdmap_frozen_header
+{
+	/**
+	 *	How many elements exist in the map.
+	 */
+	sdmap_index count;
+
+	/**
+	 *	Offset of the value array from the start of the header.
+	 */
+	uint32_t value_offset;
+
+	/**
+	 *	Compare function.
+	 */
+	int (*compare_func)(const void *, const void *);
+} sdmap_frozen_header;
+
+/**
+ *	@brief		sdmap_small header object.
+ *
+ *	While the map is small the keys follow the header in ascending order and
+ *	the values are in the same order starting at value_offset bytes from the
+ *	start of the header.
+ */
+typedef struct sdmap_small_header
+{
+	/**
+	 *	How many elements are in the arrays.
+	 */
+	sdmap_index count;
+
+	/**
+	 *	How many elements the arrays have room for, 0 once the map is a tree.
+	 */
+	sdmap_index capacity;
+
+	/**
+	 *	Offset of the value array from the start of the header.
+	 */
+	uint32_t value_offset;
+
+	/**
+	 *	Compare function.
+	 */
+	int (*compare_func)(const void *, const void *);
+
+	/**
+	 *	Heap-type map holding the elements once the arrays are outgrown.
+	 */
+	sdmap_header *tree;
+} sdmap_small_header;
 
 #define detail_sdmap_heap_type char
 
 #define detail_sdmap_stack_type short
 
+#define detail_sdmap_inline_type long
+
+#if SDMAP_PACKED_SLOT
+
+#define detail_sdmap_height_bits (sizeof(sdmap_index) > 2 ? 6 : 5)
+
+#define detail_sdmap_parent_bits (sizeof(sdmap_index) * 8 - detail_sdmap_height_bits)
+
+#define detail_sdmap_parent_mask ((sdmap_index)((sdmap_index)-1 >> detail_sdmap_height_bits))
+
+/*The parent bits are all set for the root, the height bits hold height + 1*/
+#define detail_sdmap_parent(slot)\
+	((((slot)->parent_height) & detail_sdmap_parent_mask) == detail_sdmap_parent_mask ?\
+		(sdmap_index)-1 : (sdmap_index)(((slot)->parent_height) & detail_sdmap_parent_mask))
+
+#define detail_sdmap_height(slot)\
+	((int8_t)((int)((slot)->parent_height >> detail_sdmap_parent_bits) - 1))
+
+#define detail_sdmap_set_parent(slot, value)\
+	((slot)->parent_height = (sdmap_index)(((slot)->parent_height & ~detail_sdmap_parent_mask) |\
+		((sdmap_index)(value) & detail_sdmap_parent_mask)))
+
+#define detail_sdmap_set_height(slot, value)\
+	((slot)->parent_height = (sdmap_index)(((slot)->parent_height & detail_sdmap_parent_mask) |\
+		((sdmap_index)((value) + 1) << detail_sdmap_parent_bits)))
+
+#define detail_sdmap_max_slot_count detail_sdmap_parent_mask
+
+#else
+
+#define detail_sdmap_parent(slot) ((slot)->parent)
+
+#define detail_sdmap_height(slot) ((slot)->height)
+
+#define detail_sdmap_set_parent(slot, value) ((slot)->parent = (value))
+
+#define detail_sdmap_set_height(slot, value) ((slot)->height = (int8_t)(value))
+
+#define detail_sdmap_max_slot_count ((sdmap_index)-1)
+
+#endif
+
 #define detail_sdmap_keyexpr_to_pointer(map, key_expr) _Generic(key_expr,\
 	sdmap_typeof(map[0].type_data->key) :\
 		detail_sdmap_key_to_complit(map, key_expr),\
@@ -790,24 +1939,81 @@ typedef struct sdmap_slot
 #define detail_sdmap_m2h(map) ((sdmap_header *)\
 	((void *) _Generic(map[0].type_data->storage_type,\
 		detail_sdmap_heap_type : map,\
-		detail_sdmap_stack_type : map))\
+		detail_sdmap_stack_type : map,\
+		detail_sdmap_inline_type : detail_sdmap_inline_active(map)))\
 	)
 
+#define detail_sdmap_require_heap(map, func_name) ((void)sizeof(struct {\
+	_Static_assert(_Generic(map[0].type_data->storage_type,\
+		detail_sdmap_heap_type : 1,\
+		default : 0),\
+		func_name " only accepts heap-type maps");\
+	int dummy;\
+	}))
+
 #define detail_sdmap_m2hp(map) ((sdmap_header **)\
 	((void *) _Generic(map[0].type_data->storage_type,\
 		detail_sdmap_heap_type : &map,\
-		detail_sdmap_stack_type : map))\
+		detail_sdmap_stack_type : map,\
+		detail_sdmap_inline_type : map))\
 	)
 
 #define detail_sdmap_m2h_initialized(map) ((void *)\
 	_Generic(map[0].type_data->storage_type,\
 		detail_sdmap_heap_type : detail_sdmap_ensure_initialized(map),\
-		detail_sdmap_stack_type : map)\
+		detail_sdmap_stack_type : map,\
+		detail_sdmap_inline_type : detail_sdmap_m2h(map))\
+	)
+
+#define detail_sdmap_combine_merge 0
+
+#define detail_sdmap_combine_intersect 1
+
+#define detail_sdmap_combine_difference 2
+
+#define detail_sdmap_combine(map, source, operation, conflict_func)\
+	_Generic(map[0].type_data->storage_type,\
+	detail_sdmap_heap_type :\
+		detail_sdmap_combine_heap_impl(\
+			(void *)(&map),\
+			sizeof(map[0].type_data->slot),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+			detail_sdmap_m2h(source),\
+			operation,\
+			conflict_func),\
+	detail_sdmap_stack_type :\
+		detail_sdmap_combine_stack_impl(\
+			detail_sdmap_m2h(map),\
+			sdmap_capacity(map),\
+			sizeof(map[0].type_data->slot),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+			detail_sdmap_m2h(source),\
+			operation,\
+			conflict_func),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_combine_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			sizeof(map[0].type_data->slot),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+			detail_sdmap_m2h(source),\
+			operation,\
+			conflict_func)\
 	)
 
 #define detail_sdmap_stack_capacity(map)\
 	(sdmap_index)((sizeof(map) - sizeof(sdmap_header)) / sizeof(sdmap_slot))
 
+#define detail_sdmap_inline_capacity(map)\
+	(size_t)(sizeof(map) - sizeof(sdmap_inline_header))
+
+#define detail_sdmap_inline_in_place(map)\
+	(((sdmap_inline_header *)((void *)(map)))->active == NULL)
+
+#define detail_sdmap_inline_active(map)\
+	(detail_sdmap_inline_in_place(map) ?\
+		&((sdmap_inline_header *)((void *)(map)))->storage.header :\
+		((sdmap_inline_header *)((void *)(map)))->active)
+
 #define detail_sdmap_getter_upto_3(_1, _2, _3, NAME, ...) NAME
 
 #define detail_sdmap_getter_upto_2(_1, _2, NAME, ...) NAME
@@ -816,11 +2022,22 @@ typedef struct sdmap_slot
 	detail_sdmap_heap_type : detail_sdmap_new_heap_impl(\
 		detail_sdmap_m2hp(map),\
 		sizeof(map[0].type_data->slot) * (SDMAP_DEFAULT_CAPACITY),\
-		detail_sdmap_pick_compare_func(map[0].type_data->key)),\
+		detail_sdmap_pick_compare_func(map[0].type_data->key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
 	detail_sdmap_stack_type :\
 		detail_sdmap_new_stack_impl(\
 			detail_sdmap_m2h(map),\
-			detail_sdmap_pick_compare_func(map[0].type_data->key))\
+			detail_sdmap_pick_compare_func(map[0].type_data->key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_new_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			detail_sdmap_inline_capacity(map),\
+			detail_sdmap_pick_compare_func(map[0].type_data->key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value))\
 )
 
 #define detail_sdmap_new2(map, function) _Generic(\
@@ -829,11 +2046,22 @@ typedef struct sdmap_slot
 		detail_sdmap_new_heap_impl(\
 			detail_sdmap_m2hp(map),\
 			sizeof(map[0].type_data->slot) * (SDMAP_DEFAULT_CAPACITY),\
-		function),\
+		function,\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
 	detail_sdmap_stack_type :\
 		detail_sdmap_new_stack_impl(\
 			detail_sdmap_m2h(map),\
-			function)\
+			function,\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
+	detail_sdmap_inline_type :\
+		detail_sdmap_new_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			detail_sdmap_inline_capacity(map),\
+			function,\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value))\
 )
 
 #define detail_sdmap_new3(map, function, capacity)\
@@ -841,10 +2069,23 @@ typedef struct sdmap_slot
 	detail_sdmap_heap_type : detail_sdmap_new_heap_impl(\
 		detail_sdmap_m2hp(map),\
 		sizeof(map[0].type_data->slot) * (capacity),\
-		function),\
+		function,\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
 	detail_sdmap_stack_type :\
 		sdmap_assert(0 && "sdmap_new called with 3 arguments on a stack-type\
-map")\
+map"),\
+	detail_sdmap_inline_type :\
+		(detail_sdmap_new_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			detail_sdmap_inline_capacity(map),\
+			function,\
+			offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+			offsetof(sdmap_typeof(map[0].type_data->slot), value)),\
+		detail_sdmap_reserve_inline_impl(\
+			detail_sdmap_m2hp(map),\
+			sizeof(map[0].type_data->slot),\
+			sizeof(map[0].type_data->slot) * (capacity)))\
 )\
 
 #define detail_sdmap_traverse_inorder_keys1(map, function)\
@@ -938,7 +2179,9 @@ map")\
 	detail_sdmap_ensure_initialized_impl(\
 		(void *)(&map),\
 		(sizeof(map[0].type_data->slot)) *	SDMAP_DEFAULT_CAPACITY,\
-		detail_sdmap_pick_compare_func(map[0].type_data->key))
+		detail_sdmap_pick_compare_func(map[0].type_data->key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value))
 
 #define detail_sdmap_key_to_complit2(map, key_value)\
 	_Generic(key_value, \
@@ -947,8 +2190,8 @@ map")\
 	)
 
 #define detail_sdmap_key_to_complit(map, key_value)\
-	((const void *)(&((sdmap_typeof(map[0].type_data->key))\
-		{detail_sdmap_key_to_complit2(map, key_value)})))
+	((const void *)((sdmap_typeof(map[0].type_data->key)[1])\
+		{detail_sdmap_key_to_complit2(map, key_value)}))
 
 #define detail_sdmap_pick_compare_func(key) _Generic(key,\
 	uint8_t: detail_sdmap_compare_uint8_t,\
@@ -963,6 +2206,7 @@ map")\
 	double: detail_sdmap_compare_double,\
 	long double: detail_sdmap_compare_long_double,\
 	char *: detail_sdmap_strcmp,\
+	sdmap_pstr: detail_sdmap_pstrcmp,\
 	default: NULL\
 	)
 
@@ -983,6 +2227,132 @@ detail_sdmap_declare_compare_func(long double, long_double)
 
 SDMAP_API int detail_sdmap_strcmp(const void *a, const void *b);
 
+SDMAP_API int detail_sdmap_pstrcmp(const void *a, const void *b);
+
+SDMAP_API sdmap_pstr detail_sdmap_pstr_from_impl(const char *str);
+
+#define detail_sdmap_pick_frozen_search(key) _Generic(key,\
+	uint8_t: detail_sdmap_frozen_search_uint8_t,\
+	uint16_t: detail_sdmap_frozen_search_uint16_t,\
+	uint32_t: detail_sdmap_frozen_search_uint32_t,\
+	uint64_t: detail_sdmap_frozen_search_uint64_t,\
+	int8_t: detail_sdmap_frozen_search_int8_t,\
+	int16_t: detail_sdmap_frozen_search_int16_t,\
+	int32_t: detail_sdmap_frozen_search_int32_t,\
+	int64_t: detail_sdmap_frozen_search_int64_t,\
+	float: detail_sdmap_frozen_search_float,\
+	double: detail_sdmap_frozen_search_double,\
+	long double: detail_sdmap_frozen_search_long_double,\
+	default: detail_sdmap_frozen_search_generic\
+	)
+
+#define detail_sdmap_declare_frozen_search_func(type, postfix)\
+SDMAP_API sdmap_index detail_sdmap_frozen_search_##postfix(\
+	sdmap_frozen_header *header, uint32_t key_size, const void *key);
+
+detail_sdmap_declare_frozen_search_func(uint8_t, uint8_t)
+detail_sdmap_declare_frozen_search_func(uint16_t, uint16_t)
+detail_sdmap_declare_frozen_search_func(uint32_t, uint32_t)
+detail_sdmap_declare_frozen_search_func(uint64_t, uint64_t)
+detail_sdmap_declare_frozen_search_func(int8_t, int8_t)
+detail_sdmap_declare_frozen_search_func(int16_t, int16_t)
+detail_sdmap_declare_frozen_search_func(int32_t, int32_t)
+detail_sdmap_declare_frozen_search_func(int64_t, int64_t)
+detail_sdmap_declare_frozen_search_func(float, float)
+detail_sdmap_declare_frozen_search_func(double, double)
+detail_sdmap_declare_frozen_search_func(long double, long_double)
+detail_sdmap_declare_frozen_search_func(void, generic)
+
+#define detail_sdmap_small_ensure_initialized(map)\
+	detail_sdmap_small_ensure_initialized_impl(\
+		(sdmap_small_header **)((void *)(&map)),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		_Alignof(sdmap_typeof(map[0].type_data->value)),\
+		detail_sdmap_pick_compare_func(map[0].type_data->key))
+
+#define detail_sdmap_pick_small_find(key) _Generic(key,\
+	uint8_t: detail_sdmap_small_find_uint8_t,\
+	uint16_t: detail_sdmap_small_find_uint16_t,\
+	uint32_t: detail_sdmap_small_find_uint32_t,\
+	uint64_t: detail_sdmap_small_find_uint64_t,\
+	int8_t: detail_sdmap_small_find_int8_t,\
+	int16_t: detail_sdmap_small_find_int16_t,\
+	int32_t: detail_sdmap_small_find_int32_t,\
+	int64_t: detail_sdmap_small_find_int64_t,\
+	float: detail_sdmap_small_find_float,\
+	double: detail_sdmap_small_find_double,\
+	long double: detail_sdmap_small_find_long_double,\
+	default: detail_sdmap_small_find_generic\
+	)
+
+#define detail_sdmap_declare_small_find_func(type, postfix)\
+SDMAP_API sdmap_index detail_sdmap_small_find_##postfix(\
+	sdmap_small_header *header, uint32_t key_size, const void *key, int *found);
+
+detail_sdmap_declare_small_find_func(uint8_t, uint8_t)
+detail_sdmap_declare_small_find_func(uint16_t, uint16_t)
+detail_sdmap_declare_small_find_func(uint32_t, uint32_t)
+detail_sdmap_declare_small_find_func(uint64_t, uint64_t)
+detail_sdmap_declare_small_find_func(int8_t, int8_t)
+detail_sdmap_declare_small_find_func(int16_t, int16_t)
+detail_sdmap_declare_small_find_func(int32_t, int32_t)
+detail_sdmap_declare_small_find_func(int64_t, int64_t)
+detail_sdmap_declare_small_find_func(float, float)
+detail_sdmap_declare_small_find_func(double, double)
+detail_sdmap_declare_small_find_func(long double, long_double)
+detail_sdmap_declare_small_find_func(void, generic)
+
+SDMAP_API sdmap_small_header **detail_sdmap_small_ensure_initialized_impl(
+	sdmap_small_header **header,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_align,
+	int (*compare_func)(const void *, const void *));
+
+SDMAP_API sdmap_index detail_sdmap_small_count_impl(sdmap_small_header *header);
+
+SDMAP_API void *detail_sdmap_small_getp_impl(
+	sdmap_small_header *header,
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *),
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_offset,
+	const void *key);
+
+SDMAP_API void *detail_sdmap_small_set_impl(
+	sdmap_small_header **header,
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *),
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
+	uint32_t value_align,
+	const void *key);
+
+SDMAP_API void detail_sdmap_small_erase_impl(
+	sdmap_small_header *header,
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *),
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	const void *key);
+
+SDMAP_API void *detail_sdmap_small_min_impl(
+	sdmap_small_header *header,
+	uint32_t slot_size);
+
+SDMAP_API void *detail_sdmap_small_next_impl(
+	sdmap_small_header *header,
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *),
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDMAP_API void detail_sdmap_small_delete_impl(sdmap_small_header **header);
+
 SDMAP_API sdmap_index detail_sdmap_count_impl(sdmap_header *header);
 
 SDMAP_API sdmap_index detail_sdmap_capacity_impl(
@@ -991,12 +2361,16 @@ SDMAP_API sdmap_index detail_sdmap_capacity_impl(
 
 SDMAP_API void detail_sdmap_new_heap_impl(
 	sdmap_header **header,
-	sdmap_index capacity,
-	int (*compare_func)(const void *, const void *));
+	size_t capacity,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDMAP_API void detail_sdmap_new_stack_impl(
 	sdmap_header *header,
-	int (*compare_func)(const void *, const void *));
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDMAP_API void detail_sdmap_duplicate_heap_heap_impl(
 	sdmap_header **header,
@@ -1006,6 +2380,8 @@ SDMAP_API void detail_sdmap_duplicate_stack_heap_impl(
 	sdmap_header *header,
 	sdmap_index dest_capacity,
 	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
 	sdmap_header *source);
 
 SDMAP_API void detail_sdmap_duplicate_heap_stack_impl(
@@ -1022,8 +2398,10 @@ SDMAP_API void detail_sdmap_duplicate_stack_stack_impl(
 
 SDMAP_API sdmap_header **detail_sdmap_ensure_initialized_impl(
 	sdmap_header **header,
-	sdmap_index capacity,
-	int (*compare_func)(const void *, const void *));
+	size_t capacity,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset);
 
 SDMAP_API int detail_sdmap_contains_impl(
 	sdmap_header *header,
@@ -1042,6 +2420,11 @@ SDMAP_API void detail_sdmap_optimize_impl(
 	sdmap_header *header,
 	uint32_t slot_size);
 
+SDMAP_API void detail_sdmap_relayout_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	int layout);
+
 SDMAP_API void detail_sdmap_shrink_impl(
 	sdmap_header **header,
 	uint32_t slot_size);
@@ -1074,6 +2457,23 @@ SDMAP_API void *detail_sdmap_getp_impl(
 	uint32_t value_offset,
 	const void *key);
 
+SDMAP_API void detail_sdmap_getp_many_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_offset,
+	const void *keys,
+	size_t count,
+	void **out);
+
+SDMAP_API void *detail_sdmap_attach_heap_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key,
+	sdmap_index parent,
+	int compare_result);
+
 SDMAP_API void *detail_sdmap_set_heap_impl(
 	sdmap_header **header,
 	uint32_t slot_size,
@@ -1092,6 +2492,150 @@ SDMAP_API void detail_sdmap_erase_impl(
 	uint32_t slot_size,
 	const void *key);
 
+SDMAP_API void detail_sdmap_combine_heap_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	sdmap_header *source,
+	int operation,
+	void (*conflict_func)(const void *, void *, const void *));
+
+SDMAP_API void detail_sdmap_combine_stack_impl(
+	sdmap_header *header,
+	sdmap_index capacity,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	sdmap_header *source,
+	int operation,
+	void (*conflict_func)(const void *, void *, const void *));
+
+SDMAP_API void detail_sdmap_new_inline_impl(
+	sdmap_header **header,
+	size_t capacity,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset);
+
+SDMAP_API void detail_sdmap_inline_adopt(
+	sdmap_header **header,
+	uint32_t slot_size,
+	sdmap_header *block);
+
+SDMAP_API void detail_sdmap_reserve_inline_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	size_t capacity);
+
+SDMAP_API void detail_sdmap_duplicate_inline_impl(
+	sdmap_header **header,
+	size_t capacity,
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
+	sdmap_header *source);
+
+SDMAP_API void *detail_sdmap_set_inline_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDMAP_API void detail_sdmap_shrink_inline_impl(
+	sdmap_header **header,
+	uint32_t slot_size);
+
+SDMAP_API void detail_sdmap_combine_inline_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	sdmap_header *source,
+	int operation,
+	void (*conflict_func)(const void *, void *, const void *));
+
+SDMAP_API void detail_sdmap_delete_inline_impl(sdmap_header **header);
+
+SDMAP_API void detail_sdmap_split_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	const void *key,
+	sdmap_header **left,
+	sdmap_header **right);
+
+SDMAP_API void detail_sdmap_join_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	sdmap_header **other);
+
+SDMAP_API void detail_sdmap_erase_range_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	const void *first,
+	const void *last);
+
+SDMAP_API void *detail_sdmultimap_insert_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key);
+
+SDMAP_API void detail_sdmultimap_insert_many_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_offset,
+	const void *keys,
+	const void *values,
+	sdmap_index count);
+
+SDMAP_API sdmap_index detail_sdmultimap_count_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	const void *key);
+
+SDMAP_API void detail_sdmultimap_equal_range_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	const void *key,
+	const void **first,
+	const void **last);
+
+SDMAP_API void detail_sdmap_freeze_impl(
+	sdmap_frozen_header **frozen,
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_offset,
+	uint32_t value_align);
+
+SDMAP_API void detail_sdmap_thaw_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
+	sdmap_frozen_header *frozen);
+
+SDMAP_API sdmap_index detail_sdmap_frozen_count_impl(
+	sdmap_frozen_header *frozen);
+
+SDMAP_API void *detail_sdmap_frozen_getp_impl(
+	sdmap_frozen_header *frozen,
+	sdmap_index (*search_func)(sdmap_frozen_header *, uint32_t, const void *),
+	uint32_t key_size,
+	uint32_t value_size,
+	const void *key);
+
+SDMAP_API void *detail_sdmap_frozen_lower_bound_impl(
+	sdmap_frozen_header *frozen,
+	sdmap_index (*search_func)(sdmap_frozen_header *, uint32_t, const void *),
+	uint32_t key_size,
+	const void *key);
+
+SDMAP_API void detail_sdmap_frozen_delete_impl(sdmap_frozen_header **frozen);
+
 SDMAP_API void detail_sdmap_delete_impl(sdmap_header **header);
 
 SDMAP_API void detail_sdmap_dummy_impl(void);
@@ -38,7 +38,7 @@ while(1)\
 	}\
 	for (uint32_t i = 0; i < printhead->slot_count; i++)\
 	{\
-		if (detail_sdmap_slot(printhead, i)->height >= 0) \
+		if (detail_sdmap_height(detail_sdmap_slot(printhead, i)) >= 0) \
 		{\
 			int balance;\
 			balance = 0xFFFFFFFF;\
@@ -46,14 +46,14 @@ while(1)\
 			{\
 				balance = detail_sdmap_compute_balance(printhead, sizeof(sdmap_slot) + sizeof(map[0].type_data->key) + sizeof(map[0].type_data->value), i);\
 			}\
-			printf("slot:%d  balance:%d  height:%d", i, balance, (int)detail_sdmap_slot(printhead, i)->height);\
+			printf("slot:%d  balance:%d  height:%d", i, balance, (int)detail_sdmap_height(detail_sdmap_slot(printhead, i)));\
 			if (detail_sdmap_slot(printhead, i)->left == i)\
 			{\
 				printf("  left:#");\
 			}\
 			else\
 			{\
-				printf("  left:%d", detail_sdmap_slot(printhead, i)->left);\
+				printf("  left:%d", (int)detail_sdmap_slot(printhead, i)->left);\
 			}\
 			if (detail_sdmap_slot(printhead, i)->right == i)\
 			{\
@@ -61,9 +61,9 @@ while(1)\
 			}\
 			else\
 			{\
-				printf("  right:%d", detail_sdmap_slot(printhead, i)->right);\
+				printf("  right:%d", (int)detail_sdmap_slot(printhead, i)->right);\
 			}\
-			printf("  parent:%d", detail_sdmap_slot(printhead, i)->parent);\
+			printf("  parent:%d", (int)detail_sdmap_parent(detail_sdmap_slot(printhead, i)));\
 			printf("  key:");\
 			printf(debug_sdmap_pickformat(map[0].type_data->key), *detail_sdmap_get_key(map, i));\
 			printf("  value:");\
@@ -72,7 +72,7 @@ while(1)\
 		}\
 		else\
 		{\
-			printf("slot:%d EMPTY next:%d  height:%d %p\n", i, (int)detail_sdmap_slot(printhead, i)->right, (int)detail_sdmap_slot(printhead, i)->height, (void *)detail_sdmap_slot(printhead, i));\
+			printf("slot:%d EMPTY next:%d  height:%d %p\n", i, (int)detail_sdmap_slot(printhead, i)->right, (int)detail_sdmap_height(detail_sdmap_slot(printhead, i)), (void *)detail_sdmap_slot(printhead, i));\
 		}\
 	}\
 	break;\
@@ -86,11 +86,11 @@ static inline int detail_sdmap_compute_balance(sdmap_header *header, uint32_t sl
 	sdmap_slot *slot = detail_sdmap_slot(header, node);
 	if (slot->left != node)
 	{
-		result -= 1 + detail_sdmap_slot(header, slot->left)->height;
+		result -= 1 + detail_sdmap_height(detail_sdmap_slot(header, slot->left));
 	}
 	if (slot->right != node)
 	{
-		result += 1 + detail_sdmap_slot(header, slot->right)->height;
+		result += 1 + detail_sdmap_height(detail_sdmap_slot(header, slot->right));
 	}
 	return result;
 }
@@ -120,12 +120,11 @@ static inline void debug_sdmap_printtree_impl(void *header, uint32_t key_size, u
 	}
 }
 
-#define debug_sdmap_sanity_checks(map) debug_sdmap_sanity_checks_impl(detail_sdmap_m2h(map), sizeof(map[0].type_data->key), sizeof(map[0].type_data->value))
+#define debug_sdmap_sanity_checks(map) debug_sdmap_sanity_checks_impl(detail_sdmap_m2h(map), sizeof(map[0].type_data->slot))
 
-static inline int debug_sdmap_sanity_header(sdmap_header *header, uint32_t key_size, uint32_t value_size)
+static inline int debug_sdmap_sanity_header(sdmap_header *header, uint32_t slot_size)
 {
-	(void)key_size;
-	(void)value_size;
+	(void)slot_size;
 	if (header == NULL)
 	{
 		return 0;
@@ -159,7 +158,7 @@ static inline sdmap_index debug_sdmap_sanity_count_helper(sdmap_header *header,
 	return count;
 }
 
-static inline int debug_sdmap_sanity_count(sdmap_header *header, uint32_t key_size, uint32_t value_size)
+static inline int debug_sdmap_sanity_count(sdmap_header *header, uint32_t slot_size)
 {
 	if (header == NULL)
 	{
@@ -169,7 +168,7 @@ static inline int debug_sdmap_sanity_count(sdmap_header *header, uint32_t key_si
 	{
 		return 0;
 	}
-	sdmap_index read_count = debug_sdmap_sanity_count_helper(header, sizeof(sdmap_slot) + key_size + value_size, header->root_slot);
+	sdmap_index read_count = debug_sdmap_sanity_count_helper(header, slot_size, header->root_slot);
 	if (read_count != header->count)
 	{
 		printf("read_count=%d  header->count=%d\n", (int)read_count, (int)header->count);
@@ -178,9 +177,8 @@ static inline int debug_sdmap_sanity_count(sdmap_header *header, uint32_t key_si
 	return 0;
 }
 
-static inline int debug_sdmap_sanity_empty_count(sdmap_header *header, uint32_t key_size, uint32_t value_size)
+static inline int debug_sdmap_sanity_empty_count(sdmap_header *header, uint32_t slot_size)
 {
-	const uint32_t slot_size = sizeof(sdmap_slot) + key_size + value_size;
 	sdmap_index slot_index;
 	sdmap_index count;
 	if (header == NULL)
@@ -200,9 +198,9 @@ static inline int debug_sdmap_sanity_empty_count(sdmap_header *header, uint32_t
 	while (slot_index != (sdmap_index)-1)
 	{
 		count ++;
-		if (detail_sdmap_slot(header, slot_index)->height >= 0)
+		if (detail_sdmap_height(detail_sdmap_slot(header, slot_index)) >= 0)
 		{
-			printf("positive height=%d empty slot=%d  %p\n", (int)detail_sdmap_slot(header, slot_index)->height, (int)slot_index, (void *)detail_sdmap_slot(header, slot_index));
+			printf("positive height=%d empty slot=%d  %p\n", (int)detail_sdmap_height(detail_sdmap_slot(header, slot_index)), (int)slot_index, (void *)detail_sdmap_slot(header, slot_index));
 			return 1;
 		}
 		slot_index = detail_sdmap_slot(header, slot_index)->right;
@@ -238,13 +236,13 @@ static inline int debug_sdmap_sanity_nodes_helper(sdmap_header *header, uint32_t
 	sdmap_index parent;
 	if (detail_sdmap_slot(header, index)->right >= header->slot_count ||
 		detail_sdmap_slot(header, index)->left >= header->slot_count ||
-		detail_sdmap_slot(header, index)->height < 0 ||
-		detail_sdmap_slot(header, index)->height != debug_sdmap_sanity_height(header, slot_size, index))
+		detail_sdmap_height(detail_sdmap_slot(header, index)) < 0 ||
+		detail_sdmap_height(detail_sdmap_slot(header, index)) != debug_sdmap_sanity_height(header, slot_size, index))
 	{
 		printf("node %d has incorrect pointers right=%d left=%d height%d header->slot_count=%d\n", (int)index, 
 			(int)detail_sdmap_slot(header, index)->right,
 			(int)detail_sdmap_slot(header, index)->left,
-			(int)detail_sdmap_slot(header, index)->height,
+			(int)detail_sdmap_height(detail_sdmap_slot(header, index)),
 			(int)header->slot_count);
 		return 1;
 	}
@@ -254,7 +252,7 @@ static inline int debug_sdmap_sanity_nodes_helper(sdmap_header *header, uint32_t
 		printf("balance of node %d is %d\n", (int)index, (int)balance);
 		return 1;
 	}
-	if (detail_sdmap_slot(header, index)->parent == (sdmap_index)-1)
+	if (detail_sdmap_parent(detail_sdmap_slot(header, index)) == (sdmap_index)-1)
 	{
 		if (header->root_slot != index)
 		{
@@ -264,7 +262,7 @@ static inline int debug_sdmap_sanity_nodes_helper(sdmap_header *header, uint32_t
 	}
 	else
 	{
-		parent = detail_sdmap_slot(header, index)->parent;
+		parent = detail_sdmap_parent(detail_sdmap_slot(header, index));
 		if (parent >= header->slot_count)
 		{
 			printf("node %d, parent=%d is out of range=%d\n", (int)index, (int)parent, (int)header->slot_count);
@@ -296,7 +294,7 @@ static inline int debug_sdmap_sanity_nodes_helper(sdmap_header *header, uint32_t
 	return 0;
 }
 
-static inline int debug_sdmap_sanity_nodes(sdmap_header *header, uint32_t key_size, uint32_t value_size)
+static inline int debug_sdmap_sanity_nodes(sdmap_header *header, uint32_t slot_size)
 {
 	if (header == NULL)
 	{
@@ -306,24 +304,24 @@ static inline int debug_sdmap_sanity_nodes(sdmap_header *header, uint32_t key_si
 	{
 		return 0;
 	}
-	return debug_sdmap_sanity_nodes_helper(header, sizeof(sdmap_slot) + key_size + value_size, header->root_slot);
+	return debug_sdmap_sanity_nodes_helper(header, slot_size, header->root_slot);
 }
 
-static inline const char *debug_sdmap_sanity_checks_impl(sdmap_header *header, uint32_t key_size, uint32_t value_size)
+static inline const char *debug_sdmap_sanity_checks_impl(sdmap_header *header, uint32_t slot_size)
 {
-	if (debug_sdmap_sanity_header(header, key_size, value_size))
+	if (debug_sdmap_sanity_header(header, slot_size))
 	{
 		return "header";
 	}
-	if (debug_sdmap_sanity_count(header, key_size, value_size))
+	if (debug_sdmap_sanity_count(header, slot_size))
 	{
 		return "count";
 	}
-	if (debug_sdmap_sanity_empty_count(header, key_size, value_size))
+	if (debug_sdmap_sanity_empty_count(header, slot_size))
 	{
 		return "empty";
 	}
-	if (debug_sdmap_sanity_nodes(header, key_size, value_size))
+	if (debug_sdmap_sanity_nodes(header, slot_size))
 	{
 		return "nodes";
 	}
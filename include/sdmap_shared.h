@@ -0,0 +1,245 @@
+/**
+ *	@file sdmap_shared.h	Simple dynamic map object for C with one writer
+ *							and any amount of readers that take no locks.
+ *	@date					18. Oct 2026
+ *	@author					Mihkel Aaremäe
+ */
+#ifndef SDMAP_SHARED_H
+#define SDMAP_SHARED_H
+
+#include <sdmap.h>
+#include <stdatomic.h>
+
+/**
+ *	@hideinitializer
+ *	@brief		Shared simple dynamic map type generator
+ *
+ *	@details	The map has a single writer. Readers never write to shared
+ *				memory, they read optimistically and retry when the writer
+ *				changed the map in the meantime.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdmap_shared object that satisfies the input
+ *				parameters
+ */
+#define sdmap_shared(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			struct {\
+				sdmap_slot slot;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of elements in the map.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Can be called by readers.
+ *
+ *	@param[in]	map		Map to retrieve the count from.
+ *
+ *	@return		Amount of elements in map `(sdmap_index)`.
+ */
+#define sdmap_shared_count(map) detail_sdmap_shared_count_impl(\
+	(sdmap_shared_header *)((void *)map))
+
+/**
+ *	@hideinitializer
+ *	@brief		Copy out the value associated with a key.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Can be called by readers. No pointer into the map is handed
+ *				out because the writer may change the value right after the
+ *				lookup, the value is copied while the map is known to be
+ *				consistent instead. Key types whose compare function follows
+ *				pointers (like strings) must keep the pointed to memory alive
+ *				for as long as readers may look at the key. A lookup that
+ *				raced the writer may have written to value_ptr before being
+ *				retried, so its contents are only meaningful when the key
+ *				exists.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[out]	value_ptr	Pointer to where the value is copied, may be NULL
+ *
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdmap_shared_read(map, key_expr, value_ptr)\
+	detail_sdmap_shared_read_impl(\
+		(sdmap_shared_header *)((void *)map),\
+		sizeof(map[0].type_data->slot),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		sizeof(map[0].type_data->value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr),\
+		(sdmap_typeof(map[0].type_data->value) *){value_ptr})
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if a key exists in the map.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Can be called by readers.
+ *
+ *	@param[in]	map			Map to perform the test on
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdmap_shared_contains(map, key_expr)\
+	sdmap_shared_read(map, key_expr, NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Set a value to a key. If the key already exists in the map,
+ *				then it is overwritten.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Only the writer may call this. When the map runs out of
+ *				capacity the slots are copied to a new allocation and the old
+ *				one is kept for readers that may still be in it, see
+ *				@ref sdmap_shared_reclaim.
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[in]	value_expr	Value to set
+ *
+ */
+#define sdmap_shared_set(map, key_expr, value_expr)\
+	detail_sdmap_shared_set_impl(\
+		detail_sdmap_shared_ensure_initialized(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		sizeof(map[0].type_data->value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr),\
+		(const sdmap_typeof(map[0].type_data->value)[1]){value_expr})
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase a key from the map.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Only the writer may call this.
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ */
+#define sdmap_shared_erase(map, key_expr)\
+	detail_sdmap_shared_erase_impl(\
+		(sdmap_shared_header *)((void *)map),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free the allocations the map has grown out of.
+ *
+ *	@details	Average time complexity - `O(retired allocations)`\n
+ *				Only the writer may call this, and only at a point where no
+ *				reader can be in the middle of a lookup. Since the capacity
+ *				doubles every time, the retired allocations never take more
+ *				memory than the current one.
+ *
+ *	@param[in]	map		Map to reclaim memory of
+ *
+ */
+#define sdmap_shared_reclaim(map)\
+	detail_sdmap_shared_reclaim_impl((sdmap_shared_header *)((void *)map))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a map.
+ *
+ *	@details	Average time complexity - same as @ref sdmap_free\n
+ *				There must be no readers left.
+ *
+ *	@param[in]	map		Map object to free
+ *
+ */
+#define sdmap_shared_delete(map)\
+	detail_sdmap_shared_delete_impl((sdmap_shared_header **)((void *)(&map)))
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+/**
+ *	@brief		Shared sdmap header object.
+ */
+typedef struct sdmap_shared_header
+{
+	/**
+	 *	Odd while the writer is changing the map.
+	 */
+	atomic_uint sequence;
+
+	/**
+	 *	Header of the heap-type map holding the elements.
+	 */
+	_Atomic(sdmap_header *) map;
+
+	/**
+	 *	Allocations the map has grown out of.
+	 */
+	sdmap_heap **retired;
+
+	/**
+	 *	Amount of retired allocations.
+	 */
+	sdmap_index retired_count;
+} sdmap_shared_header;
+
+#define detail_sdmap_shared_ensure_initialized(map)\
+	detail_sdmap_shared_ensure_initialized_impl(\
+		(sdmap_shared_header **)((void *)(&map)),\
+		detail_sdmap_pick_compare_func(map[0].type_data->key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value))
+
+SDMAP_API sdmap_shared_header *detail_sdmap_shared_ensure_initialized_impl(
+	sdmap_shared_header **header,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset);
+
+SDMAP_API sdmap_index detail_sdmap_shared_count_impl(sdmap_shared_header *header);
+
+SDMAP_API int detail_sdmap_shared_read_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	uint32_t value_size,
+	const void *key,
+	void *value);
+
+SDMAP_API void detail_sdmap_shared_set_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	const void *key,
+	const void *value);
+
+SDMAP_API void detail_sdmap_shared_erase_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	const void *key);
+
+SDMAP_API void detail_sdmap_shared_reclaim_impl(sdmap_shared_header *header);
+
+SDMAP_API void detail_sdmap_shared_delete_impl(sdmap_shared_header **header);
+
+/**
+ *	@endcond
+ */
+
+#endif
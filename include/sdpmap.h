@@ -0,0 +1,446 @@
+/**
+ *	@file sdpmap.h	Persistent simple dynamic map object for C, updates copy
+ *					the path to the changed node so that snapshots of older
+ *					versions stay valid.
+ *	@date			18. Oct 2026
+ *	@author			Mihkel Aaremäe
+ */
+#ifndef SDPMAP_H
+#define SDPMAP_H
+
+#include <sdmap.h>
+
+#ifndef SDPMAP_CHUNK_SIZE
+/**
+ *	Amount of nodes in the first chunk of a map, every following chunk is
+ *	twice as large as the previous one. Has to be a power of two.
+ */
+#define SDPMAP_CHUNK_SIZE 64
+#endif
+
+#ifndef sdpmap_malloc
+#ifndef sdd_malloc
+#include <stdlib.h>
+/**
+ *	A user-defineable macro that should have the same prototype and
+ *	functionality as `malloc`, defaults to `malloc` or `sdd_malloc` if
+ *	defined.
+ */
+#define sdpmap_malloc malloc
+#else
+#define sdpmap_malloc sdd_malloc
+#endif
+#endif
+
+#ifndef sdpmap_realloc
+#ifndef sdd_realloc
+#include <stdlib.h>
+/**
+ *	A user-defineable macro that should have the same prototype and
+ *	functionality as `realloc`, defaults to `realloc` or `sdd_realloc` if
+ *	defined.
+ */
+#define sdpmap_realloc realloc
+#else
+#define sdpmap_realloc sdd_realloc
+#endif
+#endif
+
+#ifndef sdpmap_free
+#ifndef sdd_free
+#include <stdlib.h>
+/**
+ *	A user-defineable macro that should have the same prototype and
+ *	functionality as `free`, defaults to `free` or `sdd_free` if defined.
+ */
+#define sdpmap_free free
+#else
+#define sdpmap_free sdd_free
+#endif
+#endif
+
+#ifndef sdpmap_assert
+#ifndef sdd_assert
+#include <assert.h>
+/**
+ *	A user-defineable macro that should have the same prototype and
+ *	functionality as `assert`, defaults to `assert` or `sdd_assert` if defined.
+ */
+#define sdpmap_assert assert
+#else
+#define sdpmap_assert sdd_assert
+#endif
+#endif
+
+/**
+ *	@hideinitializer
+ *	@brief		Persistent simple dynamic map type generator
+ *
+ *	@details	The map is owned by one writer. Every update copies the nodes
+ *				on the path to the changed key unless they were created after
+ *				the last snapshot, so a snapshot keeps seeing the map exactly
+ *				as it was when it was taken.
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to sdpmap object that satisfies the input parameters
+ */
+#define sdpmap(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			detail_sdpmap_map_type kind;\
+			struct {\
+				sdpmap_node node;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Snapshot type generator for persistent maps
+ *
+ *	@param[in]	key_type		Type of the key in the map.
+ *	@param[in]	value_type		Type of the value in the map.
+ *
+ *	@return		Type to a snapshot of a sdpmap object that satisfies the
+ *				input parameters
+ */
+#define sdpmap_snapshot(key_type, value_type)\
+	struct {\
+		struct {\
+			key_type key;\
+			value_type value;\
+			detail_sdpmap_snapshot_type kind;\
+			struct {\
+				sdpmap_node node;\
+				key_type key;\
+				value_type value;\
+			} slot;\
+		} *type_data;\
+	} *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of elements in the map.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	map		Map or snapshot to retrieve the count from.
+ *
+ *	@return		Amount of elements in map `(sdmap_index)`.
+ */
+#define sdpmap_count(map) detail_sdpmap_count_impl(\
+	detail_sdpmap_m2h(map),\
+	detail_sdpmap_m2v(map))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to a value associated with a key, if key
+ *				doesn't exist returns NULL.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				The value must not be written to through the pointer, use
+ *				@ref sdpmap_get for that.
+ *
+ *	@param[in]	map			Map or snapshot to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Pointer to object associated with `key_expr`, NULL if key
+ *				isn't found
+ */
+#define sdpmap_getp(map, key_expr) ((const sdmap_typeof(map[0].type_data->value) *)\
+	detail_sdpmap_getp_impl(\
+		detail_sdpmap_m2h(map),\
+		detail_sdpmap_m2v(map),\
+		sizeof(map[0].type_data->slot),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if a key exists in the map.
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map			Map or snapshot to perform the test on
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		Does the element exist in the map `(int)`.
+ */
+#define sdpmap_contains(map, key_expr)\
+	(sdpmap_getp(map, key_expr) != NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve an lvalue associated with a key, if it doesn't exist
+ *				then it is inserted.
+ *
+ *	@details	Average time complexity - `O(log(count))`\n
+ *				Nodes on the path to the key that are still visible to a
+ *				snapshot are copied first, the lvalue is only valid until the
+ *				next update or snapshot of the map.
+ *
+ *	@param[in]	map			Map to look in
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ *	@return		lvalue object associated with `key_expr`
+ */
+#define sdpmap_get(map, key_expr) (*((sdmap_typeof(map[0].type_data->value) *)\
+	detail_sdpmap_set_impl(\
+		detail_sdpmap_ensure_initialized(map),\
+		sizeof(map[0].type_data->slot),\
+		sizeof(map[0].type_data->key),\
+		offsetof(sdmap_typeof(map[0].type_data->slot), value),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))))
+
+/**
+ *	@hideinitializer
+ *	@brief		Set a value to a key. If the key already exists in the map,
+ *				then it is overwritten.
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *	@param[in]	value_expr	Value to set
+ *
+ */
+#define sdpmap_set(map, key_expr, value_expr)\
+	sdpmap_get(map, key_expr) = value_expr
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase a key from the map.
+ *
+ *	@details	Average time complexity - `O(log(count))`
+ *
+ *	@param[in]	map			Map to modify
+ *	@param[in]	key_expr	Either a key or a pointer to a key
+ *
+ */
+#define sdpmap_erase(map, key_expr)\
+	detail_sdpmap_erase_impl(\
+		detail_sdpmap_m2h(map),\
+		sizeof(map[0].type_data->slot),\
+		detail_sdmap_keyexpr_to_pointer(map, key_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Take a snapshot of the current contents of the map.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Snapshots have to be taken by the writer, after that they can
+ *				be passed to and read from any thread without locks while the
+ *				writer keeps updating the map. Every snapshot has to be
+ *				released with @ref sdpmap_release before the map is deleted.
+ *				Nodes that no snapshot can reach anymore are reused by the
+ *				writer, see @ref sdpmap_reclaim.
+ *
+ *	@param[out]	snapshot	Snapshot to initialize
+ *	@param[in]	map			Map to take a snapshot of
+ *
+ */
+#define sdpmap_snap(snapshot, map)\
+	(snapshot = (void *)detail_sdpmap_snapshot_impl(\
+		detail_sdpmap_ensure_initialized(map),\
+		sizeof(map[0].type_data->slot)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Release a snapshot.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Can be called from any thread.
+ *
+ *	@param[in]	snapshot	Snapshot to release, set to NULL afterwards
+ *
+ */
+#define sdpmap_release(snapshot)\
+	detail_sdpmap_release_impl((struct sdpmap_version **)((void *)(&snapshot)))
+
+/**
+ *	@hideinitializer
+ *	@brief		Reuse the nodes that no snapshot can reach anymore.
+ *
+ *	@details	Average time complexity - `O(released nodes)`\n
+ *				Called by the writer, also happens automatically whenever a
+ *				snapshot is taken. Versions are reclaimed oldest first, so a
+ *				snapshot that is held for a long time also keeps the nodes
+ *				replaced after it alive.
+ *
+ *	@param[in]	map		Map to reclaim nodes of
+ *
+ */
+#define sdpmap_reclaim(map)\
+	detail_sdpmap_reclaim_impl(detail_sdpmap_m2h(map), sizeof(map[0].type_data->slot))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a map.
+ *
+ *	@details	Average time complexity - `O(chunks)`\n
+ *				Every snapshot has to be released beforehand.
+ *
+ *	@param[in]	map		Map object to free
+ *
+ */
+#define sdpmap_delete(map)\
+	detail_sdpmap_delete_impl((sdpmap_header **)((void *)(&map)))
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+/**
+ *	@brief		Persistent sdmap node object.
+ */
+typedef struct sdpmap_node
+{
+	/**
+	 *	Left child, -1 if there is none.
+	 */
+	sdmap_index left;
+
+	/**
+	 *	Right child, -1 if there is none.
+	 */
+	sdmap_index right;
+
+	/**
+	 *	Version the node was created in.
+	 */
+	uint32_t version;
+
+	/**
+	 *	Height of the subtree, 0 for leaves.
+	 */
+	int8_t height;
+} sdpmap_node;
+
+/**
+ *	@brief		Persistent sdmap header object.
+ */
+typedef struct sdpmap_header
+{
+	/**
+	 *	How many elements exist in the current version.
+	 */
+	sdmap_index count;
+
+	/**
+	 *	Root of the current version.
+	 */
+	sdmap_index root;
+
+	/**
+	 *	Amount of nodes handed out from the chunks so far.
+	 */
+	sdmap_index node_count;
+
+	/**
+	 *	First node of the list of free nodes, linked through left.
+	 */
+	sdmap_index free_node;
+
+	/**
+	 *	Number of the version being written to.
+	 */
+	uint32_t version;
+
+	/**
+	 *	Has the version being written to changed since the last snapshot.
+	 */
+	int dirty;
+
+	/**
+	 *	Oldest version that is still kept around.
+	 */
+	struct sdpmap_version *oldest;
+
+	/**
+	 *	Newest version a snapshot was taken of.
+	 */
+	struct sdpmap_version *newest;
+
+	/**
+	 *	Compare function.
+	 */
+	int (*compare_func)(const void *, const void *);
+
+	/**
+	 *	Node chunks, they are never moved once allocated.
+	 */
+	char *chunks[32];
+} sdpmap_header;
+
+#define detail_sdpmap_map_type char
+
+#define detail_sdpmap_snapshot_type short
+
+#define detail_sdpmap_m2h(map) _Generic(map[0].type_data->kind,\
+	detail_sdpmap_map_type : (sdpmap_header *)((void *)map),\
+	detail_sdpmap_snapshot_type : (sdpmap_header *)NULL)
+
+#define detail_sdpmap_m2v(map) _Generic(map[0].type_data->kind,\
+	detail_sdpmap_map_type : (struct sdpmap_version *)NULL,\
+	detail_sdpmap_snapshot_type : (struct sdpmap_version *)((void *)map))
+
+#define detail_sdpmap_ensure_initialized(map)\
+	detail_sdpmap_ensure_initialized_impl(\
+		(sdpmap_header **)((void *)(&map)),\
+		detail_sdmap_pick_compare_func(map[0].type_data->key))
+
+#ifndef SDPMAP_API
+#define SDPMAP_API
+#endif
+
+SDPMAP_API sdpmap_header *detail_sdpmap_ensure_initialized_impl(
+	sdpmap_header **header,
+	int (*compare_func)(const void *, const void *));
+
+SDPMAP_API sdmap_index detail_sdpmap_count_impl(
+	sdpmap_header *header,
+	struct sdpmap_version *version);
+
+SDPMAP_API void *detail_sdpmap_getp_impl(
+	sdpmap_header *header,
+	struct sdpmap_version *version,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	const void *key);
+
+SDPMAP_API void *detail_sdpmap_set_impl(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_offset,
+	const void *key);
+
+SDPMAP_API void detail_sdpmap_erase_impl(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	const void *key);
+
+SDPMAP_API struct sdpmap_version *detail_sdpmap_snapshot_impl(
+	sdpmap_header *header,
+	uint32_t slot_size);
+
+SDPMAP_API void detail_sdpmap_release_impl(struct sdpmap_version **version);
+
+SDPMAP_API void detail_sdpmap_reclaim_impl(
+	sdpmap_header *header,
+	uint32_t slot_size);
+
+SDPMAP_API void detail_sdpmap_delete_impl(sdpmap_header **header);
+
+/**
+ *	@endcond
+ */
+
+#endif
@@ -0,0 +1,245 @@
+/**
+ * @file sdrope.h	Simple dynamic rope object for C, a string that is cheap
+ *					to edit anywhere.
+ * @date			18. Oct 2026
+ * @author			Mihkel Aaremäe
+ */
+#ifndef SDROPE_H
+#define SDROPE_H
+
+#include <sdstr.h>
+
+#ifndef SDROPE_CHUNK_SIZE
+/**
+ *	Maximum amount of bytes in one chunk of a rope. Edits move at most this
+ *	many bytes around.
+ */
+#define SDROPE_CHUNK_SIZE 1024
+#endif
+
+/**
+ *	@hideinitializer
+ *	@brief		Rope type. NULL is a valid empty rope.
+ *
+ *	@details	Bytes are kept in chunks of up to @ref SDROPE_CHUNK_SIZE
+ *				bytes in a balanced tree, so inserting and erasing anywhere
+ *				takes `O(log size)` instead of moving everything after the
+ *				position like a @ref sdstr does. Positions are byte indexes.
+ */
+#define sdrope sdrope_node *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of bytes in the rope.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	rope	Rope to retrieve the size from.
+ *
+ *	@return		Amount of bytes in rope `(sdstr_index)`.
+ */
+#define sdrope_size(rope) detail_sdrope_size_impl(rope)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a byte.
+ *
+ *	@details	Average time complexity - `O(log size)`
+ *
+ *	@param[in]	rope	Rope to look in
+ *	@param[in]	index	Index of the byte
+ *
+ *	@return		The byte, 0 past the end `(char)`.
+ */
+#define sdrope_get(rope, index) detail_sdrope_get_impl(rope, index)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the bytes that are stored one after another
+ *				starting from an index.
+ *
+ *	@details	Average time complexity - `O(log size)`\n
+ *				Walking a rope chunk by chunk is the fastest way to read
+ *				it. The pointer is valid until the rope is modified.
+ *
+ *	@param[in]	rope		Rope to look in
+ *	@param[in]	index		Index of the first byte
+ *	@param[out]	size_ptr	Pointer to a `sdstr_index` that receives the
+ *							amount of bytes, 0 past the end
+ *
+ *	@return		Pointer to the bytes, NULL past the end `(const char *)`.
+ */
+#define sdrope_chunk(rope, index, size_ptr) detail_sdrope_chunk_impl(rope, index, size_ptr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Copy bytes into a buffer.
+ *
+ *	@details	Average time complexity - `O(log size + count)`
+ *
+ *	@param[in]	rope		Rope to copy from
+ *	@param[in]	index		Index of the first byte
+ *	@param[in]	count		Maximum amount of bytes to copy
+ *	@param[out]	buffer		Buffer to copy into, it isn't terminated
+ *
+ *	@return		Amount of copied bytes `(sdstr_index)`.
+ */
+#define sdrope_copy(rope, index, count, buffer) detail_sdrope_copy_impl(rope, index, count, buffer)
+
+/**
+ *	@hideinitializer
+ *	@brief		Construct a new rope from a str.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				If rope contains a previously used rope then it should be
+ *				freed with @ref sdrope_delete.
+ *
+ *	@param[in]	rope		Rope to initialize
+ *	@param[in]	str			Str of any type to copy the bytes of
+ */
+#define sdrope_from_str(rope, str) detail_sdrope_new_impl(\
+	&(rope),\
+	sdstr_data(str),\
+	sdstr_size(str))
+
+/**
+ *	@hideinitializer
+ *	@brief		Replace the contents of a str with the bytes of a rope.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	rope		Rope to copy
+ *	@param[in]	str			Str of any type to overwrite, it is
+ *							constructed like with @ref sdstr_new
+ */
+#define sdrope_to_str(rope, str) detail_sdrope_to_str_impl(\
+	rope,\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str))
+
+/**
+ *	@hideinitializer
+ *	@brief		Replace bytes with a C string or a character.
+ *
+ *	@details	Average time complexity - `O(log size + value size)`
+ *
+ *	@param[in]	rope		Rope to modify
+ *	@param[in]	index		Index of the first byte to replace
+ *	@param[in]	count		Amount of bytes to replace
+ *	@param[in]	value_expr	C string or a character to put in their place
+ */
+#define sdrope_splice(rope, index, count, value_expr) detail_sdrope_splice_impl(\
+	&(rope),\
+	index,\
+	count,\
+	detail_sdstr_value((sdstr)NULL, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert a C string or a character in front of an index.
+ *
+ *	@details	Average time complexity - `O(log size + value size)`
+ *
+ *	@param[in]	rope		Rope to modify
+ *	@param[in]	index		Index to insert at
+ *	@param[in]	value_expr	C string or a character to insert
+ */
+#define sdrope_insert(rope, index, value_expr) sdrope_splice(rope, index, 0, value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Append a C string or a character.
+ *
+ *	@details	Average time complexity - `O(log size + value size)`
+ *
+ *	@param[in]	rope		Rope to modify
+ *	@param[in]	value_expr	C string or a character to append
+ */
+#define sdrope_push(rope, value_expr) sdrope_splice(rope, sdrope_size(rope), 0, value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase bytes.
+ *
+ *	@details	Average time complexity - `O(log size)` plus `O(1)` for
+ *				every erased chunk
+ *
+ *	@param[in]	rope		Rope to modify
+ *	@param[in]	index		Index of the first byte to erase
+ *	@param[in]	count		Amount of bytes to erase
+ */
+#define sdrope_erase(rope, index, count) sdrope_splice(rope, index, count, "")
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a rope.
+ *
+ *	@details	Average time complexity - `O(chunks)`\n
+ *				Leaves an empty rope behind.
+ *
+ *	@param[in]	rope		Rope to free
+ */
+#define sdrope_delete(rope) detail_sdrope_delete_impl(&(rope))
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+/**
+ *	@brief	Chunk of a rope and the root of the chunks around it.
+ */
+typedef struct sdrope_node
+{
+	struct sdrope_node *left;
+	struct sdrope_node *right;
+
+	/**
+	 * Bytes in this chunk and the ones below it.
+	 */
+	sdstr_index weight;
+
+	/**
+	 * Bytes in this chunk.
+	 */
+	sdstr_index size;
+
+	/**
+	 * Nodes are above the ones with a lower priority.
+	 */
+	uint32_t priority;
+	char bytes[];
+} sdrope_node;
+
+SDSTR_API sdstr_index detail_sdrope_size_impl(sdrope_node *rope);
+
+SDSTR_API char detail_sdrope_get_impl(sdrope_node *rope, sdstr_index index);
+
+SDSTR_API const char *detail_sdrope_chunk_impl(
+	sdrope_node *rope,
+	sdstr_index index,
+	sdstr_index *size);
+
+SDSTR_API sdstr_index detail_sdrope_copy_impl(
+	sdrope_node *rope,
+	sdstr_index index,
+	sdstr_index count,
+	char *buffer);
+
+SDSTR_API void detail_sdrope_new_impl(sdrope_node **rope, const char *data, sdstr_index size);
+
+SDSTR_API void detail_sdrope_to_str_impl(sdrope_node *rope, void *str, sdstr_index kind);
+
+SDSTR_API void detail_sdrope_splice_impl(
+	sdrope_node **rope,
+	sdstr_index index,
+	sdstr_index count,
+	detail_sdstr_bytes value);
+
+SDSTR_API void detail_sdrope_delete_impl(sdrope_node **rope);
+
+/**
+ *	@endcond
+ */
+
+#endif
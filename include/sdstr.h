@@ -33,6 +33,24 @@
 #define SDSTR_ENABLE_AUTOSHRINK 1
 #endif
 
+#ifndef SDSTR_SMALL_CAPACITY
+/**
+ *	Amount of bytes a @ref sdstr_small keeps inside of itself before moving
+ *	them to the heap. The object is 2 bytes larger than this.
+ */
+#define SDSTR_SMALL_CAPACITY 22
+#endif
+
+#ifndef SDSTR_UTF8_INDEX_STRIDE
+/**
+ *	Every how many code points a @ref sdstr_utf8 remembers the byte offset
+ *	of once it is indexed past the first stride. The offsets are found on
+ *	demand and kept until an edit before them changes the amount of code
+ *	points.
+ */
+#define SDSTR_UTF8_INDEX_STRIDE 64
+#endif
+
 #ifndef sdstr_malloc
 #ifndef sdd_malloc
 #include <stdlib.h>
@@ -94,198 +112,830 @@
 #define sdstr_index uint32_t
 #endif
 
+#ifndef sdstr_typeof
+/**
+ *	A user-defineable macro that should have the same prototype and
+ *	functionality as `__typeof__`
+ */
+#define sdstr_typeof __typeof__
+#endif
+
+/**
+ *	@hideinitializer
+ *	@brief		Heap-type string of bytes. NULL is a valid empty string.
+ *
+ *	@details	Points to its first byte, the bytes are always followed by a
+ *				`'\0'` so a non-NULL str can be passed to C string functions.
+ */
 #define sdstr char *
 
+/**
+ *	@hideinitializer
+ *	@brief		Heap-type UTF-8 string. NULL is a valid empty string.
+ *
+ *	@details	Same as @ref sdstr, but positions, counts and characters
+ *				are in code points instead of bytes. Everything put into it
+ *				is validated, invalid UTF-8 trips @ref sdstr_assert.
+ *				Code point indices are resolved through offsets remembered
+ *				every @ref SDSTR_UTF8_INDEX_STRIDE code points, so random
+ *				access is `O(1)` amortized.
+ */
 #define sdstr_utf8 void *
 
-#define sdstr_stack(byte_count) char[\
-	(sizeof(sdstr_header) + byte_count) > sizeof(void *) ?\
-		(sizeof(sdstr_header) + byte_count) :\
-		(sizeof(void *) + 1)]
+/**
+ *	@hideinitializer
+ *	@brief		Stack-type string type generator.
+ *
+ *	@details	Has to be initialized with @ref sdstr_new and can't grow
+ *				past byte_count bytes.
+ *
+ *	@param[in]	byte_count	Maximum amount of bytes in the str.
+ */
+#define sdstr_stack(byte_count) sdstr_typeof(char[\
+	(sizeof(sdstr_header) + (byte_count) + 1) > sizeof(void *) ?\
+		(sizeof(sdstr_header) + (byte_count) + 1) :\
+		(sizeof(void *) + 1)])
+
+/**
+ *	@brief		String that keeps up to @ref SDSTR_SMALL_CAPACITY bytes
+ *				inside of itself and moves them to the heap when they don't
+ *				fit.
+ *
+ *	@details	A zero-initialized object is a valid empty string, otherwise
+ *				it has to be initialized with @ref sdstr_new. Has to be
+ *				freed with @ref sdstr_delete.
+ */
+typedef struct sdstr_small
+{
+	/**
+	 *	The bytes followed by a `'\0'` and the size in the last byte, or a
+	 *	pointer to a heap-type str and 0xFF in the last byte.
+	 */
+	char bytes[SDSTR_SMALL_CAPACITY + 2];
+} sdstr_small;
+
+/**
+ *	@brief		Read-only range of bytes that belong to something else.
+ *
+ *	@details	Views are taken with @ref sdstr_view_of and
+ *				@ref sdstr_view_substr without copying anything and stay
+ *				valid as long as the bytes do. Every operation that only
+ *				reads a str accepts a view in its place, positions and
+ *				counts in a view are in bytes and its bytes aren't followed
+ *				by a `'\0'`. Views are also accepted everywhere a C string
+ *				is. A zero-initialized view is empty.
+ */
+typedef struct sdstr_view
+{
+	const char *data;
+	sdstr_index size;
+} sdstr_view;
+
+/**
+ *	@brief		Iterator over the fields of a str that are separated by
+ *				delimiter bytes, see @ref sdstr_split_iter.
+ */
+typedef struct sdstr_split
+{
+	/**
+	 *	Bytes that are split and the offset of the next field in them.
+	 */
+	const char *data;
+	sdstr_index size;
+	sdstr_index offset;
+
+	/**
+	 *	Delimiters found in the 64 bytes starting from block, bit i is set
+	 *	for a delimiter at block + i. Bits of the fields that were already
+	 *	returned are cleared.
+	 */
+	uint64_t mask;
+	sdstr_index block;
+	int done;
+
+	/**
+	 *	Bit h of table[b >> 7][b & 15] is set when byte b with (b >> 4) & 7
+	 *	equal to h is a delimiter.
+	 */
+	unsigned char table[2][16];
+	char delims[16];
+	unsigned char delim_count;
+} sdstr_split;
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of bytes in the str.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to retrieve the size from.
+ *
+ *	@return		Amount of bytes in str `(sdstr_index)`.
+ */
+#define sdstr_size(str) detail_sdstr_size_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str))
 
-#define sdstr_size(str) detail_sdstr_size_impl(detail_sdstr_s2h(str))
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of characters in the str, which is the
+ *				amount of code points for @ref sdstr_utf8.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				The count of a @ref sdstr_utf8 is kept up to date by every
+ *				modification, which only counts the bytes it changes.
+ *
+ *	@param[in]	str		Str to retrieve the count from.
+ *
+ *	@return		Amount of characters in str `(sdstr_index)`.
+ */
+#define sdstr_count(str) detail_sdstr_count_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str))
 
-#define sdstr_count(str) detail_sdstr_switch_type(str,\
-	sdstr_size(str),\
-	detail_sdstr_count_utf8_impl(detail_sdstr_s2h(str)),\
-	sdstr_size(str))
+/**
+ *	@hideinitializer
+ *	@brief		Test if a C string is valid UTF-8.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				Bytes put into a @ref sdstr_utf8 have to be valid UTF-8, this
+ *				can be used to check untrusted input first. Uses the same
+ *				validation as the strs, vectorized when the compiler targets
+ *				AVX2.
+ *
+ *	@param[in]	value_expr	C string to test
+ *
+ *	@return		Is it valid UTF-8 `(int)`.
+ */
+#define sdstr_utf8_valid(value_expr) detail_sdstr_utf8_valid_impl(\
+	detail_sdstr_value((void *)NULL, value_expr))
 
-#define sdstr_capacity(str) detail_sdstr_switch_type(str,\
-	detail_sdstr_capacity_impl(detail_sdstr_s2heap(str)),\
-	detail_sdstr_capacity_impl(detail_sdstr_s2heap(str)),\
-	(sizeof(str) - sizoef(sdstr_header)))
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of bytes the str can hold without
+ *				reallocating.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to retrieve the capacity from.
+ *
+ *	@return		Capacity of str in bytes `(sdstr_index)`.
+ */
+#define sdstr_capacity(str) detail_sdstr_capacity_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str))
 
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the bytes of the str as a C string.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Empty heap-type strs return a read-only `""`.
+ *
+ *	@param[in]	str		Str to retrieve the bytes of.
+ *
+ *	@return		Pointer to the first byte `(char *)`.
+ */
+#define sdstr_data(str) detail_sdstr_data_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str))
+
+/**
+ *	@hideinitializer
+ *	@brief		Test if the str contains a substring.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str			Str to look in
+ *	@param[in]	value_expr	C string or a character to look for
+ *
+ *	@return		Was the substring found `(int)`.
+ */
 #define sdstr_contains(str, value_expr) detail_sdstr_contains_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_cstr(value_expr))
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_value(str, value_expr))
 
+/**
+ *	@hideinitializer
+ *	@brief		Find the first occurrence of a substring.
+ *
+ *	@details	Average time complexity - `O(size)`, also in the worst case\n
+ *				Candidates are filtered with SSE2 or AVX2 when the compiler
+ *				targets them.
+ *
+ *	@param[in]	str			Str to look in
+ *	@param[in]	start		(OPTIONAL) position to start looking from
+ *	@param[in]	value_expr	C string or a character to look for
+ *
+ *	@return		Pointer to the first match `(char *)`, NULL if not found
+ */
 #define sdstr_find(str, ...) detail_sdstr_getter_upto_2(__VA_ARGS__,\
 	detail_sdstr_find3, detail_sdstr_find2, dummy)(str, __VA_ARGS__)
 
+/**
+ *	@hideinitializer
+ *	@brief		Find the last occurrence of a substring.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_find
+ *
+ *	@param[in]	str			Str to look in
+ *	@param[in]	start		(OPTIONAL) only matches that start before this
+ *							position are considered
+ *	@param[in]	value_expr	C string or a character to look for
+ *
+ *	@return		Pointer to the last match `(char *)`, NULL if not found
+ */
 #define sdstr_find_back(str, ...) detail_sdstr_getter_upto_2(__VA_ARGS__,\
 	detail_sdstr_find_back3, detail_sdstr_find_back2, dummy)(str, __VA_ARGS__)
 
-#define sdstr_reserve(str, byte_count) detail_sdstr_switch_type(str,\
-	detail_sdstr_heap_reserve_impl(detail_sdstr_s2heap(str), byte_count),\
-	detail_sdstr_heap_reserve_impl(detail_sdstr_s2heap(str), byte_count),\
-	detail_sdstr_dummy_impl())
+/**
+ *	@hideinitializer
+ *	@brief		Compare the bytes of the str to a C string.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				Bytes are compared like with `memcmp`, a prefix is before
+ *				the strings that it starts.
+ *
+ *	@param[in]	str			Str to compare
+ *	@param[in]	value_expr	C string or a character to compare to
+ *
+ *	@return		Negative if str is before value, 0 if they are equal and
+ *				positive otherwise `(int)`.
+ */
+#define sdstr_compare(str, value_expr) detail_sdstr_compare_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_value(str, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Make sure the str can hold byte_count bytes without
+ *				reallocating.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_realloc
+ *
+ *	@param[in]	str			Str to reserve in
+ *	@param[in]	byte_count	Amount of bytes to reserve
+ */
+#define sdstr_reserve(str, byte_count) detail_sdstr_reserve_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	byte_count)
 
+/**
+ *	@hideinitializer
+ *	@brief		Construct a new str.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				If str contains a previously used str then it should be freed
+ *				with @ref sdstr_delete.
+ *
+ *	@param[in]	str			Str to initialize
+ *	@param[in]	value_expr	(OPTIONAL) C string or a character to initialize
+ *							the str with
+ *	@param[in]	byte_count	(OPTIONAL) amount of bytes to reserve
+ */
 #define sdstr_new(...) detail_sdstr_getter_upto_3(\
 	__VA_ARGS__, detail_sdstr_new3, detail_sdstr_new2, detail_sdstr_new1,\
 	dummy)(__VA_ARGS__)
 
-#define sdstr_dup(str, source) detail_sdstr_switch_type(str,\
-	detail_sdstr_dup_to_normal_impl(\
-		&str,\
-		source,\
-		detail_sdstr_s2h(source)),\
-	detail_sdstr_dup_to_utf8_impl(\
-		&str,\
-		source,\
-		detail_sdstr_s2h(source)),\
-	detail_sdstr_dup_to_stack_impl(\
-		str,\
-		sdstr_capacity(str),\
-		source,\
-		detail_sdstr_s2h(source)))
-
-#define sdstr_substr(str, source, ptr, count) detail_sdstr_switch_type(str,\
-	detail_sdstr_substr_normal_impl(\
-		&str,\
-		ptr,\
-		source,\
-		detail_sdstr_s2h(source),\
-		count),\
-	detail_sdstr_substr_utf8_impl(\
-		&str,\
-		ptr,\
-		source,\
-		detail_sdstr_s2h(str),\
-		count),\
-	detail_sdstr_substr_stack_impl(\
-		str,\
-		sdstr_capacity(str),\
-		ptr,\
-		source,\
-		detail_sdstr_s2h(source),\
-		count))
+/**
+ *	@hideinitializer
+ *	@brief		Duplicate an existing str.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				If str contains a previously used str then it should be freed
+ *				with @ref sdstr_delete.
+ *
+ *	@param		str		Destination str
+ *	@param		source	Source str of any type
+ */
+#define sdstr_dup(str, source) detail_sdstr_dup_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_ref(source),\
+	detail_sdstr_read_kind(source))
 
+/**
+ *	@hideinitializer
+ *	@brief		Construct a str from a part of another one.
+ *
+ *	@details	Average time complexity - `O(count)`\n
+ *				If str contains a previously used str then it should be freed
+ *				with @ref sdstr_delete. @ref sdstr_view_substr takes the
+ *				same part without copying it.
+ *
+ *	@param		str		Destination str
+ *	@param		source	Source str of any type
+ *	@param		pos		Position in source to start from
+ *	@param		count	Amount of characters to take
+ */
+#define sdstr_substr(str, source, pos, count) detail_sdstr_substr_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_ref(source),\
+	detail_sdstr_read_kind(source),\
+	detail_sdstr_pos(source, pos),\
+	count)
+
+/**
+ *	@hideinitializer
+ *	@brief		View all of the bytes of a str.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				The view is invalidated by any modification of str.
+ *
+ *	@param[in]	str		Str of any type to view
+ *
+ *	@return		View of the bytes `(sdstr_view)`.
+ */
+#define sdstr_view_of(str) detail_sdstr_view_substr_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_pos(str, 0),\
+	(sdstr_index)-1)
+
+/**
+ *	@hideinitializer
+ *	@brief		View a part of a str without copying it.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_substr without
+ *				the copy\n
+ *				The view is invalidated by any modification of str.
+ *
+ *	@param		str		Str of any type to view
+ *	@param		pos		Position in str to start from
+ *	@param		count	Amount of characters to take
+ *
+ *	@return		View of the bytes `(sdstr_view)`.
+ */
+#define sdstr_view_substr(str, pos, count) detail_sdstr_view_substr_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_pos(str, pos),\
+	count)
+
+/**
+ *	@hideinitializer
+ *	@brief		Start splitting a str at any of a set of delimiter bytes.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				The fields are returned by @ref sdstr_split_next. Every
+ *				delimiter ends a field, so n delimiters give n + 1 fields,
+ *				some of which may be empty. The iterator is invalidated by
+ *				any modification of str.
+ *
+ *	@param[in]	str			Str of any type to split
+ *	@param[in]	delims_expr	C string of up to 16 delimiter bytes or a
+ *							character, only ASCII ones for @ref sdstr_utf8
+ *
+ *	@return		Iterator before the first field `(sdstr_split)`.
+ */
+#define sdstr_split_iter(str, delims_expr) detail_sdstr_split_iter_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_value(str, delims_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the next field of a split str.
+ *
+ *	@details	Average time complexity - `O(field size)`\n
+ *				Delimiters are looked for 64 bytes at a time, with a byte
+ *				lookup in SSSE3 or AVX2 registers when the compiler targets
+ *				them, so fields can be returned without looking at bytes
+ *				again.
+ *
+ *	@param[in]	split	Iterator from @ref sdstr_split_iter
+ *	@param[out]	view	@ref sdstr_view that receives the field
+ *
+ *	@return		Was there a field left `(int)`.
+ */
+#define sdstr_split_next(split, view) detail_sdstr_split_next_impl(&(split), &(view))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a character.
+ *
+ *	@details	Average time complexity - `O(1)`, amortized
+ *				`O(SDSTR_UTF8_INDEX_STRIDE)` for @ref sdstr_utf8 indexes
+ *
+ *	@param[in]	str		Str to look in
+ *	@param[in]	pos		Index or pointer of the character
+ *
+ *	@return		The byte or code point at pos, 0 at the end `(uint32_t)`.
+ */
 #define sdstr_get(str, pos) detail_sdstr_get_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos))
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_pos(str, pos))
 
+/**
+ *	@hideinitializer
+ *	@brief		Overwrite a character.
+ *
+ *	@details	Average time complexity - `O(1)`, `O(size)` for
+ *				@ref sdstr_utf8 when the code point changes length
+ *
+ *	@param[in]	str		Str to modify
+ *	@param[in]	pos		Index or pointer of the character
+ *	@param[in]	value	Byte or code point to set
+ */
 #define sdstr_set(str, pos, value) detail_sdstr_set_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
 	value)
 
-#define sdstr_getp(str, pos) detail_sdstr_getp_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos))
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to a character.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_get
+ *
+ *	@param[in]	str		Str to look in
+ *	@param[in]	pos		Index of the character
+ *
+ *	@return		Pointer to the character `(char *)`, NULL for the end.
+ */
+#define sdstr_getp(str, pos) detail_sdstr_pos(str, pos)
 
+/**
+ *	@hideinitializer
+ *	@brief		Step to the next character.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to step in
+ *	@param[in]	pos		Pointer to a character
+ *
+ *	@return		Pointer to the next character `(char *)`, NULL for the end.
+ */
 #define sdstr_next(str, pos) detail_sdstr_next_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos))
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	pos)
 
+/**
+ *	@hideinitializer
+ *	@brief		Step to the previous character.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to step in
+ *	@param[in]	pos		Pointer to a character, NULL for the end
+ *
+ *	@return		Pointer to the previous character `(char *)`, NULL if pos
+ *				was the first one.
+ */
 #define sdstr_prev(str, pos) detail_sdstr_prev_impl(\
-	str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos))
-
-#define sdstr_last(str) detail_sdstr_last_impl(\
-	str,\
-	detail_sdstr_s2h(str))
-
-#define sdstr_insert(str, pos, value_expr) detail_sdstr_insert_impl(\
-	&str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
-	detail_sdstr_cstr(value_expr))
-
-#define sdstr_insertf(str, pos, format, ...) detail_sdstr_insertf_impl(\
-	&str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
-	format, __VA_ARGS__)
-
-#define sdstr_push(str, value_expr)\
-	sdstr_insert(&str, sdstr_last(str), value_expr)
-
-#define sdstr_pushf(str, format, ...)\
-	sdstr_insertf(&str, sdstr_last(str), value_expr, __VA_ARGS__)
-
-#define sdstr_erase(str, pos, count) detail_sdstr_erase_impl(\
-	&str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
-	count)
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	pos)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve a pointer to the last character.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to look in
+ *
+ *	@return		Pointer to the last character `(char *)`, NULL if empty.
+ */
+#define sdstr_last(str) sdstr_prev(str, NULL)
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert a C string or a character in front of a position.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				Positions are indexes or pointers, NULL is the end.
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	pos			Position to insert at
+ *	@param[in]	value_expr	C string or a character to insert
+ *
+ *	@return		Pointer to the inserted bytes `(char *)`.
+ */
+#define sdstr_insert(str, pos, value_expr) detail_sdstr_splice_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
+	0,\
+	detail_sdstr_value(str, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Insert a formatted string in front of a position.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	pos			Position to insert at
+ *	@param[in]	...			`printf` format and its arguments
+ *
+ *	@return		Pointer to the inserted bytes `(char *)`.
+ */
+#define sdstr_insertf(str, pos, ...) detail_sdstr_splicef_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
+	0,\
+	__VA_ARGS__)
 
+/**
+ *	@hideinitializer
+ *	@brief		Append a C string or a character.
+ *
+ *	@details	Average time complexity - amortized `O(value size)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	value_expr	C string or a character to append
+ *
+ *	@return		Pointer to the appended bytes `(char *)`.
+ */
+#define sdstr_push(str, value_expr) sdstr_insert(str, NULL, value_expr)
+
+/**
+ *	@hideinitializer
+ *	@brief		Append a formatted string.
+ *
+ *	@details	Average time complexity - amortized `O(value size)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	...			`printf` format and its arguments
+ *
+ *	@return		Pointer to the appended bytes `(char *)`.
+ */
+#define sdstr_pushf(str, ...) sdstr_insertf(str, NULL, __VA_ARGS__)
+
+/**
+ *	@hideinitializer
+ *	@brief		Append the decimal digits of a signed integer.
+ *
+ *	@details	Average time complexity - amortized `O(1)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	value		Integer to append
+ *
+ *	@return		Pointer to the appended bytes `(char *)`.
+ */
+#define sdstr_push_int(str, value) detail_sdstr_push_int_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	(int64_t)(value))
+
+/**
+ *	@hideinitializer
+ *	@brief		Append the decimal digits of an unsigned integer.
+ *
+ *	@details	Average time complexity - amortized `O(1)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	value		Integer to append
+ *
+ *	@return		Pointer to the appended bytes `(char *)`.
+ */
+#define sdstr_push_uint(str, value) detail_sdstr_push_uint_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	(uint64_t)(value))
+
+/**
+ *	@hideinitializer
+ *	@brief		Append the shortest decimal digits that read back as the
+ *				same double.
+ *
+ *	@details	Average time complexity - amortized `O(1)`\n
+ *				Magnitudes from 1e-6 up to 1e21 are in plain notation
+ *				(`1.5`, `0.000001`, `100`), others in scientific notation
+ *				(`1e+21`, `1.5e-7`). Infinities are `inf` and `-inf`, NaN
+ *				is `nan`. The current locale doesn't matter.
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	value		Double to append
+ *
+ *	@return		Pointer to the appended bytes `(char *)`.
+ */
+#define sdstr_push_double(str, value) detail_sdstr_push_double_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	(double)(value))
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase characters.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str		Str to modify
+ *	@param[in]	pos		Position of the first character to erase
+ *	@param[in]	count	Amount of characters to erase
+ *
+ *	@return		Pointer to the character after the erased ones `(char *)`,
+ *				NULL for the end.
+ */
+#define sdstr_erase(str, pos, count) detail_sdstr_splice_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
+	count,\
+	detail_sdstr_value(str, ""))
+
+/**
+ *	@hideinitializer
+ *	@brief		Erase the first occurrence of a substring.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to erase
+ *
+ *	@return		Pointer to where the substring was `(char *)`, NULL if not
+ *				found or it was at the end.
+ */
 #define sdstr_erase_first(str, search_expr) sdstr_replace_first(\
-	&str, search_expr, "")
+	str, search_expr, "")
 
+/**
+ *	@hideinitializer
+ *	@brief		Erase all occurrences of a substring.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_replace_all
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to erase
+ *
+ *	@return		Amount of erased occurrences `(sdstr_index)`.
+ */
 #define sdstr_erase_all(str, search_expr) sdstr_replace_all(\
-	&str, search_expr, "")
+	str, search_expr, "")
 
+/**
+ *	@hideinitializer
+ *	@brief		Erase the last character.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	str		Str to modify
+ *
+ *	@return		The erased byte or code point, 0 if empty `(uint32_t)`.
+ */
 #define sdstr_pop(str) detail_sdstr_pop_impl(\
-	&str,\
-	detail_sdstr_s2h(str))
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str))
 
+/**
+ *	@hideinitializer
+ *	@brief		Replace characters with a C string or a character.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	pos			Position of the first character to replace
+ *	@param[in]	count		Amount of characters to replace
+ *	@param[in]	value_expr	C string or a character to put in their place
+ *
+ *	@return		Pointer to the first inserted byte `(char *)`, NULL for the
+ *				end.
+ */
 #define sdstr_splice(str, pos, count, value_expr) detail_sdstr_splice_impl(\
-	&str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
 	count,\
-	detail_sdstr_cstr(value_expr))
+	detail_sdstr_value(str, value_expr))
 
-#define sdstr_splicef(str, pos, count, format, ...) detail_sdstr_splicef_impl(\
-	&str,\
-	detail_sdstr_s2h(str),\
-	detail_sdstr_pos2ptr(pos),\
+/**
+ *	@hideinitializer
+ *	@brief		Replace characters with a formatted string.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str			Str to modify
+ *	@param[in]	pos			Position of the first character to replace
+ *	@param[in]	count		Amount of characters to replace
+ *	@param[in]	...			`printf` format and its arguments
+ *
+ *	@return		Pointer to the first inserted byte `(char *)`, NULL for the
+ *				end.
+ */
+#define sdstr_splicef(str, pos, count, ...) detail_sdstr_splicef_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_pos(str, pos),\
 	count,\
-	format,\
 	__VA_ARGS__)
 
+/**
+ *	@hideinitializer
+ *	@brief		Replace the first occurrence of a substring.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to replace
+ *	@param[in]	value_expr		C string or a character to put in its place
+ *
+ *	@return		Pointer to the byte after the replacement `(char *)`, NULL if
+ *				not found or it is the end.
+ */
 #define sdstr_replace_first(str, search_expr, value_expr)\
 	detail_sdstr_replace_first_impl(\
-		&str,\
-		detail_sdstr_s2h(str),\
-		detail_sdstr_cstr(search_expr),\
-		detail_sdstr_cstr(value_expr))
+		detail_sdstr_ref(str),\
+		detail_sdstr_kind(str),\
+		detail_sdstr_value(str, search_expr),\
+		detail_sdstr_value(str, value_expr))
 
-#define sdstr_replacef_first(str, search_expr, format, ...)\
+/**
+ *	@hideinitializer
+ *	@brief		Replace the first occurrence of a substring with a formatted
+ *				string.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to replace
+ *	@param[in]	...				`printf` format and its arguments
+ *
+ *	@return		Pointer to the byte after the replacement `(char *)`, NULL if
+ *				not found or it is the end.
+ */
+#define sdstr_replacef_first(str, search_expr, ...)\
 	detail_sdstr_replacef_first_impl(\
-		&str,\
-		detail_sdstr_s2h(str),\
-		detail_sdstr_cstr(search_expr),\
-		detail_sdstr_cstr(format),\
+		detail_sdstr_ref(str),\
+		detail_sdstr_kind(str),\
+		detail_sdstr_value(str, search_expr),\
 		__VA_ARGS__)
 
+/**
+ *	@hideinitializer
+ *	@brief		Replace all occurrences of a substring.
+ *
+ *	@details	Average time complexity - `O(size)`\n
+ *				Occurrences don't overlap, they are found from the front.
+ *				The str is reallocated at most once.
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to replace
+ *	@param[in]	value_expr		C string or a character to put in their place
+ *
+ *	@return		Amount of replaced occurrences `(sdstr_index)`.
+ */
 #define sdstr_replace_all(str, search_expr, value_expr)\
 	detail_sdstr_replace_all_impl(\
-		&str,\
-		detail_sdstr_s2h(str),\
-		detail_sdstr_cstr(search_expr),\
-		detail_sdstr_cstr(value_expr))
+		detail_sdstr_ref(str),\
+		detail_sdstr_kind(str),\
+		detail_sdstr_value(str, search_expr),\
+		detail_sdstr_value(str, value_expr))
 
-#define sdstr_replacef_all(str, search_expr, format, ...)\
+/**
+ *	@hideinitializer
+ *	@brief		Replace all occurrences of a substring with a formatted
+ *				string.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_replace_all
+ *
+ *	@param[in]	str				Str to modify
+ *	@param[in]	search_expr		C string or a character to replace
+ *	@param[in]	...				`printf` format and its arguments
+ *
+ *	@return		Amount of replaced occurrences `(sdstr_index)`.
+ */
+#define sdstr_replacef_all(str, search_expr, ...)\
 	detail_sdstr_replacef_all_impl(\
-		&str,\
-		detail_sdstr_s2h(str),\
-		detail_sdstr_cstr(search_expr),\
-		detail_sdstr_cstr(format),\
+		detail_sdstr_ref(str),\
+		detail_sdstr_kind(str),\
+		detail_sdstr_value(str, search_expr),\
 		__VA_ARGS__)
 
-#define sdstr_reverse(str) detail_sdstr_reverse_impl(&str, )
+/**
+ *	@hideinitializer
+ *	@brief		Reverse the order of the characters.
+ *
+ *	@details	Average time complexity - `O(size)`
+ *
+ *	@param[in]	str		Str to modify
+ */
+#define sdstr_reverse(str) detail_sdstr_reverse_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str))
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a str.
+ *
+ *	@details	Average time complexity - same as @ref sdstr_free\n
+ *				Leaves an empty str behind.
+ *
+ *	@param[in]	str		Str to free
+ */
+#define sdstr_delete(str) detail_sdstr_delete_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str))
 
-#define sdstr_delete(str) detail_sdstr_switch_type(str,\
-	detail_sdstr_delete_impl((void *)(&str)),\
-	detail_sdstr_delete_impl((void *)(&str)),\
-	detail_sdstr_dummy_impl())
 /*
  *	Detail functions
  *	@cond false
@@ -306,268 +956,281 @@ typedef struct
 	sdstr_header header;
 } sdstr_heap;
 
-#define detail_sdstr_pos2ptr(str, pos) _Generic(pos,\
-	default: pos,\
-	sdstr_index: detail_sdstr_index_to_pointer_impl(\
-		str,\
-		detail_sdstr_s2h(str),\
-		index))
-
-#define detail_sdstr_cstr(value_expr) _Generic(value_expr,\
-	default: detail_sdstr_default(value_expr, char *, NULL),\
-	int: (char []){detail_sdstr_default(value_expr, int, '\0'), '\0'})
-
-#define detail_sdstr_size(value_expr) ((sizeof(value_expr) > sizeof(void *)) ?\
-	sizeof(value_expr) :\
-	strlen(value_expr))\
+/*Bytes an operation takes as its input*/
+typedef sdstr_view detail_sdstr_bytes;
+
+_Static_assert(SDSTR_UTF8_INDEX_STRIDE > 0, "SDSTR_UTF8_INDEX_STRIDE has to be positive");
+
+_Static_assert(SDSTR_SMALL_CAPACITY + 1 >= sizeof(void *) &&
+	SDSTR_SMALL_CAPACITY < 0xFF,
+	"SDSTR_SMALL_CAPACITY has to fit a pointer and its size in a byte");
+
+/*Stack-type strs pass their size in bytes as the kind, which is always
+larger than the other kinds. Views only have a kind in the operations that
+don't modify the str*/
+#define detail_sdstr_kind_heap 0
+#define detail_sdstr_kind_utf8 1
+#define detail_sdstr_kind_small 2
+#define detail_sdstr_kind_view 3
+
+#define detail_sdstr_kind(str) ((sdstr_index)_Generic(str,\
+	char *: sizeof(str) > sizeof(void *) ? sizeof(str) : detail_sdstr_kind_heap,\
+	void *: detail_sdstr_kind_utf8,\
+	sdstr_small: detail_sdstr_kind_small))
+
+#define detail_sdstr_read_kind(str) ((sdstr_index)_Generic(str,\
+	char *: sizeof(str) > sizeof(void *) ? sizeof(str) : detail_sdstr_kind_heap,\
+	void *: detail_sdstr_kind_utf8,\
+	sdstr_small: detail_sdstr_kind_small,\
+	sdstr_view: detail_sdstr_kind_view))
+
+#define detail_sdstr_ref(str) ((void *)&(str))
+
+#define detail_sdstr_pos(str, pos) _Generic(pos,\
+	char *: detail_sdstr_default(pos, char *, NULL),\
+	const char *: (char *)detail_sdstr_default(pos, const char *, NULL),\
+	void *: (char *)detail_sdstr_default(pos, void *, NULL),\
+	default: detail_sdstr_index_to_pointer_impl(\
+		detail_sdstr_ref(str),\
+		detail_sdstr_read_kind(str),\
+		(sdstr_index)_Generic(pos,\
+			char *: 0,\
+			const char *: 0,\
+			void *: 0,\
+			default: pos)))
+
+#define detail_sdstr_value(str, value_expr) _Generic(value_expr,\
+	char *: detail_sdstr_cstr_impl(\
+		detail_sdstr_default(value_expr, char *, NULL)),\
+	const char *: detail_sdstr_cstr_impl(\
+		detail_sdstr_default(value_expr, const char *, NULL)),\
+	void *: detail_sdstr_cstr_impl(\
+		detail_sdstr_default(value_expr, void *, NULL)),\
+	char: detail_sdstr_char_impl(\
+		detail_sdstr_read_kind(str),\
+		(unsigned char)detail_sdstr_default(value_expr, char, 0),\
+		(char [4]){0}),\
+	int: detail_sdstr_char_impl(\
+		detail_sdstr_read_kind(str),\
+		(uint32_t)detail_sdstr_default(value_expr, int, 0),\
+		(char [4]){0}),\
+	unsigned int: detail_sdstr_char_impl(\
+		detail_sdstr_read_kind(str),\
+		detail_sdstr_default(value_expr, unsigned int, 0),\
+		(char [4]){0}),\
+	sdstr_view: detail_sdstr_view_impl(\
+		detail_sdstr_default(value_expr, sdstr_view, detail_sdstr_empty_view)))
+
+#define detail_sdstr_empty_view ((sdstr_view){"", 0})
+
+#define detail_sdstr_getter_upto_2(_1, _2, NAME, ...) NAME
 
 #define detail_sdstr_getter_upto_3(_1, _2, _3, NAME, ...) NAME
 
 #define detail_sdstr_default(expr, type, value) _Generic(expr,\
 	type: expr,\
-	default: value)\
-
-#define detail_sdstr_is_utf8(str) _Generic(str, void *:1, char*:0)
-
-#define detail_sdstr_switch_type(str, expr_normal, expr_utf8, expr_stack)\
-	_Generic(str,\
-		char *: sizeof(str) > sizeof(void *) ? expr_stack : expr_normal,\
-		void *: expr_utf8)\
-
-#define detail_sdstr_s2h(str) ((sdstr_header *)\
-	((void *)detail_sdstr_switch_type(str,\
-		str == NULL ? NULL : (((char *)(str)) - sizeof(sdstr_header)),\
-		str == NULL ? NULL : (((char *)(str)) - sizeof(sdstr_header)),\
-		(((char *)(str)) + sizeof(str) - sizeof(sdstr_header)))))
-
-#define detail_sdstr_s2heap(str) ((sdstr_heap *)\
-	((void *)detail_sdstr_switch_type(str,\
-		str == NULL ? NULL : (((char *)(str)) - sizeof(sdstr_heap)),\
-		str == NULL ? NULL : (((char *)(str)) - sizeof(sdstr_heap)),\
-		NULL)))
-
-#define detail_sdstr_new1(str) detail_sdstr_switch_type(str,\
-	detail_sdstr_new_heap_impl(\
-		&str, NULL, 0),\
-	detail_sdstr_new_heap_utf8_impl(\
-		&str, NULL, 0),\
-	detail_sdstr_new_stack_impl(\
-		str, sdstr_capacity(str), NULL, 0))
-
-#define detail_sdstr_new2(str, value_expr) detail_sdstr_switch_type(str,\
-	detail_sdstr_new_heap_impl(\
-		&str, detail_sdstr_cstr(value_expr), detail_sdstr_size(value_expr)),\
-	detail_sdstr_new_heap_utf8_impl(\
-		&str, detail_sdstr_cstr(value_expr), detail_sdstr_size(value_expr)),\
-	detail_sdstr_new_stack_impl(\
-		str, sdstr_capacity(str), detail_sdstr_cstr(value_expr),\
-		detail_sdstr_size(value_expr)))
-
-#define detail_sdstr_new3(str, value_expr, byte_count)\
-	detail_sdstr_switch_type(str,\
-		detail_sdstr_new_heap_impl(\
-			&str, detail_sdstr_cstr(value_expr), byte_count),\
-		detail_sdstr_new_heap_utf8_impl(\
-			&str, detail_sdstr_cstr(value_expr), byte_count),\
-		detail_sdstr_new_stack_impl(\
-			str, sdstr_capacity(str), detail_sdstr_cstr(value_expr),\
-			byte_count))
-
-#define detail_sdstr_find2(str, value_expr)\
-
-#define detail_sdstr_find3(str, start, value_expr)\
-
-#define detail_sdstr_find_back2(str, value_expr)\
+	default: value)
+
+#define detail_sdstr_new1(str) detail_sdstr_new_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_value(str, ""),\
+	0)
+
+#define detail_sdstr_new2(str, value_expr) detail_sdstr_new_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_value(str, value_expr),\
+	0)
+
+#define detail_sdstr_new3(str, value_expr, byte_count) detail_sdstr_new_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_kind(str),\
+	detail_sdstr_value(str, value_expr),\
+	byte_count)
+
+#define detail_sdstr_find2(str, value_expr) detail_sdstr_find_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_pos(str, 0),\
+	detail_sdstr_value(str, value_expr))
+
+#define detail_sdstr_find3(str, start, value_expr) detail_sdstr_find_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	detail_sdstr_pos(str, start),\
+	detail_sdstr_value(str, value_expr))
+
+#define detail_sdstr_find_back2(str, value_expr) detail_sdstr_find_back_impl(\
+	detail_sdstr_ref(str),\
+	detail_sdstr_read_kind(str),\
+	NULL,\
+	detail_sdstr_value(str, value_expr))
 
 #define detail_sdstr_find_back3(str, start, value_expr)\
+	detail_sdstr_find_back_impl(\
+		detail_sdstr_ref(str),\
+		detail_sdstr_read_kind(str),\
+		detail_sdstr_pos(str, start),\
+		detail_sdstr_value(str, value_expr))
+
+SDSTR_API detail_sdstr_bytes detail_sdstr_cstr_impl(const char *value);
+
+SDSTR_API detail_sdstr_bytes detail_sdstr_view_impl(sdstr_view value);
+
+SDSTR_API detail_sdstr_bytes detail_sdstr_char_impl(
+	sdstr_index kind,
+	uint32_t value,
+	char *buffer);
+
+SDSTR_API int detail_sdstr_utf8_valid_impl(detail_sdstr_bytes value);
+
+SDSTR_API sdstr_index detail_sdstr_size_impl(void *str, sdstr_index kind);
 
-SDSTR_API sdstr_index detail_sdstr_size_impl(sdstr_header *header);
+SDSTR_API sdstr_index detail_sdstr_count_impl(void *str, sdstr_index kind);
 
-SDSTR_API sdstr_index detail_sdstr_count_utf8_impl(sdstr_header *header);
+SDSTR_API sdstr_index detail_sdstr_capacity_impl(void *str, sdstr_index kind);
 
-SDSTR_API sdstr_index detail_sdstr_capacity_impl(sdstr_heap *heap);
+SDSTR_API char *detail_sdstr_data_impl(void *str, sdstr_index kind);
 
 SDSTR_API int detail_sdstr_contains_impl(
 	void *str,
-	sdstr_header *header,
-	const char *expression);
+	sdstr_index kind,
+	detail_sdstr_bytes value);
 
-SDSTR_API void *detail_sdstr_find_impl(
+SDSTR_API char *detail_sdstr_find_impl(
 	void *str,
-	void *beg,
-	sdstr_header *header,
-	const char *expression);
+	sdstr_index kind,
+	char *start,
+	detail_sdstr_bytes value);
 
-SDSTR_API void *detail_sdstr_find_back_impl(
+SDSTR_API char *detail_sdstr_find_back_impl(
 	void *str,
-	void *beg,
-	sdstr_header *header,
-	const char *expression);
+	sdstr_index kind,
+	char *start,
+	detail_sdstr_bytes value);
 
-SDSTR_API void detail_sdstr_heap_reserve_impl(
-	void **str,
+SDSTR_API int detail_sdstr_compare_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes value);
+
+SDSTR_API void detail_sdstr_reserve_impl(
+	void *str,
+	sdstr_index kind,
 	sdstr_index capacity);
 
-SDSTR_API void detail_sdstr_new_heap_impl(
-	void **str,
-	char *source,
-	sdstr_index source_len);
-
-SDSTR_API void detail_sdstr_new_heap_utf8_impl(
-	void **str,
-	char *source,
-	sdstr_index source_len);
-
-SDSTR_API void detail_sdstr_new_stack_impl(
-	void **str,
-	sdstr_index capacity,
-	char *source,
-	sdstr_index source_len);
-
-SDSTR_API void detail_sdstr_dup_to_normal_impl(
-	void **str, 
-	void *src_str, 
-	sdstr_header *src_header);
-
-SDSTR_API void detail_sdstr_dup_to_utf8_impl(
-	void **str, 
-	void *src_str, 
-	sdstr_header *src_header);
-
-SDSTR_API void detail_sdstr_dup_to_stack_impl(
-	void *str, 
-	sdstr_index capacity,
-	void *src_str, 
-	sdstr_header *src_header);
-
-SDSTR_API void detail_sdstr_substr_normal_impl(
-	void **str,
-	void *ptr,
+SDSTR_API void detail_sdstr_new_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes value,
+	sdstr_index capacity);
+
+SDSTR_API void detail_sdstr_dup_impl(
+	void *str,
+	sdstr_index kind,
 	void *source,
-	sdstr_header *header,
-	sdstr_index count);
+	sdstr_index source_kind);
 
-SDSTR_API void detail_sdstr_substr_utf8_impl(
-	void **str,
-	void *ptr,
+SDSTR_API void detail_sdstr_substr_impl(
+	void *str,
+	sdstr_index kind,
 	void *source,
-	sdstr_header *header,
+	sdstr_index source_kind,
+	char *pos,
 	sdstr_index count);
 
-SDSTR_API void detail_sdstr_substr_stack_impl(
+SDSTR_API sdstr_view detail_sdstr_view_substr_impl(
 	void *str,
-	sdstr_index capacity,
-	void *ptr,
-	void *source,
-	sdstr_header *header,
+	sdstr_index kind,
+	char *pos,
 	sdstr_index count);
 
-SDSTR_API void *detail_sdstr_index_to_pointer_impl(
+SDSTR_API sdstr_split detail_sdstr_split_iter_impl(
 	void *str,
-	sdstr_header *header,
+	sdstr_index kind,
+	detail_sdstr_bytes delims);
+
+SDSTR_API int detail_sdstr_split_next_impl(sdstr_split *split, sdstr_view *view);
+
+SDSTR_API char *detail_sdstr_index_to_pointer_impl(
+	void *str,
+	sdstr_index kind,
 	sdstr_index index);
 
 SDSTR_API uint32_t detail_sdstr_get_impl(
 	void *str,
-	sdstr_header *header,
-	void *index);
+	sdstr_index kind,
+	char *pos);
 
-SDSTR_API uint32_t detail_sdstr_set_impl(
+SDSTR_API void detail_sdstr_set_impl(
 	void *str,
-	sdstr_header *header,
-	void *index,
-	int value);
+	sdstr_index kind,
+	char *pos,
+	uint32_t value);
 
-SDSTR_API void *detail_sdstr_getp_impl(
+SDSTR_API char *detail_sdstr_next_impl(
 	void *str,
-	sdstr_header *header,
-	void *index);
+	sdstr_index kind,
+	char *pos);
 
-SDSTR_API void *detail_sdstr_next_impl(
+SDSTR_API char *detail_sdstr_prev_impl(
 	void *str,
-	sdstr_header *header,
-	void *index);
+	sdstr_index kind,
+	char *pos);
 
-SDSTR_API void *detail_sdstr_prev_impl(
-	void *str,
-	sdstr_header *header,
-	void *ptr);
+SDSTR_API uint32_t detail_sdstr_pop_impl(void *str, sdstr_index kind);
 
-SDSTR_API void *detail_sdstr_last_impl(
+SDSTR_API char *detail_sdstr_splice_impl(
 	void *str,
-	sdstr_header *header);
-
-SDSTR_API void *detail_sdstr_insert_impl(
-	void **str,
-	sdstr_header *header,
-	void *index,
-	const char *expression);
-
-SDSTR_API void *detail_sdstr_insertf_impl(
-	void **str,
-	sdstr_header *header,
-	void *index,
-	const char *format,
-	...);
+	sdstr_index kind,
+	char *pos,
+	sdstr_index count,
+	detail_sdstr_bytes value);
 
-SDSTR_API void *detail_sdstr_erase_impl(
-	void **str,
-	sdstr_header *header,
-	void *index,
-	sdstr_index count);
+SDSTR_API char *detail_sdstr_push_int_impl(void *str, sdstr_index kind, int64_t value);
 
-SDSTR_API uint32_t detail_sdstr_pop_impl(
-	void **str,
-	sdstr_header *header);
+SDSTR_API char *detail_sdstr_push_uint_impl(void *str, sdstr_index kind, uint64_t value);
 
-SDSTR_API void *detail_sdstr_splice_impl(
-	void **str,
-	sdstr_header *header,
-	void *index,
-	sdstr_index count,
-	const char *expression);
+SDSTR_API char *detail_sdstr_push_double_impl(void *str, sdstr_index kind, double value);
 
-SDSTR_API void *detail_sdstr_splicef_impl(
-	void **str,
-	sdstr_header *header,
-	void *index,
+SDSTR_API char *detail_sdstr_splicef_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos,
 	sdstr_index count,
 	const char *format,
 	...);
 
-SDSTR_API void *detail_sdstr_replace_first_impl(
-	void **str,
-	sdstr_header *header,
-	const char *serach,
-	const char *expression);
+SDSTR_API char *detail_sdstr_replace_first_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	detail_sdstr_bytes value);
 
-SDSTR_API void *detail_sdstr_replacef_fitst_impl(
-	void **str,
-	sdstr_header *header,
-	const char *serach,
+SDSTR_API char *detail_sdstr_replacef_first_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
 	const char *format,
 	...);
 
-SDSTR_API void *detail_sdstr_replace_all_impl(
-	void **str,
-	sdstr_header *header,
-	const char *serach,
-	const char *expression);
+SDSTR_API sdstr_index detail_sdstr_replace_all_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	detail_sdstr_bytes value);
 
-SDSTR_API void *detail_sdstr_replacef_all_impl(
-	void **str,
-	sdstr_header *header,
-	const char *serach,
+SDSTR_API sdstr_index detail_sdstr_replacef_all_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
 	const char *format,
 	...);
 
-SDSTR_API void detail_sdstr_reverse_impl(
-	void *str,
-	sdstr_header *header);
-
-SDSTR_API void detail_sdstr_delete_impl(void **str);
+SDSTR_API void detail_sdstr_reverse_impl(void *str, sdstr_index kind);
 
-SDSTR_API void detail_sdstr_dummy_impl(void);
+SDSTR_API void detail_sdstr_delete_impl(void *str, sdstr_index kind);
 
 /*
  *	End of detail functions
@@ -0,0 +1,253 @@
+/**
+ * @file sdstr_intern.h	String interning pool for C, every distinct string
+ *						is stored once and named by a small integer.
+ * @date				18. Oct 2026
+ * @author				Mihkel Aaremäe
+ */
+#ifndef SDSTR_INTERN_H
+#define SDSTR_INTERN_H
+
+#include <sdstr.h>
+#include <sdhmap.h>
+
+#ifndef SDSTR_INTERN_CHUNK_SIZE
+/**
+ *	Size of the first block of interned bytes, every next one is twice as
+ *	large.
+ */
+#define SDSTR_INTERN_CHUNK_SIZE 4096
+#endif
+
+/**
+ *	@hideinitializer
+ *	@brief		Interning pool type. NULL is a valid empty pool.
+ *
+ *	@details	The bytes of the strings are kept in blocks that are never
+ *				reallocated, so the pointers to them stay valid until the
+ *				pool is deleted. Strings are named by handles of type
+ *				`sdhmap_index` that start from 1, equal strings get the same
+ *				handle. Handles can be used as keys of a
+ *				`sdhmap(sdhmap_index, value_type)`, so looking up a string
+ *				key is hashing and comparing an integer. Equal strings also
+ *				share one copy of the bytes, see @ref sdstr_intern_str.
+ */
+#define sdstr_intern sdstr_intern_header *
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of distinct strings in the pool.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	pool	Pool to retrieve the count from.
+ *
+ *	@return		Amount of strings in pool `(sdhmap_index)`.
+ */
+#define sdstr_intern_count(pool) detail_sdstr_intern_count_impl(pool)
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the handle of a string, if it isn't in the pool
+ *				then it is copied into it.
+ *
+ *	@details	Average time complexity - `O(value size)`
+ *
+ *	@param[in]	pool		Pool to look in
+ *	@param[in]	value_expr	C string or a character to intern
+ *
+ *	@return		Handle of the string `(sdhmap_index)`.
+ */
+#define sdstr_intern_get(pool, value_expr) detail_sdstr_intern_get_impl(\
+	&(pool),\
+	detail_sdstr_value((sdstr)NULL, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the interned copy of a string, if it isn't in the
+ *				pool then it is copied into it.
+ *
+ *	@details	Average time complexity - `O(value size)`\n
+ *				Equal strings get the same pointer, so interned strings can
+ *				be compared by identity and used as keys of a
+ *				`sdhmap(const char *, value_type)` created with
+ *				@ref sdstr_intern_ptr_hash and @ref sdstr_intern_ptr_eq.
+ *
+ *	@param[in]	pool		Pool to look in
+ *	@param[in]	value_expr	C string or a character to intern
+ *
+ *	@return		Pointer to the `'\0'` terminated bytes, it stays in place
+ *				until the pool is deleted `(const char *)`.
+ */
+#define sdstr_intern_str(pool, value_expr) detail_sdstr_intern_str_impl(\
+	&(pool),\
+	detail_sdstr_value((sdstr)NULL, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the handle of a string without interning it.
+ *
+ *	@details	Average time complexity - `O(value size)`
+ *
+ *	@param[in]	pool		Pool to look in
+ *	@param[in]	value_expr	C string or a character to look for
+ *
+ *	@return		Handle of the string, 0 if it isn't in the pool
+ *				`(sdhmap_index)`.
+ */
+#define sdstr_intern_find(pool, value_expr) detail_sdstr_intern_find_impl(\
+	pool,\
+	detail_sdstr_value((sdstr)NULL, value_expr))
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the bytes of an interned string.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				The bytes are followed by a `'\0'` and stay in place until
+ *				the pool is deleted.
+ *
+ *	@param[in]	pool		Pool the handle is from
+ *	@param[in]	handle		Handle of the string
+ *
+ *	@return		Pointer to the first byte `(const char *)`.
+ */
+#define sdstr_intern_data(pool, handle) detail_sdstr_intern_at(pool, handle).data
+
+/**
+ *	@hideinitializer
+ *	@brief		Retrieve the amount of bytes in an interned string.
+ *
+ *	@details	Average time complexity - `O(1)`
+ *
+ *	@param[in]	pool		Pool the handle is from
+ *	@param[in]	handle		Handle of the string
+ *
+ *	@return		Amount of bytes `(sdstr_index)`.
+ */
+#define sdstr_intern_size(pool, handle) detail_sdstr_intern_at(pool, handle).size
+
+/**
+ *	@hideinitializer
+ *	@brief		Free and invalidate a pool and all of the strings in it.
+ *
+ *	@details	Average time complexity - `O(blocks)`
+ *
+ *	@param[in]	pool	Pool to free
+ */
+#define sdstr_intern_delete(pool) detail_sdstr_intern_delete_impl(&(pool))
+
+/**
+ *	@hideinitializer
+ *	@brief		Hash function for maps with @ref sdstr_view keys, such as
+ *				`sdhmap(sdstr_view, value_type)`.
+ *
+ *	@details	Average time complexity - `O(view size)`\n
+ *				Pass it to @ref sdhmap_new together with
+ *				@ref sdstr_view_eq. The map only keeps the views, the bytes
+ *				they point to have to outlive it.
+ */
+#define sdstr_view_hash detail_sdstr_view_hash_impl
+
+/**
+ *	@hideinitializer
+ *	@brief		Equality function for maps with @ref sdstr_view keys.
+ *
+ *	@details	Average time complexity - `O(view size)`
+ */
+#define sdstr_view_eq detail_sdstr_view_eq_impl
+
+/**
+ *	@hideinitializer
+ *	@brief		Hash function for maps keyed by pointers from
+ *				@ref sdstr_intern_str, such as
+ *				`sdhmap(const char *, value_type)`.
+ *
+ *	@details	Average time complexity - `O(1)`\n
+ *				Only the pointer is hashed. Pass it to @ref sdhmap_new
+ *				together with @ref sdstr_intern_ptr_eq. Every key has to come
+ *				from the same pool.
+ */
+#define sdstr_intern_ptr_hash detail_sdstr_intern_ptr_hash_impl
+
+/**
+ *	@hideinitializer
+ *	@brief		Equality function for maps keyed by pointers from
+ *				@ref sdstr_intern_str, the pointers are compared.
+ *
+ *	@details	Average time complexity - `O(1)`
+ */
+#define sdstr_intern_ptr_eq detail_sdstr_intern_ptr_eq_impl
+
+/*
+ *	Detail functions
+ *	@cond false
+ */
+
+/**
+ *	@brief	Interned string.
+ */
+typedef struct detail_sdstr_intern_entry
+{
+	const char *data;
+	sdstr_index size;
+} detail_sdstr_intern_entry;
+
+/**
+ *	@brief	Interning pool header object.
+ */
+typedef struct sdstr_intern_header
+{
+	/**
+	 * Map from the bytes of the strings to their handles.
+	 */
+	sdhmap_header *map;
+
+	/**
+	 * Strings in the order they were interned, handle 1 is the first one.
+	 */
+	detail_sdstr_intern_entry *entries;
+	sdhmap_index entry_capacity;
+
+	/**
+	 * Newest block of bytes, every block starts with a pointer to the block
+	 * before it.
+	 */
+	char *chunks;
+	size_t chunk_capacity;
+	size_t chunk_used;
+} sdstr_intern_header;
+
+#define detail_sdstr_intern_at(pool, handle) (\
+	sdstr_assert((handle) > 0 && (handle) <= sdstr_intern_count(pool) &&\
+		"handle is not in the pool"),\
+	(pool)->entries[(handle) - 1])
+
+SDSTR_API sdhmap_index detail_sdstr_intern_count_impl(sdstr_intern_header *pool);
+
+SDSTR_API sdhmap_index detail_sdstr_intern_get_impl(
+	sdstr_intern_header **pool,
+	detail_sdstr_bytes value);
+
+SDSTR_API const char *detail_sdstr_intern_str_impl(
+	sdstr_intern_header **pool,
+	detail_sdstr_bytes value);
+
+SDSTR_API sdhmap_index detail_sdstr_intern_find_impl(
+	sdstr_intern_header *pool,
+	detail_sdstr_bytes value);
+
+SDSTR_API void detail_sdstr_intern_delete_impl(sdstr_intern_header **pool);
+
+SDSTR_API sdhmap_index detail_sdstr_view_hash_impl(const void *view);
+
+SDSTR_API int detail_sdstr_view_eq_impl(const void *a, const void *b);
+
+SDSTR_API sdhmap_index detail_sdstr_intern_ptr_hash_impl(const void *a);
+
+SDSTR_API int detail_sdstr_intern_ptr_eq_impl(const void *a, const void *b);
+
+/**
+ *	@endcond
+ */
+
+#endif
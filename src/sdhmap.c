@@ -6,8 +6,14 @@ void sdhmap_free(void *ptr);
 
 #define detail_sdhmap_slot(map, index) ((sdhmap_slot *)((char *)(map) + sizeof(sdhmap_header) + index * slot_size))
 
+#define detail_sdhmap_key(map, slot) ((void *)((char *)(slot) + (map)->key_offset))
+
+#define detail_sdhmap_value(map, slot) ((void *)((char *)(slot) + (map)->value_offset))
+
 #define detail_sdhmap_heap_from_header(h) ((sdhmap_heap *)((char *)((void *)(h)) - offsetof(sdhmap_heap, header)))
 
+#define detail_sdhmap_inline_storage(h) (&((sdhmap_inline_header *)((void *)(h)))->storage)
+
 #define detail_sdhmap_define_hash_func(type, postfix)\
 SDHMAP_API sdhmap_index detail_sdhmap_hash_##postfix(const void *a)\
 {\
@@ -95,18 +101,12 @@ SDHMAP_API void detail_sdhmap_init_slots(
 	uint32_t slot_size)
 {
 	sdhmap_index i;
-	detail_sdhmap_slot(header, 0)->slot = -1;
-	detail_sdhmap_slot(header, 0)->next = 1;
-	detail_sdhmap_slot(header, 0)->prev = -1;
-	for (i = 1; i + 1 < header->slot_count; i++)
+	for (i = 0; i < header->slot_count; i++)
 	{
 		detail_sdhmap_slot(header, i)->slot = -1;
-		detail_sdhmap_slot(header, i)->next = i + 1;
+		detail_sdhmap_slot(header, i)->next = i + 1 < header->slot_count ? i + 1 : (sdhmap_index)-1;
 		detail_sdhmap_slot(header, i)->prev = i - 1;
 	}
-	detail_sdhmap_slot(header, i)->slot = -1;
-	detail_sdhmap_slot(header, i)->next = -1;
-	detail_sdhmap_slot(header, i)->prev = i - 1;
 }
 
 SDHMAP_API void detail_sdhmap_new_heap_impl(
@@ -114,7 +114,9 @@ SDHMAP_API void detail_sdhmap_new_heap_impl(
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size)
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset)
 {
 	sdhmap_heap *heap = sdhmap_malloc(sizeof(sdhmap_heap) + count * slot_size);
 	sdhmap_assert((heap != NULL) && "sdhmap_malloc returned NULL");
@@ -125,7 +127,9 @@ SDHMAP_API void detail_sdhmap_new_heap_impl(
 		hash_func, 
 		eq_func, 
 		count, 
-		slot_size);
+		slot_size,
+		key_offset,
+		value_offset);
 }
 
 SDHMAP_API void detail_sdhmap_new_stack_impl(
@@ -133,13 +137,17 @@ SDHMAP_API void detail_sdhmap_new_stack_impl(
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size)
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset)
 {
 	header->count = 0;
 	header->slot_count = count;
 	header->used_bucket_count = 0;
 	header->hash_func = hash_func;
 	header->eq_func = eq_func;
+	header->key_offset = key_offset;
+	header->value_offset = value_offset;
 	if (count > 0)
 	{
 		header->empty_slot = 0;
@@ -204,12 +212,14 @@ SDHMAP_API sdhmap_header **detail_sdhmap_ensure_initialized_impl(
 	sdhmap_index (*hash_func)(const void *),
 	int (*eq_func)(const void *, const void *),
 	sdhmap_index count,
-	uint32_t slot_size)
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset)
 {
 	if (!(*header))
 	{
 		detail_sdhmap_new_heap_impl(
-			header, hash_func, eq_func, count, slot_size);
+			header, hash_func, eq_func, count, slot_size, key_offset, value_offset);
 	}
 	return header;
 }
@@ -240,14 +250,14 @@ SDHMAP_API int detail_sdhmap_contains_impl(
 	{
 		if (header->eq_func)
 		{
-			if (header->eq_func(slot + 1, key) == 0)
+			if (header->eq_func(detail_sdhmap_key(header, slot), key) == 0)
 			{
 				return 1;
 			}
 		}
 		else
 		{
-			if (memcmp(slot + 1, key, key_size) == 0)
+			if (memcmp(detail_sdhmap_key(header, slot), key, key_size) == 0)
 			{
 				return 1;
 			}
@@ -295,11 +305,11 @@ SDHMAP_API void *detail_sdhmap_insert_to_empty(
 	sdhmap_slot *slot;
 	new_index = detail_sdhmap_pop_empty(header, slot_size);
 	detail_sdhmap_slot(header, empty_index)->slot = new_index;
-	slot = detail_sdhmap_slot(header, new_index) + 1;
-	memcpy(slot, key, key_size);
+	slot = detail_sdhmap_slot(header, new_index);
+	memcpy(detail_sdhmap_key(header, slot), key, key_size);
 	header->count ++;
 	header->used_bucket_count ++;
-	return ((char *)(slot)) + key_size;
+	return detail_sdhmap_value(header, slot);
 }
 
 SDHMAP_API void *detail_sdhmap_insert_to_list(
@@ -313,10 +323,11 @@ SDHMAP_API void *detail_sdhmap_insert_to_list(
 	sdhmap_slot *slot;
 	new_index = detail_sdhmap_pop_empty(header, slot_size);
 	detail_sdhmap_slot(header, end_index)->next = new_index;
-	slot = detail_sdhmap_slot(header, new_index) + 1;
-	memcpy(slot, key, key_size);
+	slot = detail_sdhmap_slot(header, new_index);
+	slot->prev = end_index;
+	memcpy(detail_sdhmap_key(header, slot), key, key_size);
 	header->count ++;
-	return ((char *)(slot)) + key_size;
+	return detail_sdhmap_value(header, slot);
 }
 
 SDHMAP_API char *detail_sdhmap_get_kv_pairs(
@@ -324,7 +335,7 @@ SDHMAP_API char *detail_sdhmap_get_kv_pairs(
 	uint32_t slot_size)
 {
 	char *pairs;
-	const uint32_t pair_size = slot_size - sizeof(sdhmap_slot);
+	const uint32_t pair_size = slot_size - header->key_offset;
 	sdhmap_index i, j;
 	sdhmap_slot *slot;
 	if (header->slot_count == 0)
@@ -340,7 +351,7 @@ SDHMAP_API char *detail_sdhmap_get_kv_pairs(
 		if (slot->slot != (sdhmap_index)-1)
 		{
 			slot = detail_sdhmap_slot(header, slot->slot);
-			memcpy(pairs + j * pair_size, slot + 1, pair_size);
+			memcpy(pairs + j * pair_size, detail_sdhmap_key(header, slot), pair_size);
 			j++;
 			while (1)
 			{
@@ -349,7 +360,7 @@ SDHMAP_API char *detail_sdhmap_get_kv_pairs(
 					break;
 				}
 				slot = detail_sdhmap_slot(header, slot->next);
-				memcpy(pairs + j * pair_size, slot + 1, pair_size);
+				memcpy(pairs + j * pair_size, detail_sdhmap_key(header, slot), pair_size);
 				j++;
 			}
 		}
@@ -362,7 +373,7 @@ SDHMAP_API sdhmap_header *detail_sdhmap_heap_realloc(
 	sdhmap_index slot_size)
 {
 	sdhmap_heap *heap;
-	sdhmap_index capacity;
+	size_t capacity;
 	heap = detail_sdhmap_heap_from_header(header);
 	capacity = heap->capacity;
 	while (capacity < sizeof(sdhmap_heap) + slot_size * header->slot_count)
@@ -400,16 +411,16 @@ SDHMAP_API void *detail_sdhmap_set_common(
 	{
 		if (header->eq_func)
 		{
-			if (header->eq_func(slot + 1, key) == 0)
+			if (header->eq_func(detail_sdhmap_key(header, slot), key) == 0)
 			{
-				return ((char *)(slot + 1)) + key_size;
+				return detail_sdhmap_value(header, slot);
 			}
 		}
 		else
 		{
-			if (memcmp(slot + 1, key, key_size) == 0)
+			if (memcmp(detail_sdhmap_key(header, slot), key, key_size) == 0)
 			{
-				return ((char *)(slot + 1)) + key_size;
+				return detail_sdhmap_value(header, slot);
 			}
 		}
 		if (slot->next != (sdhmap_index)-1)
@@ -432,7 +443,8 @@ SDHMAP_API void detail_sdhmap_heap_resize(
 	sdhmap_index target)
 {
 	char *pairs;
-	const uint32_t pair_size = slot_size - sizeof(sdhmap_slot);
+	const uint32_t pair_size = slot_size - (*header)->key_offset;
+	const uint32_t value_offset = (*header)->value_offset - (*header)->key_offset;
 	sdhmap_index i, j;
 	if ((*header)->slot_count == target)
 	{
@@ -454,8 +466,8 @@ SDHMAP_API void detail_sdhmap_heap_resize(
 				slot_size,
 				key_size,
 				pairs + i * pair_size),
-			pairs + i * pair_size + key_size,
-			slot_size - key_size - sizeof(sdhmap_slot));
+			pairs + i * pair_size + value_offset,
+			pair_size - value_offset);
 	}
 	sdhmap_free(pairs);
 }
@@ -485,7 +497,8 @@ SDHMAP_API void detail_sdhmap_stack_resize(
 	sdhmap_index target)
 {
 	char *pairs;
-	const uint32_t pair_size = slot_size - sizeof(sdhmap_slot);
+	const uint32_t pair_size = slot_size - header->key_offset;
+	const uint32_t value_offset = header->value_offset - header->key_offset;
 	sdhmap_index i, j;
 	j = header->count;
 	pairs = detail_sdhmap_get_kv_pairs(header, slot_size);
@@ -506,8 +519,8 @@ SDHMAP_API void detail_sdhmap_stack_resize(
 				slot_size,
 				key_size,
 				pairs + i * pair_size),
-			pairs + i * pair_size + key_size,
-			slot_size - key_size - sizeof(sdhmap_slot));
+			pairs + i * pair_size + value_offset,
+			pair_size - value_offset);
 	}
 	sdhmap_free(pairs);
 }
@@ -538,15 +551,15 @@ SDHMAP_API void *detail_sdhmap_set_heap_optimized_impl(
 	const void *key)
 {
 	sdhmap_index i;
-	uintptr_t key_offset;
+	uintptr_t offset;
 	if ((uintptr_t)key >= (uintptr_t)(*header + 1) &&
 		(uintptr_t)key <= (uintptr_t)(((char *)(*header + 1)) + slot_size * (*header)->slot_count))
 	{
-		key_offset = (uintptr_t)key - (uintptr_t)(*header + 1);
-		if (key_offset % (uintptr_t)slot_size == sizeof(sdhmap_slot))
+		offset = (uintptr_t)key - (uintptr_t)(*header + 1);
+		if (offset % (uintptr_t)slot_size == (*header)->key_offset)
 		{
-			i = key_offset / (uintptr_t)slot_size;
-			return ((char *)(detail_sdhmap_slot(*header, i) + 1)) + key_size;
+			i = offset / (uintptr_t)slot_size;
+			return detail_sdhmap_value((*header), detail_sdhmap_slot(*header, i));
 		}
 	}
 	return detail_sdhmap_set_heap_impl(header, slot_size, key_size, key);
@@ -560,16 +573,16 @@ SDHMAP_API void *detail_sdhmap_set_stack_optimized_impl(
 	sdhmap_index capacity)
 {
 	sdhmap_index i;
-	uintptr_t key_offset;
+	uintptr_t offset;
 	sdhmap_assert((capacity != 0) && "sdhmap has 0 capacity");
 	if ((uintptr_t)key >= (uintptr_t)(header + 1) &&
 		(uintptr_t)key <= (uintptr_t)(((char *)(header + 1)) + slot_size * header->slot_count))
 	{
-		key_offset = (uintptr_t)key - (uintptr_t)(header + 1);
-		if (key_offset % (uintptr_t)slot_size == sizeof(sdhmap_slot))
+		offset = (uintptr_t)key - (uintptr_t)(header + 1);
+		if (offset % (uintptr_t)slot_size == header->key_offset)
 		{
-			i = key_offset / (uintptr_t)slot_size;
-			return ((char *)(detail_sdhmap_slot(header, i) + 1)) + key_size;
+			i = offset / (uintptr_t)slot_size;
+			return detail_sdhmap_value(header, detail_sdhmap_slot(header, i));
 		}
 	}
 	return detail_sdhmap_set_stack_impl(header, slot_size, key_size, key, capacity);
@@ -627,16 +640,16 @@ SDHMAP_API void *detail_sdhmap_getp_impl(
 	{
 		if (header->eq_func)
 		{
-			if (header->eq_func(slot + 1, key) == 0)
+			if (header->eq_func(detail_sdhmap_key(header, slot), key) == 0)
 			{
-				return ((char *)(slot + 1)) + key_size;
+				return detail_sdhmap_value(header, slot);
 			}
 		}
 		else
 		{
-			if (memcmp(slot + 1, key, key_size) == 0)
+			if (memcmp(detail_sdhmap_key(header, slot), key, key_size) == 0)
 			{
-				return ((char *)(slot + 1)) + key_size;
+				return detail_sdhmap_value(header, slot);
 			}
 		}
 		if (slot->next != (sdhmap_index)-1)
@@ -674,7 +687,10 @@ SDHMAP_API void detail_sdhmap_erase_at(
 			detail_sdhmap_slot(header, h_slot->next)->prev = 
 				(sdhmap_index)-1;
 		}
-		detail_sdhmap_slot(header, header->empty_slot)->prev = hash;
+		if (header->empty_slot != (sdhmap_index)-1)
+		{
+			detail_sdhmap_slot(header, header->empty_slot)->prev = hash;
+		}
 		h_slot->prev = (sdhmap_index)-1;
 		h_slot->next = header->empty_slot;
 		header->empty_slot = hash;
@@ -691,7 +707,10 @@ SDHMAP_API void detail_sdhmap_erase_at(
 			b_slot->next = h_slot->next;
 			detail_sdhmap_slot(header, h_slot->next)->prev = h_slot->prev;
 		}
-		detail_sdhmap_slot(header, header->empty_slot)->prev = hash;
+		if (header->empty_slot != (sdhmap_index)-1)
+		{
+			detail_sdhmap_slot(header, header->empty_slot)->prev = hash;
+		}
 		h_slot->prev = (sdhmap_index)-1;
 		h_slot->next = header->empty_slot;
 		header->empty_slot = hash;
@@ -727,7 +746,7 @@ SDHMAP_API void detail_sdhmap_erase_impl(
 	{
 		if (header->eq_func)
 		{
-			if (header->eq_func(slot + 1, key) == 0)
+			if (header->eq_func(detail_sdhmap_key(header, slot), key) == 0)
 			{
 				detail_sdhmap_erase_at(header, slot_size, bucket, hash);
 				return;
@@ -735,7 +754,7 @@ SDHMAP_API void detail_sdhmap_erase_impl(
 		}
 		else
 		{
-			if (memcmp(slot + 1, key, key_size) == 0)
+			if (memcmp(detail_sdhmap_key(header, slot), key, key_size) == 0)
 			{
 				detail_sdhmap_erase_at(header, slot_size, bucket, hash);
 				return;
@@ -759,7 +778,7 @@ SDHMAP_API void detail_sdhmap_shrink_heap_impl(
 	uint32_t key_size)
 {
 	sdhmap_heap *heap;
-	sdhmap_index capacity;
+	size_t capacity;
 	if (*header == NULL)
 	{
 		return;
@@ -806,7 +825,7 @@ SDHMAP_API void *detail_sdhmap_first_impl(
 		slot = detail_sdhmap_slot(header, hash);
 		if (slot->slot != (sdhmap_index)-1)
 		{
-			return detail_sdhmap_slot(header, slot->slot) + 1;
+			return detail_sdhmap_key(header, detail_sdhmap_slot(header, slot->slot));
 		}
 		hash ++;
 		if (hash == header->slot_count)
@@ -843,14 +862,14 @@ SDHMAP_API void *detail_sdhmap_next_impl(
 	{
 		if (header->eq_func)
 		{
-			if (header->eq_func(slot + 1, key) == 0)
+			if (header->eq_func(detail_sdhmap_key(header, slot), key) == 0)
 			{
 				goto match;
 			}
 		}
 		else
 		{
-			if (memcmp(slot + 1, key, key_size) == 0)
+			if (memcmp(detail_sdhmap_key(header, slot), key, key_size) == 0)
 			{
 				goto match;
 			}
@@ -868,7 +887,7 @@ SDHMAP_API void *detail_sdhmap_next_impl(
 	match:;
 	if (slot->next != (sdhmap_index)-1)
 	{
-		return detail_sdhmap_slot(header, slot->next) + 1;
+		return detail_sdhmap_key(header, detail_sdhmap_slot(header, slot->next));
 	}
 	hash ++;
 	if (hash == header->slot_count)
@@ -880,7 +899,7 @@ SDHMAP_API void *detail_sdhmap_next_impl(
 		slot = detail_sdhmap_slot(header, hash);
 		if (slot->slot != (sdhmap_index)-1)
 		{
-			return detail_sdhmap_slot(header, slot->slot) + 1;
+			return detail_sdhmap_key(header, detail_sdhmap_slot(header, slot->slot));
 		}
 		hash ++;
 		if (hash == header->slot_count)
@@ -903,3 +922,191 @@ SDHMAP_API void detail_sdhmap_dummy_impl(void)
 {
 
 }
+
+SDHMAP_API void detail_sdhmap_new_inline_impl(
+	sdhmap_header **header,
+	sdhmap_index (*hash_func)(const void *),
+	int (*eq_func)(const void *, const void *),
+	sdhmap_index count,
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset)
+{
+	sdhmap_heap *storage = detail_sdhmap_inline_storage(header);
+	storage->capacity = count * slot_size;
+	/*The object keeps NULL instead of a pointer to itself while the elements are in storage*/
+	*header = NULL;
+	detail_sdhmap_new_stack_impl(
+		&storage->header, 
+		hash_func, 
+		eq_func, 
+		count, 
+		slot_size,
+		key_offset,
+		value_offset);
+}
+
+/*Insert every element of source into header, which has enough slots for them*/
+SDHMAP_API void detail_sdhmap_rehash(
+	sdhmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_header *source)
+{
+	char *pairs;
+	const uint32_t pair_size = slot_size - source->key_offset;
+	const uint32_t value_offset = source->value_offset - source->key_offset;
+	sdhmap_index i;
+	if (source->count == 0)
+	{
+		return;
+	}
+	pairs = detail_sdhmap_get_kv_pairs(source, slot_size);
+	for (i = 0; i < source->count; i++)
+	{
+		memcpy(
+			detail_sdhmap_set_common(
+				header,
+				slot_size,
+				key_size,
+				pairs + i * pair_size),
+			pairs + i * pair_size + value_offset,
+			pair_size - value_offset);
+	}
+	sdhmap_free(pairs);
+}
+
+/*Move the elements to a heap block with target slots*/
+SDHMAP_API void detail_sdhmap_inline_spill(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_index target)
+{
+	sdhmap_header *block;
+	if (*header == NULL)
+	{
+		*header = &detail_sdhmap_inline_storage(header)->header;
+	}
+	detail_sdhmap_new_heap_impl(
+		&block, 
+		(*header)->hash_func, 
+		(*header)->eq_func, 
+		target, 
+		slot_size,
+		(*header)->key_offset,
+		(*header)->value_offset);
+	detail_sdhmap_rehash(block, slot_size, key_size, *header);
+	if (*header != &detail_sdhmap_inline_storage(header)->header)
+	{
+		detail_sdhmap_delete_impl(header);
+	}
+	*header = block;
+}
+
+SDHMAP_API void detail_sdhmap_duplicate_inline_impl(
+	sdhmap_header **header,
+	sdhmap_index capacity,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t key_offset,
+	uint32_t value_offset,
+	sdhmap_header *source)
+{
+	sdhmap_heap *heap;
+	/*The destination may not be constructed, so nothing is read from it*/
+	if (source == NULL)
+	{
+		detail_sdhmap_new_inline_impl(header, NULL, NULL, capacity, slot_size, key_offset, value_offset);
+		return;
+	}
+	detail_sdhmap_new_inline_impl(header, source->hash_func, source->eq_func, capacity, slot_size, key_offset, value_offset);
+	if (source->count <= capacity)
+	{
+		detail_sdhmap_rehash(&detail_sdhmap_inline_storage(header)->header, slot_size, key_size, source);
+		return;
+	}
+	heap = sdhmap_malloc(sizeof(sdhmap_heap) + source->slot_count * slot_size);
+	sdhmap_assert(heap != NULL && "sdhmap_malloc returned NULL");
+	heap->capacity = source->slot_count * slot_size;
+	memcpy(&heap->header, source, sizeof(sdhmap_header) + heap->capacity);
+	*header = &(heap->header);
+}
+
+SDHMAP_API void *detail_sdhmap_set_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key)
+{
+	sdhmap_header *storage = &detail_sdhmap_inline_storage(header)->header;
+	if (*header != NULL)
+	{
+		return detail_sdhmap_set_heap_optimized_impl(header, slot_size, key_size, key);
+	}
+	/*Every slot of the storage is used as a bucket, so it only has to be left once it is full*/
+	if (storage->count == storage->slot_count &&
+		detail_sdhmap_getp_impl(storage, slot_size, key_size, key) == NULL)
+	{
+		detail_sdhmap_inline_spill(header, slot_size, key_size,
+			storage->slot_count == 0 ?
+				SDHMAP_DEFAULT_CAPACITY :
+				storage->slot_count * 2);
+		return detail_sdhmap_set_heap_impl(header, slot_size, key_size, key);
+	}
+	return detail_sdhmap_set_common(storage, slot_size, key_size, key);
+}
+
+SDHMAP_API void detail_sdhmap_reserve_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdhmap_index target)
+{
+	if (*header != NULL)
+	{
+		detail_sdhmap_reserve_heap_impl(header, slot_size, key_size, target);
+	}
+	else if (target > detail_sdhmap_inline_storage(header)->header.slot_count)
+	{
+		detail_sdhmap_inline_spill(header, slot_size, key_size, target);
+	}
+}
+
+SDHMAP_API void detail_sdhmap_shrink_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size,
+	uint32_t key_size)
+{
+	sdhmap_heap *storage = detail_sdhmap_inline_storage(header);
+	sdhmap_header *block = *header;
+	if (block == NULL)
+	{
+		return;
+	}
+	if (block->count * slot_size > storage->capacity)
+	{
+		detail_sdhmap_shrink_heap_impl(header, slot_size, key_size);
+		return;
+	}
+	detail_sdhmap_new_inline_impl(header, block->hash_func, block->eq_func, storage->capacity / slot_size, slot_size, block->key_offset, block->value_offset);
+	detail_sdhmap_rehash(&storage->header, slot_size, key_size, block);
+	detail_sdhmap_delete_impl(&block);
+}
+
+SDHMAP_API void detail_sdhmap_delete_inline_impl(
+	sdhmap_header **header,
+	uint32_t slot_size)
+{
+	sdhmap_heap *storage = detail_sdhmap_inline_storage(header);
+	sdhmap_header *active = *header == NULL ? &storage->header : *header;
+	sdhmap_index (*hash_func)(const void *) = active->hash_func;
+	int (*eq_func)(const void *, const void *) = active->eq_func;
+	uint32_t key_offset = active->key_offset;
+	uint32_t value_offset = active->value_offset;
+	if (*header != NULL)
+	{
+		detail_sdhmap_delete_impl(header);
+	}
+	detail_sdhmap_new_inline_impl(header, hash_func, eq_func, storage->capacity / slot_size, slot_size, key_offset, value_offset);
+}
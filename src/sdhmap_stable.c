@@ -0,0 +1,105 @@
+#include <sdhmap_stable.h>
+
+void *sdhmap_malloc(size_t size);
+void sdhmap_free(void *ptr);
+
+SDHMAP_API sdhmap_stable_header *detail_sdhmap_stable_ensure_initialized_impl(
+	sdhmap_stable_header **header,
+	sdhmap_index (*hash_func)(const void *),
+	int (*eq_func)(const void *, const void *),
+	uint32_t slot_size,
+	uint32_t key_offset,
+	uint32_t value_offset)
+{
+	if (*header == NULL)
+	{
+		*header = sdhmap_malloc(sizeof(sdhmap_stable_header));
+		sdhmap_assert(*header != NULL && "sdhmap_malloc returned NULL");
+		(*header)->map = NULL;
+		detail_sdd_stable_pool_new(&(*header)->values);
+	}
+	detail_sdhmap_ensure_initialized_impl(&(*header)->map, hash_func, eq_func,
+		SDHMAP_DEFAULT_CAPACITY, slot_size, key_offset, value_offset);
+	return *header;
+}
+
+SDHMAP_API sdhmap_index detail_sdhmap_stable_count_impl(sdhmap_stable_header *header)
+{
+	if (header == NULL)
+	{
+		return 0;
+	}
+	return header->map->count;
+}
+
+SDHMAP_API void *detail_sdhmap_stable_getp_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key)
+{
+	void *value_ptr;
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	value_ptr = detail_sdhmap_getp_impl(header->map, slot_size, key_size, key);
+	if (value_ptr == NULL)
+	{
+		return NULL;
+	}
+	return *(void **)value_ptr;
+}
+
+SDHMAP_API void *detail_sdhmap_stable_get_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_align,
+	const void *key)
+{
+	sdhmap_index count;
+	void *value_ptr;
+	void *result;
+	count = header->map->count;
+	value_ptr = detail_sdhmap_set_heap_impl(&header->map, slot_size, key_size, key);
+	if (header->map->count == count)
+	{
+		return *(void **)value_ptr;
+	}
+	result = detail_sdd_stable_pool_alloc(&header->values, value_size, value_align, SDHMAP_DEFAULT_CAPACITY, sdhmap_malloc);
+	sdhmap_assert(result != NULL && "sdhmap_malloc returned NULL");
+	memset(result, 0, value_size);
+	*(void **)value_ptr = result;
+	return result;
+}
+
+SDHMAP_API void detail_sdhmap_stable_erase_impl(
+	sdhmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	const void *key)
+{
+	void *value;
+	value = detail_sdhmap_stable_getp_impl(header, slot_size, key_size, key);
+	if (value == NULL)
+	{
+		return;
+	}
+	/*Only the pointer in the slot is moved around by the erase, the value stays put*/
+	detail_sdhmap_erase_impl(header->map, slot_size, key_size, key);
+	detail_sdd_stable_pool_release(&header->values, value);
+}
+
+SDHMAP_API void detail_sdhmap_stable_delete_impl(sdhmap_stable_header **header)
+{
+	if (*header == NULL)
+	{
+		return;
+	}
+	detail_sdd_stable_pool_delete(&(*header)->values, sdhmap_free);
+	detail_sdhmap_delete_impl(&(*header)->map);
+	sdhmap_free(*header);
+	*header = NULL;
+}
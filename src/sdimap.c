@@ -0,0 +1,264 @@
+#include <sdimap.h>
+
+#define detail_sdmap_slot(map, index) ((sdmap_slot *)((char *)(map) + sizeof(sdmap_header) + (index) * slot_size))
+
+#define detail_sdmap_slot_key(map, slot) ((void *)((char *)(slot) + (map)->key_offset))
+
+#define detail_sdimap_start(interval) ((const void *)(interval))
+
+#define detail_sdimap_end(interval) ((const void *)((const char *)(interval) + bound_size))
+
+#define detail_sdimap_max_end(interval) ((void *)((char *)(interval) + 2 * bound_size))
+
+/*Intervals are ordered by start, then by end*/
+SDMAP_API int detail_sdimap_compare(
+	sdmap_header *header,
+	uint32_t bound_size,
+	const void *a,
+	const void *b)
+{
+	int compare_result = header->compare_func(detail_sdimap_start(a), detail_sdimap_start(b));
+	if (compare_result != 0)
+	{
+		return compare_result;
+	}
+	return header->compare_func(detail_sdimap_end(a), detail_sdimap_end(b));
+}
+
+SDMAP_API void detail_sdimap_update(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	sdmap_index slot_index)
+{
+	sdmap_slot *slot = detail_sdmap_slot(header, slot_index);
+	const void *max_end = detail_sdimap_end(detail_sdmap_slot_key(header, slot));
+	const void *child_max_end;
+	if (slot->left != slot_index)
+	{
+		child_max_end = detail_sdimap_max_end(detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot->left)));
+		if (header->compare_func(child_max_end, max_end) > 0)
+		{
+			max_end = child_max_end;
+		}
+	}
+	if (slot->right != slot_index)
+	{
+		child_max_end = detail_sdimap_max_end(detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot->right)));
+		if (header->compare_func(child_max_end, max_end) > 0)
+		{
+			max_end = child_max_end;
+		}
+	}
+	memmove(detail_sdimap_max_end(detail_sdmap_slot_key(header, slot)), max_end, bound_size);
+}
+
+/*
+ *	Every subtree an insert or erase changes, rotations included, is rooted
+ *	either on the way from the changed slot to the root or at a child of a
+ *	slot on that way, and the subtrees below those children are untouched.
+ *	So refreshing both children before each slot on the way up is enough.
+ */
+SDMAP_API void detail_sdimap_update_path(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	sdmap_index slot_index)
+{
+	sdmap_slot *slot;
+	while (slot_index != (sdmap_index)-1)
+	{
+		slot = detail_sdmap_slot(header, slot_index);
+		if (slot->left != slot_index)
+		{
+			detail_sdimap_update(header, slot_size, bound_size, slot->left);
+		}
+		if (slot->right != slot_index)
+		{
+			detail_sdimap_update(header, slot_size, bound_size, slot->right);
+		}
+		detail_sdimap_update(header, slot_size, bound_size, slot_index);
+		slot_index = detail_sdmap_parent(slot);
+	}
+}
+
+SDMAP_API void *detail_sdimap_insert_impl(
+	sdmap_header **header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *interval)
+{
+	int compare_result;
+	uint32_t key_size = 3 * bound_size;
+	sdmap_index slot_index;
+	sdmap_index next_index;
+	sdmap_slot *slot;
+	char *result;
+	sdmap_assert((*header)->compare_func != NULL && "sdmap does not have a compare function");
+	if ((*header)->count == 0)
+	{
+		return detail_sdmap_set_heap_impl(header, slot_size, key_size, interval);
+	}
+	slot_index = (*header)->root_slot;
+	while (1)
+	{
+		slot = detail_sdmap_slot(*header, slot_index);
+		/*Equal intervals go to the right*/
+		compare_result = detail_sdimap_compare(*header, bound_size, detail_sdmap_slot_key(*header, slot), interval) > 0 ? 1 : -1;
+		next_index = compare_result > 0 ? slot->left : slot->right;
+		if (next_index == slot_index)
+		{
+			break;
+		}
+		slot_index = next_index;
+	}
+	result = detail_sdmap_attach_heap_impl(header, slot_size, key_size, interval, slot_index, compare_result);
+	slot_index = (sdmap_index)((result - value_offset - (char *)(*header + 1)) / slot_size);
+	detail_sdimap_update_path(*header, slot_size, bound_size, slot_index);
+	return result;
+}
+
+SDMAP_API void detail_sdimap_erase_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	const void *interval)
+{
+	int compare_result;
+	sdmap_index slot_index;
+	sdmap_index removed;
+	sdmap_index parent;
+	sdmap_slot *slot;
+	if (header == NULL ||
+		header->count == 0)
+	{
+		return;
+	}
+	slot_index = header->root_slot;
+	while (1)
+	{
+		slot = detail_sdmap_slot(header, slot_index);
+		compare_result = detail_sdimap_compare(header, bound_size, detail_sdmap_slot_key(header, slot), interval);
+		if (compare_result == 0)
+		{
+			break;
+		}
+		if ((compare_result > 0 ? slot->left : slot->right) == slot_index)
+		{
+			return;
+		}
+		slot_index = compare_result > 0 ? slot->left : slot->right;
+	}
+	/*The slot that actually leaves the tree is the successor if there are two children*/
+	removed = slot_index;
+	if (slot->left != slot_index &&
+		slot->right != slot_index)
+	{
+		removed = slot->right;
+		while (detail_sdmap_slot(header, removed)->left != removed)
+		{
+			removed = detail_sdmap_slot(header, removed)->left;
+		}
+	}
+	parent = detail_sdmap_parent(detail_sdmap_slot(header, removed));
+	/*Erase through a pointer, so sdmap doesn't need to compare and doesn't shrink*/
+	detail_sdmap_erase_impl(header, slot_size, detail_sdmap_slot_key(header, slot));
+	if (header->count > 0)
+	{
+		detail_sdimap_update_path(header, slot_size, bound_size, parent);
+	}
+	else
+	{
+		/*Forget the freed slots, inserting into an empty map starts from slot 0*/
+		header->slot_count = 0;
+		header->empty_slot = (sdmap_index)-1;
+	}
+}
+
+SDMAP_API void detail_sdimap_overlaps(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *range,
+	int closed,
+	sdmap_index slot_index,
+	void (*function)(const void *key, void *value),
+	void (*function_ex)(const void *key, void *value, void *user),
+	void *user)
+{
+	int compare_result;
+	sdmap_slot *slot = detail_sdmap_slot(header, slot_index);
+	/*Nothing in the subtree ends after the range starts*/
+	compare_result = header->compare_func(detail_sdimap_max_end(detail_sdmap_slot_key(header, slot)), detail_sdimap_start(range));
+	if (compare_result <= 0)
+	{
+		return;
+	}
+	if (slot->left != slot_index)
+	{
+		detail_sdimap_overlaps(header, slot_size, bound_size, value_offset, range, closed,
+			slot->left, function, function_ex, user);
+	}
+	/*This and everything to the right starts after the range*/
+	compare_result = header->compare_func(detail_sdimap_start(detail_sdmap_slot_key(header, slot)), detail_sdimap_end(range));
+	if (compare_result > 0 ||
+		(compare_result == 0 && !closed))
+	{
+		return;
+	}
+	if (header->compare_func(detail_sdimap_end(detail_sdmap_slot_key(header, slot)), detail_sdimap_start(range)) > 0)
+	{
+		if (function_ex)
+		{
+			function_ex(detail_sdmap_slot_key(header, slot), (char *)slot + value_offset, user);
+		}
+		else
+		{
+			function(detail_sdmap_slot_key(header, slot), (char *)slot + value_offset);
+		}
+	}
+	if (slot->right != slot_index)
+	{
+		detail_sdimap_overlaps(header, slot_size, bound_size, value_offset, range, closed,
+			slot->right, function, function_ex, user);
+	}
+}
+
+SDMAP_API void detail_sdimap_overlaps_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *range,
+	int closed,
+	void (*function)(const void *key, void *value))
+{
+	if (header == NULL ||
+		header->count == 0)
+	{
+		return;
+	}
+	detail_sdimap_overlaps(header, slot_size, bound_size, value_offset, range, closed,
+		header->root_slot, function, NULL, NULL);
+}
+
+SDMAP_API void detail_sdimap_overlaps_ex_impl(
+	sdmap_header *header,
+	uint32_t slot_size,
+	uint32_t bound_size,
+	uint32_t value_offset,
+	const void *range,
+	int closed,
+	void (*function)(const void *key, void *value, void *user),
+	void *user)
+{
+	if (header == NULL ||
+		header->count == 0)
+	{
+		return;
+	}
+	detail_sdimap_overlaps(header, slot_size, bound_size, value_offset, range, closed,
+		header->root_slot, NULL, function, user);
+}
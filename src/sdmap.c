@@ -1,11 +1,23 @@
 #include <sdmap.h>
 
-#define detail_sdmap_slot(map, index) ((sdmap_slot *)((char *)(map) + sizeof(sdmap_header) + index * slot_size))
+#define detail_sdmap_slot(map, index) ((sdmap_slot *)((char *)(map) + sizeof(sdmap_header) + (index) * slot_size))
 
-#define detail_sdmap_value(map, index) ((void *)((char *)(map) + sizeof(sdmap_header) + index * slot_size + value_offset))
+#define detail_sdmap_value(map, index) ((void *)((char *)(map) + sizeof(sdmap_header) + (index) * slot_size + value_offset))
+
+#define detail_sdmap_slot_key(map, slot) ((void *)((char *)(slot) + (map)->key_offset))
+
+#define detail_sdmap_slot_value(map, slot) ((void *)((char *)(slot) + (map)->value_offset))
 
 #define detail_sdmap_heap_from_header(h) ((sdmap_heap *)((char *)((void *)(h)) - offsetof(sdmap_heap, header)))
 
+#define detail_sdmap_inline_storage(h) (&((sdmap_inline_header *)((void *)(h)))->storage)
+
+#if defined(__GNUC__)
+#define detail_sdmap_prefetch(address) __builtin_prefetch(address)
+#else
+#define detail_sdmap_prefetch(address) ((void)(address))
+#endif
+
 #define detail_sdmap_inorder_body(...)\
 	sdmap_slot *current;\
 	sdmap_slot *pre;\
@@ -148,13 +160,13 @@ SDMAP_API int detail_sdmap_check_key(
 	sdmap_slot *slot;
 	/*Check if key points to inside the object*/
 	if ((uintptr_t)key >= (uintptr_t)(header + 1) &&
-		(uintptr_t)key <= (uintptr_t)(((char *)header) + slot_size * header->slot_count))
+		(uintptr_t)key < (uintptr_t)(((char *)(header + 1)) + slot_size * header->slot_count))
 	{
-		if (((uintptr_t)key % (uintptr_t)slot_size) == sizeof(sdmap_slot))
+		if ((((uintptr_t)key - (uintptr_t)(header + 1)) % (uintptr_t)slot_size) == header->key_offset)
 		{
 			i = ((uintptr_t)key - (uintptr_t)(header + 1)) / (uintptr_t)slot_size;
 			slot = detail_sdmap_slot(header, i);
-			if (slot->height >= 0)
+			if (detail_sdmap_height(slot) >= 0)
 			{
 				*index = i;
 				return 1;
@@ -169,6 +181,40 @@ SDMAP_API int detail_sdmap_strcmp(const void *a, const void *b)
 	return strcmp(*((const char **)a), *((const char **)b));
 }
 
+SDMAP_API int detail_sdmap_pstrcmp(const void *a, const void *b)
+{
+	const sdmap_pstr *x = a;
+	const sdmap_pstr *y = b;
+	if (x->prefix != y->prefix)
+	{
+		return x->prefix < y->prefix ? -1 : 1;
+	}
+	/*Equal prefixes, if either string ends within them then it is a prefix of the other*/
+	if (x->length <= sizeof(x->prefix) || y->length <= sizeof(y->prefix))
+	{
+		return (x->length > y->length) - (x->length < y->length);
+	}
+	return strcmp(x->str + sizeof(x->prefix), y->str + sizeof(y->prefix));
+}
+
+SDMAP_API sdmap_pstr detail_sdmap_pstr_from_impl(const char *str)
+{
+	sdmap_pstr result;
+	size_t i;
+	result.prefix = 0;
+	result.length = strlen(str);
+	result.str = str;
+	for (i = 0; i < sizeof(result.prefix); i++)
+	{
+		result.prefix <<= 8;
+		if (i < result.length)
+		{
+			result.prefix |= (unsigned char)str[i];
+		}
+	}
+	return result;
+}
+
 SDMAP_API sdmap_index detail_sdmap_count_impl(sdmap_header *header)
 {
 	if (header)
@@ -191,26 +237,32 @@ SDMAP_API sdmap_index detail_sdmap_capacity_impl(
 
 SDMAP_API void detail_sdmap_new_heap_impl(
 	sdmap_header **header, 
-	sdmap_index capacity, 
-	int (*compare_func)(const void *, const void *))
+	size_t capacity, 
+	int (*compare_func)(const void *, const void *), 
+	uint32_t key_offset, 
+	uint32_t value_offset)
 {
 	sdmap_heap *heap;
 	heap = sdmap_malloc(sizeof(sdmap_heap) + capacity);
 	sdmap_assert(heap != NULL && "sdmap_malloc returned NULL");
-	detail_sdmap_new_stack_impl(&heap->header, compare_func);
+	detail_sdmap_new_stack_impl(&heap->header, compare_func, key_offset, value_offset);
 	heap->capacity = capacity;
 	*header = &(heap->header);
 }
 
 SDMAP_API void detail_sdmap_new_stack_impl(
 	sdmap_header *header, 
-	int (*compare_func)(const void *, const void *))
+	int (*compare_func)(const void *, const void *), 
+	uint32_t key_offset, 
+	uint32_t value_offset)
 {
 	header->count = 0;
 	header->slot_count = 0;
 	header->root_slot = (sdmap_index)-1;
 	header->empty_slot = (sdmap_index)-1;
 	header->compare_func = compare_func;
+	header->key_offset = key_offset;
+	header->value_offset = value_offset;
 }
 
 SDMAP_API void detail_sdmap_duplicate_heap_heap_impl(
@@ -233,16 +285,14 @@ SDMAP_API void detail_sdmap_duplicate_stack_heap_impl(
 	sdmap_header *header, 
 	sdmap_index dest_capacity, 
 	uint32_t slot_size, 
+	uint32_t key_offset, 
+	uint32_t value_offset, 
 	sdmap_header *source)
 {
 	(void)dest_capacity;
 	if (source == NULL)
 	{
-		header->count = 0;
-		header->slot_count = 0;
-		header->root_slot = (sdmap_index)-1;
-		header->empty_slot = (sdmap_index)-1;
-		header->compare_func = NULL;
+		detail_sdmap_new_stack_impl(header, NULL, key_offset, value_offset);
 		return;
 	}
 	sdmap_assert((dest_capacity <= source->slot_count) && "stack-type sdmap is too small.");
@@ -276,12 +326,14 @@ SDMAP_API void detail_sdmap_duplicate_stack_stack_impl(
 
 SDMAP_API sdmap_header **detail_sdmap_ensure_initialized_impl(
 	sdmap_header **header, 
-	sdmap_index capacity, 
-	int (*compare_func)(const void *, const void *))
+	size_t capacity, 
+	int (*compare_func)(const void *, const void *), 
+	uint32_t key_offset, 
+	uint32_t value_offset)
 {
 	if (*header == NULL)
 	{
-		detail_sdmap_new_heap_impl(header, capacity, compare_func);
+		detail_sdmap_new_heap_impl(header, capacity, compare_func, key_offset, value_offset);
 	}
 	else
 	{
@@ -316,7 +368,7 @@ SDMAP_API int detail_sdmap_contains_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			/*Bingo*/
@@ -358,7 +410,7 @@ SDMAP_API sdmap_index detail_sdmap_insert_heap(
 	const void *key)
 {
 	sdmap_heap *heap;
-	sdmap_index new_capacity;
+	size_t new_capacity;
 	sdmap_index slot_index;
 	sdmap_slot *slot;
 	if ((*header)->empty_slot != (sdmap_index)-1)
@@ -370,6 +422,7 @@ SDMAP_API sdmap_index detail_sdmap_insert_heap(
 	}
 	else
 	{
+		sdmap_assert(((*header)->slot_count < detail_sdmap_max_slot_count) && "sdmap_index can't address more slots");
 		(*header)->slot_count ++;
 		heap = detail_sdmap_heap_from_header(*header);
 		new_capacity = heap->capacity > 0 ? heap->capacity : slot_size * SDMAP_DEFAULT_CAPACITY;
@@ -390,8 +443,8 @@ SDMAP_API sdmap_index detail_sdmap_insert_heap(
 
 	slot->left = slot_index;
 	slot->right = slot_index;
-	slot->height = 0;
-	memcpy(slot + 1, key, key_size);
+	detail_sdmap_set_height(slot, 0);
+	memcpy(detail_sdmap_slot_key(*header, slot), key, key_size);
 	(*header)->count ++;
 	return slot_index;
 }
@@ -416,14 +469,15 @@ SDMAP_API sdmap_index detail_sdmap_insert_stack(
 	else
 	{
 		sdmap_assert((header->slot_count < capacity) && "sdmap_stack capacity exceeded");
+		sdmap_assert((header->slot_count < detail_sdmap_max_slot_count) && "sdmap_index can't address more slots");
 		header->slot_count ++;
 		slot_index = header->count;
 		slot = detail_sdmap_slot(header, slot_index);
 	}
 	slot->left = slot_index;
 	slot->right = slot_index;
-	slot->height = 0;
-	memcpy(slot + 1, key, key_size);
+	detail_sdmap_set_height(slot, 0);
+	memcpy(detail_sdmap_slot_key(header, slot), key, key_size);
 	header->count ++;
 	return slot_index;
 }
@@ -433,26 +487,26 @@ SDMAP_API void detail_sdmap_compute_height(
 	uint32_t slot_size, 
 	sdmap_index node)
 {
-	uint8_t temp;
+	int height = -1;
+	int temp;
 	sdmap_slot *slot = detail_sdmap_slot(header, node);
-	slot->height = -1;
 	if (slot->left != node)
 	{
-		temp = detail_sdmap_slot(header, slot->left)->height;
-		if (slot->height < temp)
+		temp = detail_sdmap_height(detail_sdmap_slot(header, slot->left));
+		if (height < temp)
 		{
-			slot->height = temp;
+			height = temp;
 		}
 	}
 	if (slot->right != node)
 	{
-		temp = detail_sdmap_slot(header, slot->right)->height;
-		if (slot->height < temp)
+		temp = detail_sdmap_height(detail_sdmap_slot(header, slot->right));
+		if (height < temp)
 		{
-			slot->height = temp;
+			height = temp;
 		}
 	}
-	slot->height++;
+	detail_sdmap_set_height(slot, height + 1);
 }
 
 SDMAP_API int detail_sdmap_compute_balance(
@@ -464,11 +518,11 @@ SDMAP_API int detail_sdmap_compute_balance(
 	sdmap_slot *slot = detail_sdmap_slot(header, node);
 	if (slot->left != node)
 	{
-		result -= 1 + detail_sdmap_slot(header, slot->left)->height;
+		result -= 1 + detail_sdmap_height(detail_sdmap_slot(header, slot->left));
 	}
 	if (slot->right != node)
 	{
-		result += 1 + detail_sdmap_slot(header, slot->right)->height;
+		result += 1 + detail_sdmap_height(detail_sdmap_slot(header, slot->right));
 	}
 	return result;
 }
@@ -494,8 +548,8 @@ SDMAP_API sdmap_index detail_sdmap_taller_child(
 	{
 		return node;
 	}
-	if (detail_sdmap_slot(header, slot->right)->height >
-		detail_sdmap_slot(header, slot->left)->height)
+	if (detail_sdmap_height(detail_sdmap_slot(header, slot->right)) >
+		detail_sdmap_height(detail_sdmap_slot(header, slot->left)))
 	{
 		return slot->right;
 	}
@@ -520,21 +574,21 @@ SDMAP_API void detail_sdmap_rotate_l_impl(
 	}
 	else
 	{
-		detail_sdmap_slot(header, q->left)->parent = node;
+		detail_sdmap_set_parent(detail_sdmap_slot(header, q->left), node);
 		p->right = q->left;
 	}
 	q->left = node;
 	detail_sdmap_compute_height(header, slot_size, node);
 	detail_sdmap_compute_height(header, slot_size, q_index);
-	q->parent = p->parent;
-	p->parent = q_index;
+	detail_sdmap_set_parent(q, detail_sdmap_parent(p));
+	detail_sdmap_set_parent(p, q_index);
 	if (node == header->root_slot)
 	{
 		header->root_slot = q_index;
 	}
 	else
 	{
-		q = detail_sdmap_slot(header, q->parent);
+		q = detail_sdmap_slot(header, detail_sdmap_parent(q));
 		if (q->right == node)
 		{
 			q->right = q_index;
@@ -561,21 +615,21 @@ SDMAP_API void detail_sdmap_rotate_r_impl(
 	}
 	else
 	{
-		detail_sdmap_slot(header, p->right)->parent = node;
+		detail_sdmap_set_parent(detail_sdmap_slot(header, p->right), node);
 		q->left = p->right;
 	}
 	p->right = node;
 	detail_sdmap_compute_height(header, slot_size, node);
 	detail_sdmap_compute_height(header, slot_size, p_index);
-	p->parent = q->parent;
-	q->parent = p_index;
+	detail_sdmap_set_parent(p, detail_sdmap_parent(q));
+	detail_sdmap_set_parent(q, p_index);
 	if (node == header->root_slot)
 	{
 		header->root_slot = p_index;
 	}
 	else
 	{
-		p = detail_sdmap_slot(header, p->parent);
+		p = detail_sdmap_slot(header, detail_sdmap_parent(p));
 		if (p->right == node)
 		{
 			p->right = p_index;
@@ -598,9 +652,9 @@ SDMAP_API void detail_sdmap_insert_rotate(
 	parent = at;
 	while (at != header->root_slot)
 	{
-		parent = detail_sdmap_slot(header, at)->parent;
-		detail_sdmap_compute_height(header, slot_size, parent);
+		parent = detail_sdmap_parent(detail_sdmap_slot(header, at));
 		detail_sdmap_compute_height(header, slot_size, at);
+		detail_sdmap_compute_height(header, slot_size, parent);
 		balance = detail_sdmap_compute_balance(header, slot_size, parent);
 		balance_child = detail_sdmap_compute_balance(header, slot_size, at);
 		if (balance > 1)
@@ -634,7 +688,7 @@ SDMAP_API void detail_sdmap_insert_rotate(
 	while (at != header->root_slot)
 	{
 		detail_sdmap_compute_height(header, slot_size, at);
-		at = detail_sdmap_slot(header, at)->parent;
+		at = detail_sdmap_parent(detail_sdmap_slot(header, at));
 	}
 }
 
@@ -649,7 +703,7 @@ SDMAP_API void detail_sdmap_erase_rotate(
 	sdmap_index y;
 	while (z != header->root_slot)
 	{
-		z = detail_sdmap_slot(header, z)->parent;
+		z = detail_sdmap_parent(detail_sdmap_slot(header, z));
 		if (z == (sdmap_index)-1)
 		{
 			break;
@@ -707,7 +761,7 @@ SDMAP_API void detail_sdmap_optimize_empty_slots(
 	for (i = 0; i < header->slot_count; i++)
 	{
 		slot = detail_sdmap_slot(header, i);
-		if (slot->height >= 0)
+		if (detail_sdmap_height(slot) >= 0)
 		{
 			continue;
 		}
@@ -737,7 +791,7 @@ SDMAP_API void detail_sdmap_optimize_reduce_slots(
 	for (i = header->count; i < header->slot_count; i++)
 	{
 		slot = detail_sdmap_slot(header, i);
-		if (slot->height < 0)
+		if (detail_sdmap_height(slot) < 0)
 		{
 			continue;
 		}
@@ -747,7 +801,7 @@ SDMAP_API void detail_sdmap_optimize_reduce_slots(
 		}
 		else
 		{
-			parent = detail_sdmap_slot(header, slot->parent);
+			parent = detail_sdmap_slot(header, detail_sdmap_parent(slot));
 			if (parent->left == i)
 			{
 				parent->left = header->empty_slot;
@@ -759,7 +813,7 @@ SDMAP_API void detail_sdmap_optimize_reduce_slots(
 		}
 		if (slot->right != i)
 		{
-			detail_sdmap_slot(header, slot->right)->parent = header->empty_slot;
+			detail_sdmap_set_parent(detail_sdmap_slot(header, slot->right), header->empty_slot);
 		}
 		else
 		{
@@ -767,7 +821,7 @@ SDMAP_API void detail_sdmap_optimize_reduce_slots(
 		}
 		if (slot->left != i)
 		{
-			detail_sdmap_slot(header, slot->left)->parent = header->empty_slot;
+			detail_sdmap_set_parent(detail_sdmap_slot(header, slot->left), header->empty_slot);
 		}
 		else
 		{
@@ -789,6 +843,142 @@ SDMAP_API void detail_sdmap_optimize_impl(
 	detail_sdmap_optimize_reduce_slots(header, slot_size);
 }
 
+SDMAP_API void detail_sdmap_veb_order(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node, 
+	int levels, 
+	sdmap_index *order, 
+	sdmap_index *position);
+
+SDMAP_API void detail_sdmap_veb_bottoms(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node, 
+	int depth, 
+	int levels, 
+	sdmap_index *order, 
+	sdmap_index *position)
+{
+	sdmap_slot *slot;
+	if (depth == 0)
+	{
+		detail_sdmap_veb_order(header, slot_size, node, levels, order, position);
+		return;
+	}
+	slot = detail_sdmap_slot(header, node);
+	if (slot->left != node)
+	{
+		detail_sdmap_veb_bottoms(header, slot_size, slot->left, depth - 1, levels, order, position);
+	}
+	if (slot->right != node)
+	{
+		detail_sdmap_veb_bottoms(header, slot_size, slot->right, depth - 1, levels, order, position);
+	}
+}
+
+SDMAP_API void detail_sdmap_veb_order(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node, 
+	int levels, 
+	sdmap_index *order, 
+	sdmap_index *position)
+{
+	int top;
+	if (levels == 1)
+	{
+		order[(*position)++] = node;
+		return;
+	}
+	/*Lay out the top half of the levels first, then every subtree hanging off of it.*/
+	top = levels / 2;
+	detail_sdmap_veb_order(header, slot_size, node, top, order, position);
+	detail_sdmap_veb_bottoms(header, slot_size, node, top, levels - top, order, position);
+}
+
+SDMAP_API void detail_sdmap_bfs_order(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index *order)
+{
+	sdmap_index head;
+	sdmap_index tail;
+	sdmap_slot *slot;
+	/*The order array doubles as the queue.*/
+	order[0] = header->root_slot;
+	head = 0;
+	tail = 1;
+	while (head < tail)
+	{
+		slot = detail_sdmap_slot(header, order[head]);
+		if (slot->left != order[head])
+		{
+			order[tail++] = slot->left;
+		}
+		if (slot->right != order[head])
+		{
+			order[tail++] = slot->right;
+		}
+		head++;
+	}
+}
+
+SDMAP_API void detail_sdmap_relayout_impl(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	int layout)
+{
+	sdmap_index i;
+	sdmap_index position;
+	sdmap_index *order;
+	sdmap_index *remap;
+	sdmap_slot *slot;
+	char *buffer;
+	if (header == NULL ||
+		header->count == 0 ||
+		layout == SDMAP_LAYOUT_NONE)
+	{
+		return;
+	}
+	detail_sdmap_optimize_impl(header, slot_size);
+	order = sdmap_malloc(sizeof(sdmap_index) * 2 * header->count);
+	sdmap_assert(order != NULL && "sdmap_malloc returned NULL");
+	buffer = sdmap_malloc(slot_size * header->count);
+	sdmap_assert(buffer != NULL && "sdmap_malloc returned NULL");
+	remap = order + header->count;
+	if (layout == SDMAP_LAYOUT_VEB)
+	{
+		position = 0;
+		detail_sdmap_veb_order(header, slot_size, header->root_slot,
+			detail_sdmap_height(detail_sdmap_slot(header, header->root_slot)) + 1, order, &position);
+	}
+	else
+	{
+		detail_sdmap_bfs_order(header, slot_size, order);
+	}
+	for (i = 0; i < header->count; i++)
+	{
+		remap[order[i]] = i;
+	}
+	/*Move the slots to their new places, a missing child points to the slot itself so remapping it works out.*/
+	for (i = 0; i < header->count; i++)
+	{
+		slot = (sdmap_slot *)(buffer + i * slot_size);
+		memcpy(slot, detail_sdmap_slot(header, order[i]), slot_size);
+		slot->left = remap[slot->left];
+		slot->right = remap[slot->right];
+		if (detail_sdmap_parent(slot) != (sdmap_index)-1)
+		{
+			detail_sdmap_set_parent(slot, remap[detail_sdmap_parent(slot)]);
+		}
+	}
+	memcpy(detail_sdmap_slot(header, 0), buffer, slot_size * header->count);
+	header->root_slot = 0;
+	sdmap_free(buffer);
+	sdmap_free(order);
+}
+
 SDMAP_API void detail_sdmap_shrink_impl(
 	sdmap_header **header, 
 	uint32_t slot_size)
@@ -799,6 +989,7 @@ SDMAP_API void detail_sdmap_shrink_impl(
 		return;
 	}
 	detail_sdmap_optimize_impl(*header, slot_size);
+	detail_sdmap_relayout_impl(*header, slot_size, SDMAP_SHRINK_LAYOUT);
 	heap = detail_sdmap_heap_from_header(*header);
 	if (heap->capacity > slot_size * (*header)->slot_count)
 	{
@@ -826,7 +1017,7 @@ SDMAP_API void *detail_sdmap_min_key_impl(
 		slot = detail_sdmap_slot(header, index);
 		if (slot->left == index)
 		{
-			return (char *)(slot + 1);
+			return detail_sdmap_slot_key(header, slot);
 		}
 		else
 		{
@@ -852,7 +1043,7 @@ SDMAP_API void *detail_sdmap_max_key_impl(
 		slot = detail_sdmap_slot(header, index);
 		if (slot->right == index)
 		{
-			return (char *)(slot + 1);
+			return detail_sdmap_slot_key(header, slot);
 		}
 		else
 		{
@@ -870,13 +1061,13 @@ SDMAP_API void *detail_sdmap_root_key_impl(
 	{
 		return NULL;
 	}
-	return (char *)(detail_sdmap_slot(header, header->root_slot) + 1);
+	return (char *)(detail_sdmap_slot_key(header, detail_sdmap_slot(header, header->root_slot)));
 }
 
 SDMAP_API sdmap_index detail_sdmap_min_in_subtree(
 	sdmap_header *header, 
 	uint32_t slot_size, 
-	uint32_t slot_index)
+	sdmap_index slot_index)
 {
 	sdmap_slot *slot;
 	while (1)
@@ -893,7 +1084,7 @@ SDMAP_API sdmap_index detail_sdmap_min_in_subtree(
 SDMAP_API sdmap_index detail_sdmap_max_in_subtree(
 	sdmap_header *header, 
 	uint32_t slot_size, 
-	uint32_t slot_index)
+	sdmap_index slot_index)
 {
 	sdmap_slot *slot;
 	while (1)
@@ -910,43 +1101,83 @@ SDMAP_API sdmap_index detail_sdmap_max_in_subtree(
 SDMAP_API sdmap_index detail_sdmap_left_parent(
 	sdmap_header *header, 
 	uint32_t slot_size, 
-	uint32_t slot_index)
+	sdmap_index slot_index)
 {
 	sdmap_slot *slot;
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		if (slot->parent == (sdmap_index)-1)
+		if (detail_sdmap_parent(slot) == (sdmap_index)-1)
 		{
 			return (sdmap_index)-1;
 		}
-		if (detail_sdmap_slot(header, slot->parent)->left == slot_index)
+		if (detail_sdmap_slot(header, detail_sdmap_parent(slot))->left == slot_index)
 		{
-			return slot->parent;
+			return detail_sdmap_parent(slot);
 		}
-		slot_index = slot->parent;
+		slot_index = detail_sdmap_parent(slot);
 	}
 }
 
 SDMAP_API sdmap_index detail_sdmap_right_parent(
 	sdmap_header *header, 
 	uint32_t slot_size, 
-	uint32_t slot_index)
+	sdmap_index slot_index)
 {
 	sdmap_slot *slot;
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		if (slot->parent == (sdmap_index)-1)
+		if (detail_sdmap_parent(slot) == (sdmap_index)-1)
 		{
 			return (sdmap_index)-1;
 		}
-		if (detail_sdmap_slot(header, slot->parent)->right == slot_index)
+		if (detail_sdmap_slot(header, detail_sdmap_parent(slot))->right == slot_index)
 		{
-			return slot->parent;
+			return detail_sdmap_parent(slot);
 		}
-		slot_index = slot->parent;
+		slot_index = detail_sdmap_parent(slot);
+	}
+}
+
+SDMAP_API sdmap_index detail_sdmap_next_slot(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index slot_index)
+{
+	sdmap_slot *slot = detail_sdmap_slot(header, slot_index);
+	if (slot->right != slot_index)
+	{
+		return detail_sdmap_min_in_subtree(header, slot_size, slot->right);
+	}
+	return detail_sdmap_left_parent(header, slot_size, slot_index);
+}
+
+SDMAP_API sdmap_index detail_sdmap_build_sorted(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index first, 
+	sdmap_index last, 
+	sdmap_index parent)
+{
+	sdmap_index middle;
+	sdmap_slot *slot;
+	/*Slots [first, last) hold keys in ascending order, link them into a perfectly balanced tree.*/
+	middle = first + (last - first) / 2;
+	slot = detail_sdmap_slot(header, middle);
+	detail_sdmap_set_parent(slot, parent);
+	slot->left = middle;
+	slot->right = middle;
+	if (first < middle)
+	{
+		slot->left = detail_sdmap_build_sorted(header, slot_size, first, middle, middle);
+	}
+	if (middle + 1 < last)
+	{
+		slot->right = detail_sdmap_build_sorted(header, slot_size, middle + 1, last, middle);
 	}
+	detail_sdmap_compute_height(header, slot_size, middle);
+	return middle;
 }
 
 SDMAP_API void *detail_sdmap_next_key_impl(
@@ -972,19 +1203,19 @@ SDMAP_API void *detail_sdmap_next_key_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
 			if (slot->right != slot_index)
 			{
 				slot_index = detail_sdmap_min_in_subtree(header, slot_size, slot->right);
-				return detail_sdmap_slot(header, slot_index) + 1;
+				return detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
 			}
 			slot_index = detail_sdmap_left_parent(header, slot_size, slot_index);
 			if (slot_index != (sdmap_index)-1)
 			{
-				return detail_sdmap_slot(header, slot_index) + 1;
+				return detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
 			}
 			return NULL;
 		}
@@ -1031,19 +1262,19 @@ SDMAP_API void *detail_sdmap_prev_key_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
 			if (slot->left != slot_index)
 			{
 				slot_index = detail_sdmap_max_in_subtree(header, slot_size, slot->left);
-				return detail_sdmap_slot(header, slot_index) + 1;
+				return detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
 			}
 			slot_index = detail_sdmap_right_parent(header, slot_size, slot_index);
 			if (slot_index != (sdmap_index)-1)
 			{
-				return detail_sdmap_slot(header, slot_index) + 1;
+				return detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
 			}
 			return NULL;
 		}
@@ -1090,7 +1321,7 @@ SDMAP_API void *detail_sdmap_getp_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
@@ -1115,6 +1346,82 @@ SDMAP_API void *detail_sdmap_getp_impl(
 	}
 }
 
+SDMAP_API void detail_sdmap_getp_many_impl(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_offset, 
+	const void *keys, 
+	size_t count, 
+	void **out)
+{
+	int compare_result;
+	int lane;
+	int lane_count;
+	size_t next;
+	size_t which[SDMAP_GETP_MANY_LANES];
+	sdmap_index slot_index[SDMAP_GETP_MANY_LANES];
+	sdmap_index child;
+	sdmap_slot *slot;
+	if (header == NULL ||
+		header->count == 0 ||
+		header->compare_func == NULL)
+	{
+		for (next = 0; next < count; next++)
+		{
+			out[next] = NULL;
+		}
+		return;
+	}
+	/*Every lane descends for its own key, one step per round, so the cache
+	misses of different lanes overlap instead of following each other*/
+	lane_count = 0;
+	for (next = 0; next < count && lane_count < SDMAP_GETP_MANY_LANES; next++)
+	{
+		which[lane_count] = next;
+		slot_index[lane_count] = header->root_slot;
+		lane_count++;
+	}
+	lane = 0;
+	while (lane_count > 0)
+	{
+		if (lane >= lane_count)
+		{
+			lane = 0;
+		}
+		slot = detail_sdmap_slot(header, slot_index[lane]);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), (const char *)keys + which[lane] * key_size);
+		if (compare_result != 0)
+		{
+			child = compare_result > 0 ? slot->left : slot->right;
+			if (child != slot_index[lane])
+			{
+				slot_index[lane] = child;
+				detail_sdmap_prefetch(detail_sdmap_slot(header, child));
+				lane++;
+				continue;
+			}
+			out[which[lane]] = NULL;
+		}
+		else
+		{
+			out[which[lane]] = detail_sdmap_value(header, slot_index[lane]);
+		}
+		/*The lane is done, give it the next key or retire it*/
+		if (next < count)
+		{
+			which[lane] = next++;
+			slot_index[lane] = header->root_slot;
+		}
+		else
+		{
+			lane_count--;
+			which[lane] = which[lane_count];
+			slot_index[lane] = slot_index[lane_count];
+		}
+	}
+}
+
 SDMAP_API void *detail_sdmap_set_heap_empty(
 	sdmap_header **header, 
 	uint32_t slot_size, 
@@ -1123,7 +1430,7 @@ SDMAP_API void *detail_sdmap_set_heap_empty(
 {
 	sdmap_heap *heap;
 	sdmap_slot *slot;
-	sdmap_index new_capacity;
+	size_t new_capacity;
 	heap = detail_sdmap_heap_from_header(*header);
 	new_capacity = heap->capacity > 0 ? heap->capacity : slot_size * SDMAP_DEFAULT_CAPACITY;
 	while (new_capacity < slot_size * ((*header)->slot_count + 1))
@@ -1140,14 +1447,37 @@ SDMAP_API void *detail_sdmap_set_heap_empty(
 	slot = detail_sdmap_slot((*header), 0);
 	slot->left = 0;
 	slot->right = 0;
-	slot->height = 0;
-	slot->parent = (sdmap_index)-1;
-	memcpy(((char *)(slot + 1)), key, key_size);
+	detail_sdmap_set_height(slot, 0);
+	detail_sdmap_set_parent(slot, (sdmap_index)-1);
+	memcpy(detail_sdmap_slot_key(*header, slot), key, key_size);
 	(*header)->root_slot = 0;
 	(*header)->count ++;
 	(*header)->slot_count ++;
 	(*header)->empty_slot = (sdmap_index)-1;
-	return ((char *)(slot + 1)) + key_size;
+	return detail_sdmap_slot_value(*header, slot);
+}
+
+SDMAP_API void *detail_sdmap_attach_heap_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	const void *key, 
+	sdmap_index parent, 
+	int compare_result)
+{
+	sdmap_index new_index;
+	new_index = detail_sdmap_insert_heap(header, slot_size, key_size, key);
+	if (compare_result > 0)
+	{
+		detail_sdmap_slot((*header), parent)->left = new_index;
+	}
+	else
+	{
+		detail_sdmap_slot((*header), parent)->right = new_index;
+	}
+	detail_sdmap_set_parent(detail_sdmap_slot((*header), new_index), parent);
+	detail_sdmap_insert_rotate(*header, slot_size, parent);
+	return detail_sdmap_slot_value((*header), detail_sdmap_slot((*header), new_index));
 }
 
 SDMAP_API void *detail_sdmap_set_heap_impl(
@@ -1157,7 +1487,6 @@ SDMAP_API void *detail_sdmap_set_heap_impl(
 	const void *key)
 {
 	int compare_result;
-	sdmap_index new_index;
 	sdmap_index slot_index;
 	sdmap_slot *slot;
 
@@ -1180,28 +1509,17 @@ SDMAP_API void *detail_sdmap_set_heap_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot((*header), slot_index);
-		compare_result = (*header)->compare_func(slot + 1, key);
+		compare_result = (*header)->compare_func(detail_sdmap_slot_key(*header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
-			return ((char *)(slot + 1)) + key_size;
+			return detail_sdmap_slot_value(*header, slot);
 		}
 		else if (
 			(compare_result > 0 && slot->left == slot_index) ||
 			(compare_result < 0 && slot->right == slot_index))
 		{
-			new_index = detail_sdmap_insert_heap(header, slot_size, key_size, key);
-			if (compare_result > 0)
-			{
-				detail_sdmap_slot((*header), slot_index)->left = new_index;
-			}
-			else
-			{
-				detail_sdmap_slot((*header), slot_index)->right = new_index;
-			}
-			detail_sdmap_slot((*header), new_index)->parent = slot_index;
-			detail_sdmap_insert_rotate(*header, slot_size, slot_index);
-			return ((char *)(detail_sdmap_slot((*header), new_index) + 1)) + key_size;
+			return detail_sdmap_attach_heap_impl(header, slot_size, key_size, key, slot_index, compare_result);
 		}
 		else if (compare_result > 0)
 		{
@@ -1243,23 +1561,24 @@ SDMAP_API void *detail_sdmap_set_stack_impl(
 		slot = detail_sdmap_slot(header, 0);
 		slot->left = 0;
 		slot->right = 0;
-		slot->height = 0;
-		memcpy(((char *)(slot + 1)), key, key_size);
+		detail_sdmap_set_height(slot, 0);
+		detail_sdmap_set_parent(slot, (sdmap_index)-1);
+		memcpy(detail_sdmap_slot_key(header, slot), key, key_size);
 		header->count ++;
 		header->slot_count ++;
 		header->empty_slot = (sdmap_index)-1;
 		header->root_slot = 0;
-		return ((char *)(slot + 1)) + key_size;
+		return detail_sdmap_slot_value(header, slot);
 	}
 	slot_index = header->root_slot;
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
-			return ((char *)(slot + 1)) + key_size;
+			return detail_sdmap_slot_value(header, slot);
 		}
 		else if (
 			(compare_result > 0 && slot->left == slot_index) ||
@@ -1274,9 +1593,9 @@ SDMAP_API void *detail_sdmap_set_stack_impl(
 			{
 				detail_sdmap_slot(header, slot_index)->right = new_index;
 			}
-			detail_sdmap_slot(header, new_index)->parent = slot_index;
+			detail_sdmap_set_parent(detail_sdmap_slot(header, new_index), slot_index);
 			detail_sdmap_insert_rotate(header, slot_size, new_index);
-			return ((char *)(detail_sdmap_slot(header, new_index) + 1)) + key_size;
+			return detail_sdmap_slot_value(header, detail_sdmap_slot(header, new_index));
 		}
 		else if (compare_result > 0)
 		{
@@ -1314,7 +1633,7 @@ SDMAP_API void detail_sdmap_erase_impl(
 	while (1)
 	{
 		slot = detail_sdmap_slot(header, slot_index);
-		compare_result = header->compare_func(slot + 1, key);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
 		if (compare_result == 0)
 		{
 			found:;
@@ -1330,10 +1649,10 @@ SDMAP_API void detail_sdmap_erase_impl(
 				/*Our target node has two children.*/
 				slot_index = detail_sdmap_min_in_subtree(header, slot_size, slot->right);
 				/*Copy key and value from successor.*/
-				memcpy(slot + 1, detail_sdmap_slot(header, slot_index) + 1, slot_size - sizeof(sdmap_slot));
+				memcpy(detail_sdmap_slot_key(header, slot), detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index)), slot_size - header->key_offset);
 
 				slot_original = detail_sdmap_slot(header, slot_index);
-				slot = detail_sdmap_slot(header, slot_original->parent);
+				slot = detail_sdmap_slot(header, detail_sdmap_parent(slot_original));
 
 				if (slot_original->right != slot_index)
 				{
@@ -1343,12 +1662,12 @@ SDMAP_API void detail_sdmap_erase_impl(
 					if (slot->left == slot_index)
 					{
 						slot->left = slot_original->right;
-						detail_sdmap_slot(header, slot_original->right)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot_original->right), detail_sdmap_parent(slot_original));
 					}
 					else
 					{
 						slot->right = slot_original->right;
-						detail_sdmap_slot(header, slot_original->right)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot_original->right), detail_sdmap_parent(slot_original));
 					}
 				}
 				else
@@ -1356,28 +1675,28 @@ SDMAP_API void detail_sdmap_erase_impl(
 					/*In case the successor is a leaf. Reassign pointers.*/
 					if (slot->left == slot_index)
 					{
-						slot->left = slot_original->parent;
+						slot->left = detail_sdmap_parent(slot_original);
 					}
 					else
 					{
-						slot->right = slot_original->parent;
+						slot->right = detail_sdmap_parent(slot_original);
 					}
 				}
 			}
-			else if (slot->parent == (sdmap_index)-1)
+			else if (detail_sdmap_parent(slot) == (sdmap_index)-1)
 			{
 				/*We are deleting the root node.*/
 				if (slot->left != slot_index)
 				{
 					/*Node has one child on the left.*/
 					header->root_slot = slot->left;
-					detail_sdmap_slot(header, slot->left)->parent = (sdmap_index)-1;
+					detail_sdmap_set_parent(detail_sdmap_slot(header, slot->left), (sdmap_index)-1);
 				}
 				else if (slot->right != slot_index)
 				{
 					/*Node has one child on the right.*/
 					header->root_slot = slot->right;
-					detail_sdmap_slot(header, slot->right)->parent = (sdmap_index)-1;
+					detail_sdmap_set_parent(detail_sdmap_slot(header, slot->right), (sdmap_index)-1);
 				}
 				else
 				{
@@ -1388,19 +1707,19 @@ SDMAP_API void detail_sdmap_erase_impl(
 			else
 			{
 				/*The node we are looking at has up to one child, reassign pointers.*/
-				slot = detail_sdmap_slot(header, slot_original->parent);
+				slot = detail_sdmap_slot(header, detail_sdmap_parent(slot_original));
 				if (slot_original->left != slot_index)
 				{
 					/*The child is on the left.*/
 					if (slot->left == slot_index)
 					{
 						slot->left = slot_original->left;
-						detail_sdmap_slot(header, slot->left)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot->left), detail_sdmap_parent(slot_original));
 					}
 					else
 					{
 						slot->right = slot_original->left;
-						detail_sdmap_slot(header, slot->right)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot->right), detail_sdmap_parent(slot_original));
 					}
 				}
 				else if (slot_original->right != slot_index)
@@ -1409,12 +1728,12 @@ SDMAP_API void detail_sdmap_erase_impl(
 					if (slot->left == slot_index)
 					{
 						slot->left = slot_original->right;
-						detail_sdmap_slot(header, slot->left)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot->left), detail_sdmap_parent(slot_original));
 					}
 					else
 					{
 						slot->right = slot_original->right;
-						detail_sdmap_slot(header, slot->right)->parent = slot_original->parent;
+						detail_sdmap_set_parent(detail_sdmap_slot(header, slot->right), detail_sdmap_parent(slot_original));
 					}
 				}
 				else
@@ -1423,11 +1742,11 @@ SDMAP_API void detail_sdmap_erase_impl(
 					/*The node we are looking at has no children and is not the root node*/
 					if (slot->left == slot_index)
 					{
-						slot->left = slot_original->parent;
+						slot->left = detail_sdmap_parent(slot_original);
 					}
 					else
 					{
-						slot->right = slot_original->parent;
+						slot->right = detail_sdmap_parent(slot_original);
 					}
 				}
 			}
@@ -1440,13 +1759,13 @@ SDMAP_API void detail_sdmap_erase_impl(
 				slot_index > header->empty_slot)
 			{
 				slot_original->right = detail_sdmap_slot(header, header->empty_slot)->right;
-				slot_original->height = -1;
+				detail_sdmap_set_height(slot_original, -1);
 				detail_sdmap_slot(header, header->empty_slot)->right = slot_index;
 			}
 			else
 			{
 				slot_original->right = header->empty_slot;
-				slot_original->height = -1;
+				detail_sdmap_set_height(slot_original, -1);
 				header->empty_slot = slot_index;
 			}
 			header->count--;
@@ -1481,6 +1800,1611 @@ SDMAP_API void detail_sdmap_erase_impl(
 	}
 }
 
+SDMAP_API sdmap_index detail_sdmap_combine_slots(
+	sdmap_header *result, 
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	uint32_t value_offset, 
+	sdmap_header *source, 
+	int operation, 
+	void (*conflict_func)(const void *, void *, const void *))
+{
+	int compare_result;
+	sdmap_index count;
+	sdmap_index index_a;
+	sdmap_index index_b;
+	sdmap_slot *slot;
+	int (*compare_func)(const void *, const void *);
+	compare_func = header->compare_func ? header->compare_func : source->compare_func;
+	index_a = header->count ? 
+		detail_sdmap_min_in_subtree(header, slot_size, header->root_slot) : (sdmap_index)-1;
+	index_b = source->count ? 
+		detail_sdmap_min_in_subtree(source, slot_size, source->root_slot) : (sdmap_index)-1;
+	count = 0;
+	/*Walk both maps in order, the output slots end up sorted*/
+	while (index_a != (sdmap_index)-1 || 
+		(index_b != (sdmap_index)-1 && operation == detail_sdmap_combine_merge))
+	{
+		if (index_a == (sdmap_index)-1)
+		{
+			compare_result = 1;
+		}
+		else if (index_b == (sdmap_index)-1)
+		{
+			compare_result = -1;
+		}
+		else
+		{
+			compare_result = compare_func(
+				detail_sdmap_slot_key(header, detail_sdmap_slot(header, index_a)), 
+				detail_sdmap_slot_key(source, detail_sdmap_slot(source, index_b)));
+		}
+		slot = detail_sdmap_slot(result, count);
+		if (compare_result < 0)
+		{
+			if (operation != detail_sdmap_combine_intersect)
+			{
+				memcpy(detail_sdmap_slot_key(header, slot), detail_sdmap_slot_key(header, detail_sdmap_slot(header, index_a)), slot_size - header->key_offset);
+				count++;
+			}
+			index_a = detail_sdmap_next_slot(header, slot_size, index_a);
+			continue;
+		}
+		if (compare_result > 0)
+		{
+			if (operation == detail_sdmap_combine_merge)
+			{
+				memcpy(detail_sdmap_slot_key(source, slot), detail_sdmap_slot_key(source, detail_sdmap_slot(source, index_b)), slot_size - source->key_offset);
+				count++;
+			}
+			index_b = detail_sdmap_next_slot(source, slot_size, index_b);
+			continue;
+		}
+		if (operation != detail_sdmap_combine_difference)
+		{
+			memcpy(detail_sdmap_slot_key(header, slot), detail_sdmap_slot_key(header, detail_sdmap_slot(header, index_a)), slot_size - header->key_offset);
+			if (operation == detail_sdmap_combine_merge)
+			{
+				if (conflict_func)
+				{
+					conflict_func(detail_sdmap_slot_key(result, slot), 
+						detail_sdmap_value(result, count), 
+						detail_sdmap_value(source, index_b));
+				}
+				else
+				{
+					memcpy(detail_sdmap_value(result, count), 
+						detail_sdmap_value(source, index_b), 
+						slot_size - value_offset);
+				}
+			}
+			count++;
+		}
+		index_a = detail_sdmap_next_slot(header, slot_size, index_a);
+		index_b = detail_sdmap_next_slot(source, slot_size, index_b);
+	}
+	result->count = count;
+	result->slot_count = count;
+	result->root_slot = (sdmap_index)-1;
+	result->empty_slot = (sdmap_index)-1;
+	result->compare_func = compare_func;
+	if (count)
+	{
+		result->root_slot = detail_sdmap_build_sorted(result, slot_size, 0, count, (sdmap_index)-1);
+	}
+	return count;
+}
+
+SDMAP_API void detail_sdmap_combine_heap_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t value_offset, 
+	sdmap_header *source, 
+	int operation, 
+	void (*conflict_func)(const void *, void *, const void *))
+{
+	sdmap_index capacity;
+	sdmap_header *result;
+	sdmap_header empty;
+	if (source == NULL || source->count == 0)
+	{
+		if (operation == detail_sdmap_combine_intersect && *header != NULL)
+		{
+			detail_sdmap_new_stack_impl(*header, (*header)->compare_func, (*header)->key_offset, (*header)->value_offset);
+		}
+		return;
+	}
+	if (*header == NULL)
+	{
+		if (operation != detail_sdmap_combine_merge)
+		{
+			return;
+		}
+		detail_sdmap_new_stack_impl(&empty, source->compare_func, source->key_offset, source->value_offset);
+		*header = &empty;
+	}
+	capacity = (*header)->count;
+	if (operation == detail_sdmap_combine_merge)
+	{
+		capacity += source->count;
+	}
+	detail_sdmap_new_heap_impl(&result, capacity * slot_size, NULL, (*header)->key_offset, (*header)->value_offset);
+	detail_sdmap_combine_slots(result, *header, slot_size, value_offset, source, operation, conflict_func);
+	if (*header != &empty)
+	{
+		detail_sdmap_delete_impl(header);
+	}
+	*header = result;
+}
+
+SDMAP_API void detail_sdmap_combine_stack_impl(
+	sdmap_header *header, 
+	sdmap_index capacity, 
+	uint32_t slot_size, 
+	uint32_t value_offset, 
+	sdmap_header *source, 
+	int operation, 
+	void (*conflict_func)(const void *, void *, const void *))
+{
+	sdmap_header *result;
+	if (source == NULL || source->count == 0)
+	{
+		if (operation == detail_sdmap_combine_intersect)
+		{
+			detail_sdmap_new_stack_impl(header, header->compare_func, header->key_offset, header->value_offset);
+		}
+		return;
+	}
+	detail_sdmap_new_heap_impl(&result, (header->count + source->count) * slot_size, NULL, header->key_offset, header->value_offset);
+	detail_sdmap_combine_slots(result, header, slot_size, value_offset, source, operation, conflict_func);
+	sdmap_assert((result->count <= capacity) && "stack-type sdmap is too small.");
+	memcpy(header, result, sizeof(sdmap_header) + result->count * slot_size);
+	detail_sdmap_delete_impl(&result);
+}
+
+/*While the elements are in storage the object keeps NULL instead of a pointer to itself, the real header is attached on entry*/
+SDMAP_API void detail_sdmap_inline_attach(sdmap_header **header)
+{
+	if (*header == NULL)
+	{
+		*header = &detail_sdmap_inline_storage(header)->header;
+	}
+}
+
+/*Put NULL back if the elements ended up in storage*/
+SDMAP_API void detail_sdmap_inline_detach(sdmap_header **header)
+{
+	if (*header == &detail_sdmap_inline_storage(header)->header)
+	{
+		*header = NULL;
+	}
+}
+
+SDMAP_API void detail_sdmap_new_inline_impl(
+	sdmap_header **header, 
+	size_t capacity, 
+	int (*compare_func)(const void *, const void *), 
+	uint32_t key_offset, 
+	uint32_t value_offset)
+{
+	sdmap_heap *storage = detail_sdmap_inline_storage(header);
+	detail_sdmap_new_stack_impl(&storage->header, compare_func, key_offset, value_offset);
+	storage->capacity = capacity;
+	*header = NULL;
+}
+
+/*Make block the active header, it is moved into the inline storage if it fits there*/
+SDMAP_API void detail_sdmap_inline_adopt(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	sdmap_header *block)
+{
+	sdmap_heap *storage = detail_sdmap_inline_storage(header);
+	if (block->slot_count * slot_size <= storage->capacity)
+	{
+		memcpy(&storage->header, block, sizeof(sdmap_header) + block->slot_count * slot_size);
+		detail_sdmap_delete_impl(&block);
+		block = NULL;
+	}
+	*header = block;
+}
+
+SDMAP_API void detail_sdmap_reserve_inline_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	size_t capacity)
+{
+	sdmap_header *block;
+	detail_sdmap_inline_attach(header);
+	if (capacity <= detail_sdmap_heap_from_header(*header)->capacity)
+	{
+		detail_sdmap_inline_detach(header);
+		return;
+	}
+	detail_sdmap_new_heap_impl(&block, capacity, NULL, (*header)->key_offset, (*header)->value_offset);
+	memcpy(block, *header, sizeof(sdmap_header) + (*header)->slot_count * slot_size);
+	if (*header != &detail_sdmap_inline_storage(header)->header)
+	{
+		detail_sdmap_delete_impl(header);
+	}
+	*header = block;
+}
+
+SDMAP_API void detail_sdmap_duplicate_inline_impl(
+	sdmap_header **header, 
+	size_t capacity, 
+	uint32_t slot_size, 
+	uint32_t key_offset, 
+	uint32_t value_offset, 
+	sdmap_header *source)
+{
+	sdmap_header *block;
+	/*The destination may not be constructed, so nothing is read from it*/
+	detail_sdmap_new_inline_impl(header, capacity, NULL, key_offset, value_offset);
+	if (source == NULL)
+	{
+		return;
+	}
+	detail_sdmap_new_heap_impl(&block, source->slot_count * slot_size, NULL, key_offset, value_offset);
+	memcpy(block, source, sizeof(sdmap_header) + source->slot_count * slot_size);
+	detail_sdmap_inline_adopt(header, slot_size, block);
+}
+
+SDMAP_API void *detail_sdmap_set_inline_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	const void *key)
+{
+	sdmap_heap *storage = detail_sdmap_inline_storage(header);
+	void *result;
+	detail_sdmap_inline_attach(header);
+	/*Move to the heap before the heap-type functions would try to grow the storage*/
+	if (*header == &storage->header &&
+		(*header)->empty_slot == (sdmap_index)-1 &&
+		((*header)->slot_count + 1) * slot_size > storage->capacity &&
+		!detail_sdmap_contains_impl(*header, slot_size, key))
+	{
+		detail_sdmap_reserve_inline_impl(header, slot_size,
+			storage->capacity > 0 ? storage->capacity * 2 : slot_size * SDMAP_DEFAULT_CAPACITY);
+	}
+	result = detail_sdmap_set_heap_impl(header, slot_size, key_size, key);
+	detail_sdmap_inline_detach(header);
+	return result;
+}
+
+SDMAP_API void detail_sdmap_shrink_inline_impl(
+	sdmap_header **header, 
+	uint32_t slot_size)
+{
+	if (*header == NULL)
+	{
+		return;
+	}
+	detail_sdmap_shrink_impl(header, slot_size);
+	detail_sdmap_inline_adopt(header, slot_size, *header);
+}
+
+SDMAP_API void detail_sdmap_combine_inline_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t value_offset, 
+	sdmap_header *source, 
+	int operation, 
+	void (*conflict_func)(const void *, void *, const void *))
+{
+	sdmap_index capacity;
+	sdmap_header *result;
+	detail_sdmap_inline_attach(header);
+	if (source == NULL || source->count == 0)
+	{
+		if (operation == detail_sdmap_combine_intersect)
+		{
+			detail_sdmap_new_stack_impl(*header, (*header)->compare_func, (*header)->key_offset, (*header)->value_offset);
+		}
+		detail_sdmap_inline_detach(header);
+		return;
+	}
+	capacity = (*header)->count;
+	if (operation == detail_sdmap_combine_merge)
+	{
+		capacity += source->count;
+	}
+	detail_sdmap_new_heap_impl(&result, capacity * slot_size, NULL, (*header)->key_offset, (*header)->value_offset);
+	detail_sdmap_combine_slots(result, *header, slot_size, value_offset, source, operation, conflict_func);
+	if (*header != &detail_sdmap_inline_storage(header)->header)
+	{
+		detail_sdmap_delete_impl(header);
+	}
+	detail_sdmap_inline_adopt(header, slot_size, result);
+}
+
+SDMAP_API void detail_sdmap_delete_inline_impl(sdmap_header **header)
+{
+	sdmap_heap *storage = detail_sdmap_inline_storage(header);
+	sdmap_header active;
+	detail_sdmap_inline_attach(header);
+	active = **header;
+	if (*header != &storage->header)
+	{
+		detail_sdmap_delete_impl(header);
+	}
+	detail_sdmap_new_inline_impl(header, storage->capacity, active.compare_func, active.key_offset, active.value_offset);
+}
+
+/*
+ *	The helpers below work on detached subtrees that share one slot array,
+ *	(sdmap_index)-1 stands for an empty tree. Parent links are kept up to
+ *	date for every node except the root which the caller has to fix up.
+ */
+SDMAP_API int detail_sdmap_tree_height(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index tree)
+{
+	if (tree == (sdmap_index)-1)
+	{
+		return -1;
+	}
+	return detail_sdmap_height(detail_sdmap_slot(header, tree));
+}
+
+SDMAP_API sdmap_index detail_sdmap_tree_left(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node)
+{
+	sdmap_slot *slot = detail_sdmap_slot(header, node);
+	return slot->left == node ? (sdmap_index)-1 : slot->left;
+}
+
+SDMAP_API sdmap_index detail_sdmap_tree_right(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node)
+{
+	sdmap_slot *slot = detail_sdmap_slot(header, node);
+	return slot->right == node ? (sdmap_index)-1 : slot->right;
+}
+
+SDMAP_API sdmap_index detail_sdmap_tree_node(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index left, 
+	sdmap_index node, 
+	sdmap_index right)
+{
+	sdmap_slot *slot = detail_sdmap_slot(header, node);
+	slot->left = node;
+	slot->right = node;
+	detail_sdmap_set_parent(slot, (sdmap_index)-1);
+	if (left != (sdmap_index)-1)
+	{
+		slot->left = left;
+		detail_sdmap_set_parent(detail_sdmap_slot(header, left), node);
+	}
+	if (right != (sdmap_index)-1)
+	{
+		slot->right = right;
+		detail_sdmap_set_parent(detail_sdmap_slot(header, right), node);
+	}
+	detail_sdmap_compute_height(header, slot_size, node);
+	return node;
+}
+
+SDMAP_API sdmap_index detail_sdmap_tree_rotate_l(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node)
+{
+	sdmap_index left = detail_sdmap_tree_left(header, slot_size, node);
+	sdmap_index right = detail_sdmap_tree_right(header, slot_size, node);
+	sdmap_index right_left = detail_sdmap_tree_left(header, slot_size, right);
+	sdmap_index right_right = detail_sdmap_tree_right(header, slot_size, right);
+	detail_sdmap_tree_node(header, slot_size, left, node, right_left);
+	return detail_sdmap_tree_node(header, slot_size, node, right, right_right);
+}
+
+SDMAP_API sdmap_index detail_sdmap_tree_rotate_r(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index node)
+{
+	sdmap_index left = detail_sdmap_tree_left(header, slot_size, node);
+	sdmap_index right = detail_sdmap_tree_right(header, slot_size, node);
+	sdmap_index left_left = detail_sdmap_tree_left(header, slot_size, left);
+	sdmap_index left_right = detail_sdmap_tree_right(header, slot_size, left);
+	detail_sdmap_tree_node(header, slot_size, left_right, node, right);
+	return detail_sdmap_tree_node(header, slot_size, left_left, left, node);
+}
+
+/*Join when the left tree is taller, descend along its right spine*/
+SDMAP_API sdmap_index detail_sdmap_tree_join_r(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index left, 
+	sdmap_index node, 
+	sdmap_index right)
+{
+	sdmap_index outer = detail_sdmap_tree_left(header, slot_size, left);
+	sdmap_index inner = detail_sdmap_tree_right(header, slot_size, left);
+	sdmap_index tree;
+	if (detail_sdmap_tree_height(header, slot_size, inner) <= 
+		detail_sdmap_tree_height(header, slot_size, right) + 1)
+	{
+		tree = detail_sdmap_tree_node(header, slot_size, inner, node, right);
+		if (detail_sdmap_tree_height(header, slot_size, tree) <= 
+			detail_sdmap_tree_height(header, slot_size, outer) + 1)
+		{
+			return detail_sdmap_tree_node(header, slot_size, outer, left, tree);
+		}
+		tree = detail_sdmap_tree_rotate_r(header, slot_size, tree);
+		tree = detail_sdmap_tree_node(header, slot_size, outer, left, tree);
+		return detail_sdmap_tree_rotate_l(header, slot_size, tree);
+	}
+	tree = detail_sdmap_tree_join_r(header, slot_size, inner, node, right);
+	if (detail_sdmap_tree_height(header, slot_size, tree) <= 
+		detail_sdmap_tree_height(header, slot_size, outer) + 1)
+	{
+		return detail_sdmap_tree_node(header, slot_size, outer, left, tree);
+	}
+	tree = detail_sdmap_tree_node(header, slot_size, outer, left, tree);
+	return detail_sdmap_tree_rotate_l(header, slot_size, tree);
+}
+
+/*Join when the right tree is taller, descend along its left spine*/
+SDMAP_API sdmap_index detail_sdmap_tree_join_l(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index left, 
+	sdmap_index node, 
+	sdmap_index right)
+{
+	sdmap_index outer = detail_sdmap_tree_right(header, slot_size, right);
+	sdmap_index inner = detail_sdmap_tree_left(header, slot_size, right);
+	sdmap_index tree;
+	if (detail_sdmap_tree_height(header, slot_size, inner) <= 
+		detail_sdmap_tree_height(header, slot_size, left) + 1)
+	{
+		tree = detail_sdmap_tree_node(header, slot_size, left, node, inner);
+		if (detail_sdmap_tree_height(header, slot_size, tree) <= 
+			detail_sdmap_tree_height(header, slot_size, outer) + 1)
+		{
+			return detail_sdmap_tree_node(header, slot_size, tree, right, outer);
+		}
+		tree = detail_sdmap_tree_rotate_l(header, slot_size, tree);
+		tree = detail_sdmap_tree_node(header, slot_size, tree, right, outer);
+		return detail_sdmap_tree_rotate_r(header, slot_size, tree);
+	}
+	tree = detail_sdmap_tree_join_l(header, slot_size, left, node, inner);
+	if (detail_sdmap_tree_height(header, slot_size, tree) <= 
+		detail_sdmap_tree_height(header, slot_size, outer) + 1)
+	{
+		return detail_sdmap_tree_node(header, slot_size, tree, right, outer);
+	}
+	tree = detail_sdmap_tree_node(header, slot_size, tree, right, outer);
+	return detail_sdmap_tree_rotate_r(header, slot_size, tree);
+}
+
+/*Every key in left < key of node < every key in right*/
+SDMAP_API sdmap_index detail_sdmap_tree_join(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index left, 
+	sdmap_index node, 
+	sdmap_index right)
+{
+	int left_height = detail_sdmap_tree_height(header, slot_size, left);
+	int right_height = detail_sdmap_tree_height(header, slot_size, right);
+	if (left_height > right_height + 1)
+	{
+		return detail_sdmap_tree_join_r(header, slot_size, left, node, right);
+	}
+	if (right_height > left_height + 1)
+	{
+		return detail_sdmap_tree_join_l(header, slot_size, left, node, right);
+	}
+	return detail_sdmap_tree_node(header, slot_size, left, node, right);
+}
+
+/*Left gets the keys less than key, right gets the rest*/
+SDMAP_API void detail_sdmap_tree_split(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index tree, 
+	const void *key, 
+	sdmap_index *left, 
+	sdmap_index *right)
+{
+	sdmap_index tree_left;
+	sdmap_index tree_right;
+	sdmap_index middle;
+	if (tree == (sdmap_index)-1)
+	{
+		*left = (sdmap_index)-1;
+		*right = (sdmap_index)-1;
+		return;
+	}
+	tree_left = detail_sdmap_tree_left(header, slot_size, tree);
+	tree_right = detail_sdmap_tree_right(header, slot_size, tree);
+	if (header->compare_func(detail_sdmap_slot_key(header, detail_sdmap_slot(header, tree)), key) >= 0)
+	{
+		detail_sdmap_tree_split(header, slot_size, tree_left, key, left, &middle);
+		*right = detail_sdmap_tree_join(header, slot_size, middle, tree, tree_right);
+	}
+	else
+	{
+		detail_sdmap_tree_split(header, slot_size, tree_right, key, &middle, right);
+		*left = detail_sdmap_tree_join(header, slot_size, tree_left, tree, middle);
+	}
+}
+
+/*Detach the largest node of a tree, returns it and stores what is left in rest*/
+SDMAP_API sdmap_index detail_sdmap_tree_split_last(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index tree, 
+	sdmap_index *rest)
+{
+	sdmap_index last;
+	sdmap_index tree_left = detail_sdmap_tree_left(header, slot_size, tree);
+	sdmap_index tree_right = detail_sdmap_tree_right(header, slot_size, tree);
+	if (tree_right == (sdmap_index)-1)
+	{
+		*rest = tree_left;
+		return tree;
+	}
+	last = detail_sdmap_tree_split_last(header, slot_size, tree_right, &tree_right);
+	*rest = detail_sdmap_tree_join(header, slot_size, tree_left, tree, tree_right);
+	return last;
+}
+
+/*Join two trees without a middle node*/
+SDMAP_API sdmap_index detail_sdmap_tree_join2(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index left, 
+	sdmap_index right)
+{
+	sdmap_index last;
+	if (left == (sdmap_index)-1)
+	{
+		return right;
+	}
+	last = detail_sdmap_tree_split_last(header, slot_size, left, &left);
+	return detail_sdmap_tree_join(header, slot_size, left, last, right);
+}
+
+/*Move every node of a subtree to the list of empty slots*/
+SDMAP_API void detail_sdmap_tree_free(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index tree)
+{
+	sdmap_index right;
+	sdmap_slot *slot;
+	while (tree != (sdmap_index)-1)
+	{
+		detail_sdmap_tree_free(header, slot_size, detail_sdmap_tree_left(header, slot_size, tree));
+		right = detail_sdmap_tree_right(header, slot_size, tree);
+		slot = detail_sdmap_slot(header, tree);
+		detail_sdmap_set_height(slot, -1);
+		slot->right = header->empty_slot;
+		header->empty_slot = tree;
+		header->count--;
+		tree = right;
+	}
+}
+
+/*Copy a subtree into a new heap-type map, the copy is perfectly balanced*/
+SDMAP_API sdmap_header *detail_sdmap_tree_extract(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	sdmap_index tree, 
+	sdmap_index count)
+{
+	sdmap_index i;
+	sdmap_header *result;
+	detail_sdmap_new_heap_impl(&result, count * slot_size, header->compare_func, header->key_offset, header->value_offset);
+	tree = detail_sdmap_min_in_subtree(header, slot_size, tree);
+	for (i = 0; i < count; i++)
+	{
+		memcpy(detail_sdmap_slot_key(header, detail_sdmap_slot(result, i)), 
+			detail_sdmap_slot_key(header, detail_sdmap_slot(header, tree)), 
+			slot_size - header->key_offset);
+		tree = detail_sdmap_next_slot(header, slot_size, tree);
+	}
+	result->count = count;
+	result->slot_count = count;
+	result->root_slot = detail_sdmap_build_sorted(result, slot_size, 0, count, (sdmap_index)-1);
+	return result;
+}
+
+SDMAP_API void detail_sdmap_split_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	const void *key, 
+	sdmap_header **left, 
+	sdmap_header **right)
+{
+	sdmap_index count;
+	sdmap_index tree_left;
+	sdmap_index tree_right;
+	sdmap_index index_left;
+	sdmap_index index_right;
+	*left = NULL;
+	*right = NULL;
+	if (*header == NULL)
+	{
+		return;
+	}
+	if ((*header)->count == 0)
+	{
+		detail_sdmap_delete_impl(header);
+		return;
+	}
+	detail_sdmap_tree_split(*header, slot_size, (*header)->root_slot, key, &tree_left, &tree_right);
+	/*Count both halves in lockstep so only the smaller one is walked through*/
+	count = 0;
+	index_left = tree_left;
+	index_right = tree_right;
+	if (index_left != (sdmap_index)-1)
+	{
+		detail_sdmap_set_parent(detail_sdmap_slot(*header, index_left), (sdmap_index)-1);
+		index_left = detail_sdmap_min_in_subtree(*header, slot_size, index_left);
+	}
+	if (index_right != (sdmap_index)-1)
+	{
+		detail_sdmap_set_parent(detail_sdmap_slot(*header, index_right), (sdmap_index)-1);
+		index_right = detail_sdmap_min_in_subtree(*header, slot_size, index_right);
+	}
+	while (index_left != (sdmap_index)-1 && index_right != (sdmap_index)-1)
+	{
+		index_left = detail_sdmap_next_slot(*header, slot_size, index_left);
+		index_right = detail_sdmap_next_slot(*header, slot_size, index_right);
+		count++;
+	}
+	/*The smaller half is copied out, the larger one keeps the original block*/
+	if (index_left == (sdmap_index)-1)
+	{
+		if (count)
+		{
+			*left = detail_sdmap_tree_extract(*header, slot_size, tree_left, count);
+			detail_sdmap_tree_free(*header, slot_size, tree_left);
+		}
+		(*header)->root_slot = tree_right;
+		*right = *header;
+	}
+	else
+	{
+		if (count)
+		{
+			*right = detail_sdmap_tree_extract(*header, slot_size, tree_right, count);
+			detail_sdmap_tree_free(*header, slot_size, tree_right);
+		}
+		(*header)->root_slot = tree_left;
+		*left = *header;
+	}
+	*header = NULL;
+}
+
+SDMAP_API void detail_sdmap_join_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	sdmap_header **other)
+{
+	sdmap_index i;
+	sdmap_index tree;
+	size_t capacity;
+	sdmap_index first;
+	sdmap_heap *heap;
+	sdmap_header *large;
+	sdmap_header *small;
+	int small_is_left;
+	if (*other == NULL || (*other)->count == 0)
+	{
+		detail_sdmap_delete_impl(other);
+		return;
+	}
+	if (*header == NULL || (*header)->count == 0)
+	{
+		detail_sdmap_delete_impl(header);
+		*header = *other;
+		*other = NULL;
+		return;
+	}
+	sdmap_assert((*header)->compare_func(
+		detail_sdmap_slot_key(*header, detail_sdmap_slot(*header, detail_sdmap_max_in_subtree(*header, slot_size, (*header)->root_slot))),
+		detail_sdmap_slot_key(*other, detail_sdmap_slot(*other, detail_sdmap_min_in_subtree(*other, slot_size, (*other)->root_slot)))) < 0 &&
+		"sdmap_join requires every key of map to be less than every key of other");
+	small_is_left = (*header)->count < (*other)->count;
+	large = small_is_left ? *other : *header;
+	small = small_is_left ? *header : *other;
+	/*Append the smaller map as a balanced subtree behind the slots of the larger one*/
+	sdmap_assert((large->slot_count <= detail_sdmap_max_slot_count - small->count) && "sdmap_index can't address more slots");
+	capacity = slot_size * (large->slot_count + small->count);
+	heap = detail_sdmap_heap_from_header(large);
+	if (heap->capacity < capacity)
+	{
+		heap = sdmap_realloc(heap, sizeof(sdmap_heap) + capacity);
+		sdmap_assert(heap != NULL && "sdmap_realloc returned NULL");
+		heap->capacity = capacity;
+		large = &(heap->header);
+	}
+	first = large->slot_count;
+	tree = detail_sdmap_min_in_subtree(small, slot_size, small->root_slot);
+	for (i = 0; i < small->count; i++)
+	{
+		memcpy(detail_sdmap_slot_key(large, detail_sdmap_slot(large, first + i)), 
+			detail_sdmap_slot_key(small, detail_sdmap_slot(small, tree)), 
+			slot_size - large->key_offset);
+		tree = detail_sdmap_next_slot(small, slot_size, tree);
+	}
+	large->slot_count += small->count;
+	large->count += small->count;
+	tree = detail_sdmap_build_sorted(large, slot_size, first, first + small->count, (sdmap_index)-1);
+	if (small_is_left)
+	{
+		large->root_slot = detail_sdmap_tree_join2(large, slot_size, tree, large->root_slot);
+	}
+	else
+	{
+		large->root_slot = detail_sdmap_tree_join2(large, slot_size, large->root_slot, tree);
+	}
+	detail_sdmap_set_parent(detail_sdmap_slot(large, large->root_slot), (sdmap_index)-1);
+	detail_sdmap_delete_impl(&small);
+	*header = large;
+	*other = NULL;
+}
+
+SDMAP_API void detail_sdmap_erase_range_impl(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	const void *first, 
+	const void *last)
+{
+	sdmap_index tree_left;
+	sdmap_index tree_middle;
+	sdmap_index tree_right;
+	if (header == NULL ||
+		header->count == 0 ||
+		header->compare_func(first, last) >= 0)
+	{
+		return;
+	}
+	detail_sdmap_tree_split(header, slot_size, header->root_slot, first, &tree_left, &tree_middle);
+	detail_sdmap_tree_split(header, slot_size, tree_middle, last, &tree_middle, &tree_right);
+	if (tree_middle != (sdmap_index)-1)
+	{
+		detail_sdmap_set_parent(detail_sdmap_slot(header, tree_middle), (sdmap_index)-1);
+	}
+	detail_sdmap_tree_free(header, slot_size, tree_middle);
+	if (header->count == 0)
+	{
+		detail_sdmap_new_stack_impl(header, header->compare_func, header->key_offset, header->value_offset);
+		return;
+	}
+	header->root_slot = detail_sdmap_tree_join2(header, slot_size, tree_left, tree_right);
+	detail_sdmap_set_parent(detail_sdmap_slot(header, header->root_slot), (sdmap_index)-1);
+}
+
+/*Reserve room for extra slots, moving key along if it points into the map*/
+SDMAP_API void detail_sdmultimap_reserve(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	sdmap_index extra, 
+	const void **key)
+{
+	sdmap_heap *heap;
+	size_t new_capacity;
+	uintptr_t offset = 0;
+	int inside = 0;
+	heap = detail_sdmap_heap_from_header(*header);
+	if (extra == 1 &&
+		(*header)->empty_slot != (sdmap_index)-1)
+	{
+		return;
+	}
+	new_capacity = heap->capacity > 0 ? heap->capacity : slot_size * SDMAP_DEFAULT_CAPACITY;
+	while (new_capacity < slot_size * ((*header)->slot_count + extra))
+	{
+		new_capacity *= 2;
+	}
+	if (new_capacity <= heap->capacity)
+	{
+		return;
+	}
+	if (key != NULL &&
+		(uintptr_t)*key >= (uintptr_t)(*header + 1) &&
+		(uintptr_t)*key < (uintptr_t)(*header + 1) + heap->capacity)
+	{
+		inside = 1;
+		offset = (uintptr_t)*key - (uintptr_t)*header;
+	}
+	heap = sdmap_realloc(heap, sizeof(sdmap_heap) + new_capacity);
+	sdmap_assert(heap != NULL && "sdmap_realloc returned NULL");
+	heap->capacity = new_capacity;
+	*header = &heap->header;
+	if (inside)
+	{
+		*key = (char *)*header + offset;
+	}
+}
+
+SDMAP_API void *detail_sdmultimap_insert_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	const void *key)
+{
+	int compare_result;
+	sdmap_index slot_index;
+	sdmap_index next_index;
+	sdmap_slot *slot;
+	char *result;
+	sdmap_assert((*header)->compare_func != NULL && "sdmap does not have a compare function");
+	/*Grow before searching so the slot we attach to doesn't move*/
+	detail_sdmultimap_reserve(header, slot_size, 1, &key);
+	if ((*header)->count == 0)
+	{
+		result = detail_sdmap_set_heap_empty(header, slot_size, key_size, key);
+	}
+	else
+	{
+		slot_index = (*header)->root_slot;
+		while (1)
+		{
+			slot = detail_sdmap_slot(*header, slot_index);
+			/*Equal keys go to the right, so they stay in the order they were inserted*/
+			compare_result = (*header)->compare_func(detail_sdmap_slot_key(*header, slot), key) > 0 ? 1 : -1;
+			next_index = compare_result > 0 ? slot->left : slot->right;
+			if (next_index == slot_index)
+			{
+				break;
+			}
+			slot_index = next_index;
+		}
+		result = detail_sdmap_attach_heap_impl(header, slot_size, key_size, key, slot_index, compare_result);
+	}
+	return result;
+}
+
+SDMAP_API void detail_sdmultimap_insert_many_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t value_offset, 
+	const void *keys, 
+	const void *values, 
+	sdmap_index count)
+{
+	sdmap_index i;
+	sdmap_index a;
+	sdmap_index b;
+	sdmap_index width;
+	sdmap_index first;
+	sdmap_index middle;
+	sdmap_index last;
+	sdmap_index *order;
+	sdmap_index *source;
+	sdmap_index *target;
+	sdmap_slot *slot;
+	if (count == 0)
+	{
+		return;
+	}
+	sdmap_assert((*header)->compare_func != NULL && "sdmap does not have a compare function");
+	detail_sdmultimap_reserve(header, slot_size, count, NULL);
+	if ((*header)->count != 0)
+	{
+		for (i = 0; i < count; i++)
+		{
+			memcpy(detail_sdmultimap_insert_impl(header, slot_size, key_size,
+				(const char *)keys + (size_t)i * key_size), (const char *)values + (size_t)i * value_size, value_size);
+		}
+		return;
+	}
+	/*Stable bottom-up merge sort of the element order, then the slots are filled in sorted order and linked*/
+	order = sdmap_malloc(sizeof(sdmap_index) * 2 * count);
+	sdmap_assert(order != NULL && "sdmap_malloc returned NULL");
+	source = order;
+	target = order + count;
+	for (i = 0; i < count; i++)
+	{
+		source[i] = i;
+	}
+	for (width = 1; width < count; width *= 2)
+	{
+		for (first = 0; first < count; first += 2 * width)
+		{
+			middle = first + width < count ? first + width : count;
+			last = middle + width < count ? middle + width : count;
+			a = first;
+			b = middle;
+			for (i = first; i < last; i++)
+			{
+				if (a < middle &&
+					(b >= last || (*header)->compare_func(
+						(const char *)keys + (size_t)source[a] * key_size,
+						(const char *)keys + (size_t)source[b] * key_size) <= 0))
+				{
+					target[i] = source[a++];
+				}
+				else
+				{
+					target[i] = source[b++];
+				}
+			}
+		}
+		order = source;
+		source = target;
+		target = order;
+	}
+	for (i = 0; i < count; i++)
+	{
+		slot = detail_sdmap_slot(*header, i);
+		detail_sdmap_set_height(slot, 0);
+		memcpy(detail_sdmap_slot_key(*header, slot), (const char *)keys + (size_t)source[i] * key_size, key_size);
+		memcpy((char *)slot + value_offset, (const char *)values + (size_t)source[i] * value_size, value_size);
+	}
+	(*header)->count = count;
+	(*header)->slot_count = count;
+	(*header)->empty_slot = (sdmap_index)-1;
+	(*header)->root_slot = detail_sdmap_build_sorted(*header, slot_size, 0, count, (sdmap_index)-1);
+	sdmap_free(source < target ? source : target);
+}
+
+/*First slot with a larger key, or a larger or equal one if upper isn't set*/
+SDMAP_API sdmap_index detail_sdmultimap_bound(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	const void *key, 
+	int upper)
+{
+	int compare_result;
+	sdmap_index result = (sdmap_index)-1;
+	sdmap_index slot_index;
+	sdmap_index next_index;
+	sdmap_slot *slot;
+	if (header == NULL ||
+		header->count == 0)
+	{
+		return result;
+	}
+	slot_index = header->root_slot;
+	while (1)
+	{
+		slot = detail_sdmap_slot(header, slot_index);
+		compare_result = header->compare_func(detail_sdmap_slot_key(header, slot), key);
+		if (compare_result > 0 ||
+			(compare_result == 0 && !upper))
+		{
+			result = slot_index;
+			next_index = slot->left;
+		}
+		else
+		{
+			next_index = slot->right;
+		}
+		if (next_index == slot_index)
+		{
+			return result;
+		}
+		slot_index = next_index;
+	}
+}
+
+SDMAP_API sdmap_index detail_sdmultimap_count_impl(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	const void *key)
+{
+	sdmap_index result = 0;
+	sdmap_index slot_index;
+	slot_index = detail_sdmultimap_bound(header, slot_size, key, 0);
+	while (slot_index != (sdmap_index)-1 &&
+		header->compare_func(detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index)), key) == 0)
+	{
+		result++;
+		slot_index = detail_sdmap_next_slot(header, slot_size, slot_index);
+	}
+	return result;
+}
+
+SDMAP_API void detail_sdmultimap_equal_range_impl(
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	const void *key, 
+	const void **first, 
+	const void **last)
+{
+	sdmap_index slot_index;
+	slot_index = detail_sdmultimap_bound(header, slot_size, key, 0);
+	*first = slot_index == (sdmap_index)-1 ? NULL : detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
+	slot_index = detail_sdmultimap_bound(header, slot_size, key, 1);
+	*last = slot_index == (sdmap_index)-1 ? NULL : detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index));
+}
+
+#define detail_sdmap_small_key(header, index)\
+	((void *)((char *)((header) + 1) + (size_t)(index) * key_size))
+
+#define detail_sdmap_small_value(header, index)\
+	((void *)((char *)(header) + (header)->value_offset + (size_t)(index) * value_size))
+
+#if defined(__GNUC__)
+/*Count 16 bytes worth of smaller keys at a time with vector compares, flushing the lane counters before they can overflow*/
+#define detail_sdmap_small_find_vector(type, mask_type)\
+	{\
+		typedef type block __attribute__((vector_size(16)));\
+		typedef mask_type mask __attribute__((vector_size(16)));\
+		const sdmap_index lanes = 16 / sizeof(type);\
+		block targets = (block){0} + target;\
+		block chunk;\
+		mask counts;\
+		sdmap_index j;\
+		sdmap_index limit;\
+		while (i + lanes <= header->count)\
+		{\
+			counts = (mask){0};\
+			limit = header->count - i < 64 * lanes ? header->count : i + 64 * lanes;\
+			for (; i + lanes <= limit; i += lanes)\
+			{\
+				memcpy(&chunk, keys + i, sizeof(chunk));\
+				counts -= (mask)(chunk < targets);\
+			}\
+			for (j = 0; j < lanes; j++)\
+			{\
+				result += counts[j];\
+			}\
+		}\
+	}
+#else
+#define detail_sdmap_small_find_vector(type, mask_type)
+#endif
+
+/*
+ *	The position of a key is the amount of smaller keys. Counting them has no
+ *	early exit, so it runs as straight vector compares, which beats a binary
+ *	search at these sizes.
+ */
+#define detail_sdmap_define_small_find_func(type, postfix, mask_type)\
+SDMAP_API sdmap_index detail_sdmap_small_find_##postfix(\
+	sdmap_small_header *header, uint32_t key_size, const void *key, int *found)\
+{\
+	const type *keys = (const type *)((void *)(header + 1));\
+	const type target = *(const type *)key;\
+	sdmap_index result = 0;\
+	sdmap_index i = 0;\
+	(void)key_size;\
+	detail_sdmap_small_find_vector(type, mask_type)\
+	for (; i < header->count; i++)\
+	{\
+		result += keys[i] < target;\
+	}\
+	*found = result < header->count && keys[result] == target;\
+	return result;\
+}
+
+detail_sdmap_define_small_find_func(uint8_t, uint8_t, int8_t)
+detail_sdmap_define_small_find_func(uint16_t, uint16_t, int16_t)
+detail_sdmap_define_small_find_func(uint32_t, uint32_t, int32_t)
+detail_sdmap_define_small_find_func(uint64_t, uint64_t, int64_t)
+detail_sdmap_define_small_find_func(int8_t, int8_t, int8_t)
+detail_sdmap_define_small_find_func(int16_t, int16_t, int16_t)
+detail_sdmap_define_small_find_func(int32_t, int32_t, int32_t)
+detail_sdmap_define_small_find_func(int64_t, int64_t, int64_t)
+detail_sdmap_define_small_find_func(float, float, int32_t)
+detail_sdmap_define_small_find_func(double, double, int64_t)
+
+SDMAP_API sdmap_index detail_sdmap_small_find_long_double(
+	sdmap_small_header *header, 
+	uint32_t key_size, 
+	const void *key, 
+	int *found)
+{
+	const long double *keys = (const long double *)((void *)(header + 1));
+	const long double target = *(const long double *)key;
+	sdmap_index result = 0;
+	sdmap_index i;
+	(void)key_size;
+	for (i = 0; i < header->count; i++)
+	{
+		result += keys[i] < target;
+	}
+	*found = result < header->count && keys[result] == target;
+	return result;
+}
+
+SDMAP_API sdmap_index detail_sdmap_small_find_generic(
+	sdmap_small_header *header, 
+	uint32_t key_size, 
+	const void *key, 
+	int *found)
+{
+	sdmap_index first = 0;
+	sdmap_index last = header->count;
+	sdmap_index middle;
+	while (first < last)
+	{
+		middle = first + (last - first) / 2;
+		if (header->compare_func(detail_sdmap_small_key(header, middle), key) < 0)
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	*found = first < header->count &&
+		header->compare_func(detail_sdmap_small_key(header, first), key) == 0;
+	return first;
+}
+
+SDMAP_API uint32_t detail_sdmap_small_value_offset(
+	sdmap_index capacity, 
+	uint32_t key_size, 
+	uint32_t value_align)
+{
+	uint32_t offset = sizeof(sdmap_small_header) + capacity * key_size;
+	return (offset + value_align - 1) / value_align * value_align;
+}
+
+SDMAP_API sdmap_small_header **detail_sdmap_small_ensure_initialized_impl(
+	sdmap_small_header **header, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t value_align, 
+	int (*compare_func)(const void *, const void *))
+{
+	uint32_t value_offset;
+	if (*header == NULL)
+	{
+		value_offset = detail_sdmap_small_value_offset(4, key_size, value_align);
+		*header = sdmap_malloc(value_offset + 4 * value_size);
+		sdmap_assert(*header != NULL && "sdmap_malloc returned NULL");
+		(*header)->count = 0;
+		(*header)->capacity = 4;
+		(*header)->value_offset = value_offset;
+		(*header)->compare_func = compare_func;
+		(*header)->tree = NULL;
+	}
+	return header;
+}
+
+SDMAP_API sdmap_index detail_sdmap_small_count_impl(sdmap_small_header *header)
+{
+	if (header == NULL)
+	{
+		return 0;
+	}
+	if (header->tree != NULL)
+	{
+		return header->tree->count;
+	}
+	return header->count;
+}
+
+SDMAP_API void *detail_sdmap_small_getp_impl(
+	sdmap_small_header *header, 
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *), 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t value_offset, 
+	const void *key)
+{
+	sdmap_index i;
+	int found;
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	if (header->tree != NULL)
+	{
+		return detail_sdmap_getp_impl(header->tree, slot_size, value_offset, key);
+	}
+	i = find(header, key_size, key, &found);
+	return found ? detail_sdmap_small_value(header, i) : NULL;
+}
+
+/*Move the elements into a heap-type map, they are sorted already so it is linked directly*/
+SDMAP_API void detail_sdmap_small_to_tree(
+	sdmap_small_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t key_offset, 
+	uint32_t value_offset)
+{
+	sdmap_index i;
+	sdmap_slot *slot;
+	sdmap_header *tree;
+	sdmap_small_header *small = *header;
+	detail_sdmap_new_heap_impl(&tree, slot_size * small->count * 2, small->compare_func, key_offset, value_offset);
+	for (i = 0; i < small->count; i++)
+	{
+		slot = detail_sdmap_slot(tree, i);
+		detail_sdmap_set_height(slot, 0);
+		memcpy(detail_sdmap_slot_key(tree, slot), detail_sdmap_small_key(small, i), key_size);
+		memcpy((char *)slot + value_offset, detail_sdmap_small_value(small, i), value_size);
+	}
+	tree->count = small->count;
+	tree->slot_count = small->count;
+	tree->root_slot = detail_sdmap_build_sorted(tree, slot_size, 0, small->count, (sdmap_index)-1);
+	small = sdmap_realloc(small, sizeof(sdmap_small_header));
+	sdmap_assert(small != NULL && "sdmap_realloc returned NULL");
+	small->count = 0;
+	small->capacity = 0;
+	small->value_offset = sizeof(sdmap_small_header);
+	small->tree = tree;
+	*header = small;
+}
+
+SDMAP_API void *detail_sdmap_small_set_impl(
+	sdmap_small_header **header, 
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *), 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t key_offset, 
+	uint32_t value_offset, 
+	uint32_t value_align, 
+	const void *key)
+{
+	sdmap_index i;
+	int found;
+	sdmap_index capacity;
+	uint32_t new_value_offset;
+	sdmap_small_header *small = *header;
+	char *result;
+	if (small->tree == NULL)
+	{
+		i = find(small, key_size, key, &found);
+		if (found)
+		{
+			return detail_sdmap_small_value(small, i);
+		}
+		if (small->count < small->capacity ||
+			small->capacity < SDMAP_SMALL_MAX)
+		{
+			if (small->count == small->capacity)
+			{
+				capacity = small->capacity * 2 < SDMAP_SMALL_MAX ? small->capacity * 2 : SDMAP_SMALL_MAX;
+				new_value_offset = detail_sdmap_small_value_offset(capacity, key_size, value_align);
+				small = sdmap_realloc(small, new_value_offset + capacity * value_size);
+				sdmap_assert(small != NULL && "sdmap_realloc returned NULL");
+				memmove((char *)small + new_value_offset, (char *)small + small->value_offset, small->count * value_size);
+				small->capacity = capacity;
+				small->value_offset = new_value_offset;
+				*header = small;
+			}
+			memmove(detail_sdmap_small_key(small, i + 1), detail_sdmap_small_key(small, i),
+				(small->count - i) * key_size);
+			memmove(detail_sdmap_small_value(small, i + 1), detail_sdmap_small_value(small, i),
+				(small->count - i) * value_size);
+			memcpy(detail_sdmap_small_key(small, i), key, key_size);
+			small->count++;
+			return detail_sdmap_small_value(small, i);
+		}
+		detail_sdmap_small_to_tree(header, slot_size, key_size, value_size, key_offset, value_offset);
+		small = *header;
+	}
+	result = detail_sdmap_set_heap_impl(&small->tree, slot_size, key_size, key);
+	return result;
+}
+
+SDMAP_API void detail_sdmap_small_erase_impl(
+	sdmap_small_header *header, 
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *), 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	const void *key)
+{
+	sdmap_index i;
+	int found;
+	if (header == NULL)
+	{
+		return;
+	}
+	if (header->tree != NULL)
+	{
+		detail_sdmap_erase_impl(header->tree, slot_size, key);
+		return;
+	}
+	i = find(header, key_size, key, &found);
+	if (found)
+	{
+		header->count--;
+		memmove(detail_sdmap_small_key(header, i), detail_sdmap_small_key(header, i + 1),
+			(header->count - i) * key_size);
+		memmove(detail_sdmap_small_value(header, i), detail_sdmap_small_value(header, i + 1),
+			(header->count - i) * value_size);
+	}
+}
+
+SDMAP_API void *detail_sdmap_small_min_impl(
+	sdmap_small_header *header, 
+	uint32_t slot_size)
+{
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	if (header->tree != NULL)
+	{
+		return detail_sdmap_min_key_impl(header->tree, slot_size);
+	}
+	return header->count > 0 ? header + 1 : NULL;
+}
+
+SDMAP_API void *detail_sdmap_small_next_impl(
+	sdmap_small_header *header, 
+	sdmap_index (*find)(sdmap_small_header *, uint32_t, const void *, int *), 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	const void *key)
+{
+	sdmap_index i;
+	int found;
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	if (header->tree != NULL)
+	{
+		return detail_sdmap_next_key_impl(header->tree, slot_size, key);
+	}
+	if ((uintptr_t)key >= (uintptr_t)(header + 1) &&
+		(uintptr_t)key < (uintptr_t)detail_sdmap_small_key(header, header->count))
+	{
+		/*Key points to inside the object*/
+		i = ((uintptr_t)key - (uintptr_t)(header + 1)) / key_size + 1;
+	}
+	else
+	{
+		i = find(header, key_size, key, &found);
+		i += found;
+	}
+	return i < header->count ? detail_sdmap_small_key(header, i) : NULL;
+}
+
+SDMAP_API void detail_sdmap_small_delete_impl(sdmap_small_header **header)
+{
+	if (*header != NULL)
+	{
+		detail_sdmap_delete_impl(&(*header)->tree);
+		sdmap_free(*header);
+		*header = NULL;
+	}
+}
+
+#define detail_sdmap_frozen_key(frozen, index)\
+	((void *)((char *)((frozen) + 1) + ((index) - 1) * key_size))
+
+#define detail_sdmap_frozen_value(frozen, index)\
+	((void *)((char *)(frozen) + (frozen)->value_offset + ((index) - 1) * value_size))
+
+/*Eytzinger index of the smallest key in the frozen map*/
+SDMAP_API size_t detail_sdmap_frozen_first(sdmap_index count)
+{
+	size_t k = 1;
+	while (2 * k <= count)
+	{
+		k = 2 * k;
+	}
+	return k;
+}
+
+/*Eytzinger index of the next key in order, 0 when there is none*/
+SDMAP_API size_t detail_sdmap_frozen_next(sdmap_index count, size_t k)
+{
+	if (2 * k + 1 <= count)
+	{
+		k = 2 * k + 1;
+		while (2 * k <= count)
+		{
+			k = 2 * k;
+		}
+		return k;
+	}
+	while (k & 1)
+	{
+		k >>= 1;
+	}
+	return k >> 1;
+}
+
+/*Undo the right turns taken after the last left turn of a search*/
+SDMAP_API sdmap_index detail_sdmap_frozen_unwind(size_t k)
+{
+#if defined(__GNUC__)
+	return (sdmap_index)(k >> (__builtin_ctzll(~(unsigned long long)k) + 1));
+#else
+	while (k & 1)
+	{
+		k >>= 1;
+	}
+	return (sdmap_index)(k >> 1);
+#endif
+}
+
+/*
+ *	Every level is one branchless step, the keys four levels further down are
+ *	contiguous and fetched early so the loop isn't bound by memory latency.
+ */
+#define detail_sdmap_frozen_search_body(is_less)\
+	size_t k = 1;\
+	while (k <= header->count)\
+	{\
+		detail_sdmap_prefetch((const void *)((uintptr_t)(header + 1) + (16 * k - 1) * key_size));\
+		k = 2 * k + (is_less);\
+	}\
+	return detail_sdmap_frozen_unwind(k);
+
+#define detail_sdmap_define_frozen_search_func(type, postfix)\
+SDMAP_API sdmap_index detail_sdmap_frozen_search_##postfix(\
+	sdmap_frozen_header *header, uint32_t key_size, const void *key)\
+{\
+	detail_sdmap_frozen_search_body(\
+		*(const type *)detail_sdmap_frozen_key(header, k) < *(const type *)key)\
+}
+
+detail_sdmap_define_frozen_search_func(uint8_t, uint8_t)
+detail_sdmap_define_frozen_search_func(uint16_t, uint16_t)
+detail_sdmap_define_frozen_search_func(uint32_t, uint32_t)
+detail_sdmap_define_frozen_search_func(uint64_t, uint64_t)
+detail_sdmap_define_frozen_search_func(int8_t, int8_t)
+detail_sdmap_define_frozen_search_func(int16_t, int16_t)
+detail_sdmap_define_frozen_search_func(int32_t, int32_t)
+detail_sdmap_define_frozen_search_func(int64_t, int64_t)
+detail_sdmap_define_frozen_search_func(float, float)
+detail_sdmap_define_frozen_search_func(double, double)
+detail_sdmap_define_frozen_search_func(long double, long_double)
+
+SDMAP_API sdmap_index detail_sdmap_frozen_search_generic(
+	sdmap_frozen_header *header, 
+	uint32_t key_size, 
+	const void *key)
+{
+	detail_sdmap_frozen_search_body(
+		header->compare_func(detail_sdmap_frozen_key(header, k), key) < 0)
+}
+
+SDMAP_API void detail_sdmap_freeze_impl(
+	sdmap_frozen_header **frozen, 
+	sdmap_header *header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t value_offset, 
+	uint32_t value_align)
+{
+	sdmap_index i;
+	sdmap_index count;
+	sdmap_index slot_index;
+	size_t k;
+	size_t size;
+	sdmap_frozen_header *result;
+	count = header ? header->count : 0;
+	size = sizeof(sdmap_frozen_header) + count * key_size;
+	size = (size + value_align - 1) / value_align * value_align;
+	result = sdmap_malloc(size + count * value_size);
+	sdmap_assert(result != NULL && "sdmap_malloc returned NULL");
+	result->count = count;
+	result->value_offset = (uint32_t)size;
+	result->compare_func = header ? header->compare_func : NULL;
+	if (count)
+	{
+		/*Walk both the tree and the implicit Eytzinger tree in order*/
+		slot_index = detail_sdmap_min_in_subtree(header, slot_size, header->root_slot);
+		k = detail_sdmap_frozen_first(count);
+		for (i = 0; i < count; i++)
+		{
+			memcpy(detail_sdmap_frozen_key(result, k), detail_sdmap_slot_key(header, detail_sdmap_slot(header, slot_index)), key_size);
+			memcpy(detail_sdmap_frozen_value(result, k), detail_sdmap_value(header, slot_index), value_size);
+			k = detail_sdmap_frozen_next(count, k);
+			slot_index = detail_sdmap_next_slot(header, slot_size, slot_index);
+		}
+	}
+	*frozen = result;
+}
+
+SDMAP_API void detail_sdmap_thaw_impl(
+	sdmap_header **header, 
+	uint32_t slot_size, 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	uint32_t key_offset, 
+	uint32_t value_offset, 
+	sdmap_frozen_header *frozen)
+{
+	sdmap_index i;
+	sdmap_index count;
+	size_t k;
+	sdmap_slot *slot;
+	count = frozen ? frozen->count : 0;
+	detail_sdmap_new_heap_impl(header, count * slot_size, frozen ? frozen->compare_func : NULL, key_offset, value_offset);
+	if (count == 0)
+	{
+		return;
+	}
+	k = detail_sdmap_frozen_first(count);
+	for (i = 0; i < count; i++)
+	{
+		slot = detail_sdmap_slot(*header, i);
+		memcpy(detail_sdmap_slot_key(*header, slot), detail_sdmap_frozen_key(frozen, k), key_size);
+		memcpy(detail_sdmap_value(*header, i), detail_sdmap_frozen_value(frozen, k), value_size);
+		k = detail_sdmap_frozen_next(count, k);
+	}
+	(*header)->count = count;
+	(*header)->slot_count = count;
+	(*header)->root_slot = detail_sdmap_build_sorted(*header, slot_size, 0, count, (sdmap_index)-1);
+}
+
+SDMAP_API sdmap_index detail_sdmap_frozen_count_impl(
+	sdmap_frozen_header *frozen)
+{
+	if (frozen)
+	{
+		return frozen->count;
+	}
+	return 0;
+}
+
+SDMAP_API void *detail_sdmap_frozen_getp_impl(
+	sdmap_frozen_header *frozen, 
+	sdmap_index (*search_func)(sdmap_frozen_header *, uint32_t, const void *), 
+	uint32_t key_size, 
+	uint32_t value_size, 
+	const void *key)
+{
+	sdmap_index k;
+	if (frozen == NULL ||
+		frozen->count == 0)
+	{
+		return NULL;
+	}
+	k = search_func(frozen, key_size, key);
+	if (k == 0 ||
+		frozen->compare_func(detail_sdmap_frozen_key(frozen, k), key) != 0)
+	{
+		return NULL;
+	}
+	return detail_sdmap_frozen_value(frozen, k);
+}
+
+SDMAP_API void *detail_sdmap_frozen_lower_bound_impl(
+	sdmap_frozen_header *frozen, 
+	sdmap_index (*search_func)(sdmap_frozen_header *, uint32_t, const void *), 
+	uint32_t key_size, 
+	const void *key)
+{
+	sdmap_index k;
+	if (frozen == NULL ||
+		frozen->count == 0)
+	{
+		return NULL;
+	}
+	k = search_func(frozen, key_size, key);
+	if (k == 0)
+	{
+		return NULL;
+	}
+	return detail_sdmap_frozen_key(frozen, k);
+}
+
+SDMAP_API void detail_sdmap_frozen_delete_impl(sdmap_frozen_header **frozen)
+{
+	if (*frozen != NULL)
+	{
+		sdmap_free(*frozen);
+		*frozen = NULL;
+	}
+}
+
 SDMAP_API void detail_sdmap_delete_impl(sdmap_header **header)
 {
 	if (*header != NULL)
@@ -1500,7 +3424,7 @@ SDMAP_API void detail_sdmap_traverse_inorder_keys_impl(
 	uint32_t slot_size, 
 	void (*function)(const void *key))
 {
-	detail_sdmap_inorder_body(current + 1)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current))
 }
 
 SDMAP_API void detail_sdmap_traverse_preorder_keys_impl(
@@ -1508,7 +3432,7 @@ SDMAP_API void detail_sdmap_traverse_preorder_keys_impl(
 	uint32_t slot_size, 
 	void (*function)(const void *key))
 {
-	detail_sdmap_preorder_body(current + 1)
+	detail_sdmap_preorder_body(detail_sdmap_slot_key(header, current))
 }
 
 SDMAP_API void detail_sdmap_traverse_inorder_values_impl(
@@ -1535,7 +3459,7 @@ SDMAP_API void detail_sdmap_traverse_inorder_pairs_impl(
 	uint32_t value_offset, 
 	void (*function)(const void *key, void *value))
 {
-	detail_sdmap_inorder_body(current + 1, ((char *)current) + value_offset)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current), ((char *)current) + value_offset)
 }
 
 SDMAP_API void detail_sdmap_traverse_preorder_pairs_impl(
@@ -1544,7 +3468,7 @@ SDMAP_API void detail_sdmap_traverse_preorder_pairs_impl(
 	uint32_t value_offset, 
 	void (*function)(const void *key, void *value))
 {
-	detail_sdmap_inorder_body(current + 1, ((char *)current) + value_offset)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current), ((char *)current) + value_offset)
 }
 
 SDMAP_API void detail_sdmap_traverse_inorder_keys_ex_impl(
@@ -1553,7 +3477,7 @@ SDMAP_API void detail_sdmap_traverse_inorder_keys_ex_impl(
 	void (*function)(const void *key, void *user), 
 	void *user)
 {
-	detail_sdmap_inorder_body(current + 1, user)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current), user)
 }
 
 SDMAP_API void detail_sdmap_traverse_preorder_keys_ex_impl(
@@ -1562,7 +3486,7 @@ SDMAP_API void detail_sdmap_traverse_preorder_keys_ex_impl(
 	void (*function)(const void *key, void *user), 
 	void *user)
 {
-	detail_sdmap_preorder_body(current + 1, user)
+	detail_sdmap_preorder_body(detail_sdmap_slot_key(header, current), user)
 }
 
 SDMAP_API void detail_sdmap_traverse_inorder_values_ex_impl(
@@ -1592,7 +3516,7 @@ SDMAP_API void detail_sdmap_traverse_inorder_pairs_ex_impl(
 	void (*function)(const void *key, void *value, void *user), 
 	void *user)
 {
-	detail_sdmap_inorder_body(current + 1, ((char *)current) + value_offset, user)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current), ((char *)current) + value_offset, user)
 }
 
 SDMAP_API void detail_sdmap_traverse_preorder_pairs_ex_impl(
@@ -1602,5 +3526,5 @@ SDMAP_API void detail_sdmap_traverse_preorder_pairs_ex_impl(
 	void (*function)(const void *key, void *value, void *user), 
 	void *user)
 {
-	detail_sdmap_inorder_body(current + 1, ((char *)current) + value_offset, user)
+	detail_sdmap_inorder_body(detail_sdmap_slot_key(header, current), ((char *)current) + value_offset, user)
 }
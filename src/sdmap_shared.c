@@ -0,0 +1,197 @@
+#include <sdmap_shared.h>
+
+#define detail_sdmap_slot(map, index) ((sdmap_slot *)((char *)(map) + sizeof(sdmap_header) + (index) * slot_size))
+
+#define detail_sdmap_heap_from_header(h) ((sdmap_heap *)((char *)((void *)(h)) - offsetof(sdmap_heap, header)))
+
+SDMAP_API sdmap_shared_header *detail_sdmap_shared_ensure_initialized_impl(
+	sdmap_shared_header **header,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset)
+{
+	sdmap_header *map;
+	if (*header == NULL)
+	{
+		*header = sdmap_malloc(sizeof(sdmap_shared_header));
+		sdmap_assert(*header != NULL && "sdmap_malloc returned NULL");
+		detail_sdmap_new_heap_impl(&map, 0, compare_func, key_offset, value_offset);
+		atomic_init(&(*header)->sequence, 0);
+		atomic_init(&(*header)->map, map);
+		(*header)->retired = NULL;
+		(*header)->retired_count = 0;
+	}
+	return *header;
+}
+
+SDMAP_API sdmap_index detail_sdmap_shared_count_impl(sdmap_shared_header *header)
+{
+	unsigned sequence;
+	sdmap_index count;
+	if (header == NULL)
+	{
+		return 0;
+	}
+	while (1)
+	{
+		sequence = atomic_load_explicit(&header->sequence, memory_order_acquire);
+		if (sequence & 1)
+		{
+			continue;
+		}
+		count = atomic_load_explicit(&header->map, memory_order_acquire)->count;
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&header->sequence, memory_order_relaxed) == sequence)
+		{
+			return count;
+		}
+	}
+}
+
+SDMAP_API int detail_sdmap_shared_read_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	uint32_t value_size,
+	const void *key,
+	void *value)
+{
+	unsigned sequence;
+	int found;
+	int compare_result;
+	int depth;
+	sdmap_header *map;
+	sdmap_index capacity;
+	sdmap_index slot_index;
+	sdmap_index next_index;
+	sdmap_slot *slot;
+	if (header == NULL)
+	{
+		return 0;
+	}
+	while (1)
+	{
+		sequence = atomic_load_explicit(&header->sequence, memory_order_acquire);
+		if (sequence & 1)
+		{
+			continue;
+		}
+		map = atomic_load_explicit(&header->map, memory_order_acquire);
+		capacity = detail_sdmap_heap_from_header(map)->capacity / slot_size;
+		found = 0;
+		slot_index = map->root_slot;
+		/*Links can be torn by the writer, so every step is bounds checked and
+		the descent can't be longer than twice the bits in an index*/
+		for (depth = 0; slot_index < capacity && depth < (int)(16 * sizeof(sdmap_index)); depth++)
+		{
+			slot = detail_sdmap_slot(map, slot_index);
+			compare_result = map->compare_func((char *)slot + map->key_offset, key);
+			if (compare_result == 0)
+			{
+				found = 1;
+				if (value)
+				{
+					memcpy(value, (char *)slot + value_offset, value_size);
+				}
+				break;
+			}
+			next_index = compare_result > 0 ? slot->left : slot->right;
+			if (next_index == slot_index)
+			{
+				break;
+			}
+			slot_index = next_index;
+		}
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&header->sequence, memory_order_relaxed) == sequence)
+		{
+			return found;
+		}
+	}
+}
+
+SDMAP_API void detail_sdmap_shared_set_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	const void *key,
+	const void *value)
+{
+	unsigned sequence;
+	sdmap_header *map;
+	sdmap_heap *heap;
+	sdmap_heap *grown;
+	size_t capacity;
+	char *value_ptr;
+	map = atomic_load_explicit(&header->map, memory_order_relaxed);
+	heap = detail_sdmap_heap_from_header(map);
+	if (map->empty_slot == (sdmap_index)-1 &&
+		heap->capacity < slot_size * (map->slot_count + 1))
+	{
+		/*Readers may still be in the old slots, so grow into a copy instead
+		of reallocating*/
+		capacity = heap->capacity > 0 ? heap->capacity * 2 : slot_size * SDMAP_DEFAULT_CAPACITY;
+		grown = sdmap_malloc(sizeof(sdmap_heap) + capacity);
+		sdmap_assert(grown != NULL && "sdmap_malloc returned NULL");
+		memcpy(grown, heap, sizeof(sdmap_heap) + slot_size * map->slot_count);
+		grown->capacity = capacity;
+		header->retired = sdmap_realloc(header->retired, (header->retired_count + 1) * sizeof(sdmap_heap *));
+		sdmap_assert(header->retired != NULL && "sdmap_realloc returned NULL");
+		header->retired[header->retired_count++] = heap;
+		map = &grown->header;
+		atomic_store_explicit(&header->map, map, memory_order_release);
+	}
+	sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+	atomic_store_explicit(&header->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	value_ptr = detail_sdmap_set_heap_impl(&map, slot_size, key_size, key);
+	memcpy(value_ptr, value, value_size);
+	atomic_store_explicit(&header->sequence, sequence + 2, memory_order_release);
+	sdmap_assert(map == atomic_load_explicit(&header->map, memory_order_relaxed) && "sdmap_shared was reallocated");
+}
+
+SDMAP_API void detail_sdmap_shared_erase_impl(
+	sdmap_shared_header *header,
+	uint32_t slot_size,
+	const void *key)
+{
+	unsigned sequence;
+	if (header == NULL)
+	{
+		return;
+	}
+	sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+	atomic_store_explicit(&header->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	detail_sdmap_erase_impl(atomic_load_explicit(&header->map, memory_order_relaxed), slot_size, key);
+	atomic_store_explicit(&header->sequence, sequence + 2, memory_order_release);
+}
+
+SDMAP_API void detail_sdmap_shared_reclaim_impl(sdmap_shared_header *header)
+{
+	sdmap_index i;
+	if (header == NULL)
+	{
+		return;
+	}
+	for (i = 0; i < header->retired_count; i++)
+	{
+		sdmap_free(header->retired[i]);
+	}
+	sdmap_free(header->retired);
+	header->retired = NULL;
+	header->retired_count = 0;
+}
+
+SDMAP_API void detail_sdmap_shared_delete_impl(sdmap_shared_header **header)
+{
+	if (*header == NULL)
+	{
+		return;
+	}
+	detail_sdmap_shared_reclaim_impl(*header);
+	sdmap_free(detail_sdmap_heap_from_header(atomic_load_explicit(&(*header)->map, memory_order_relaxed)));
+	sdmap_free(*header);
+	*header = NULL;
+}
@@ -0,0 +1,104 @@
+#include <sdmap_stable.h>
+
+SDMAP_API sdmap_stable_header *detail_sdmap_stable_ensure_initialized_impl(
+	sdmap_stable_header **header,
+	int (*compare_func)(const void *, const void *),
+	uint32_t key_offset,
+	uint32_t value_offset)
+{
+	if (*header == NULL)
+	{
+		*header = sdmap_malloc(sizeof(sdmap_stable_header));
+		sdmap_assert(*header != NULL && "sdmap_malloc returned NULL");
+		detail_sdmap_new_heap_impl(&(*header)->map, 0, compare_func, key_offset, value_offset);
+		detail_sdd_stable_pool_new(&(*header)->values);
+	}
+	return *header;
+}
+
+SDMAP_API sdmap_index detail_sdmap_stable_count_impl(sdmap_stable_header *header)
+{
+	if (header == NULL)
+	{
+		return 0;
+	}
+	return header->map->count;
+}
+
+SDMAP_API void *detail_sdmap_stable_getp_impl(
+	sdmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	const void *key)
+{
+	void *value_ptr;
+	if (header == NULL)
+	{
+		return NULL;
+	}
+	value_ptr = detail_sdmap_getp_impl(header->map, slot_size, value_offset, key);
+	if (value_ptr == NULL)
+	{
+		return NULL;
+	}
+	return *(void **)value_ptr;
+}
+
+SDMAP_API void *detail_sdmap_stable_get_impl(
+	sdmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_size,
+	uint32_t value_align,
+	const void *key)
+{
+	sdmap_index count;
+	void *value_ptr;
+	void *result;
+	count = header->map->count;
+	value_ptr = detail_sdmap_set_heap_impl(&header->map, slot_size, key_size, key);
+	if (header->map->count == count)
+	{
+		return *(void **)value_ptr;
+	}
+	result = detail_sdd_stable_pool_alloc(&header->values, value_size, value_align, SDMAP_DEFAULT_CAPACITY, sdmap_malloc);
+	sdmap_assert(result != NULL && "sdmap_malloc returned NULL");
+	memset(result, 0, value_size);
+	*(void **)value_ptr = result;
+	return result;
+}
+
+SDMAP_API void detail_sdmap_stable_erase_impl(
+	sdmap_stable_header *header,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	const void *key)
+{
+	void *value;
+	value = detail_sdmap_stable_getp_impl(header, slot_size, value_offset, key);
+	if (value == NULL)
+	{
+		return;
+	}
+	/*Only the pointer in the slot is moved around by the erase, the value stays put*/
+	detail_sdmap_erase_impl(header->map, slot_size, key);
+	detail_sdd_stable_pool_release(&header->values, value);
+	if (SDMAP_ENABLE_AUTOSHRINK &&
+		detail_sdmap_capacity_impl(header->map, slot_size) >=
+			header->map->count * SDMAP_SHRINK_DENOMINATOR)
+	{
+		detail_sdmap_shrink_impl(&header->map, slot_size);
+	}
+}
+
+SDMAP_API void detail_sdmap_stable_delete_impl(sdmap_stable_header **header)
+{
+	if (*header == NULL)
+	{
+		return;
+	}
+	detail_sdd_stable_pool_delete(&(*header)->values, sdmap_free);
+	detail_sdmap_delete_impl(&(*header)->map);
+	sdmap_free(*header);
+	*header = NULL;
+}
@@ -0,0 +1,507 @@
+#include <sdpmap.h>
+#include <stdatomic.h>
+
+#define detail_sdpmap_node(header, index) detail_sdpmap_node_impl(header, slot_size, index)
+
+#define detail_sdpmap_key(header, index) ((void *)(detail_sdpmap_node(header, index) + 1))
+
+#define detail_sdpmap_height(header, index)\
+	((index) == (sdmap_index)-1 ? -1 : detail_sdpmap_node(header, index)->height)
+
+struct sdpmap_version
+{
+	/*Next newer version*/
+	struct sdpmap_version *next;
+	sdpmap_header *header;
+	sdmap_index root;
+	sdmap_index count;
+	uint32_t number;
+	atomic_uint refs;
+	/*Nodes of this version that were replaced after it, freed along with it*/
+	sdmap_index *retired;
+	sdmap_index retired_count;
+	sdmap_index retired_capacity;
+};
+
+SDPMAP_API unsigned detail_sdpmap_chunk_of(sdmap_index index)
+{
+	uint32_t q = index / SDPMAP_CHUNK_SIZE + 1;
+#if defined(__GNUC__)
+	return 31 - __builtin_clz(q);
+#else
+	unsigned result = 0;
+	while (q >>= 1)
+	{
+		result++;
+	}
+	return result;
+#endif
+}
+
+SDPMAP_API sdpmap_node *detail_sdpmap_node_impl(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	unsigned chunk = detail_sdpmap_chunk_of(index);
+	size_t offset = index - (size_t)SDPMAP_CHUNK_SIZE * (((size_t)1 << chunk) - 1);
+	return (sdpmap_node *)(header->chunks[chunk] + offset * slot_size);
+}
+
+SDPMAP_API sdpmap_header *detail_sdpmap_ensure_initialized_impl(
+	sdpmap_header **header,
+	int (*compare_func)(const void *, const void *))
+{
+	if (*header == NULL)
+	{
+		*header = sdpmap_malloc(sizeof(sdpmap_header));
+		sdpmap_assert(*header != NULL && "sdpmap_malloc returned NULL");
+		memset(*header, 0, sizeof(sdpmap_header));
+		(*header)->root = (sdmap_index)-1;
+		(*header)->free_node = (sdmap_index)-1;
+		(*header)->version = 1;
+		(*header)->compare_func = compare_func;
+	}
+	return *header;
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_count_impl(
+	sdpmap_header *header,
+	struct sdpmap_version *version)
+{
+	if (version)
+	{
+		return version->count;
+	}
+	if (header)
+	{
+		return header->count;
+	}
+	return 0;
+}
+
+SDPMAP_API void *detail_sdpmap_getp_impl(
+	sdpmap_header *header,
+	struct sdpmap_version *version,
+	uint32_t slot_size,
+	uint32_t value_offset,
+	const void *key)
+{
+	int compare_result;
+	sdmap_index index;
+	sdpmap_node *node;
+	if (version)
+	{
+		header = version->header;
+		index = version->root;
+	}
+	else if (header)
+	{
+		index = header->root;
+	}
+	else
+	{
+		return NULL;
+	}
+	while (index != (sdmap_index)-1)
+	{
+		node = detail_sdpmap_node(header, index);
+		compare_result = header->compare_func(node + 1, key);
+		if (compare_result == 0)
+		{
+			return (char *)node + value_offset;
+		}
+		index = compare_result > 0 ? node->left : node->right;
+	}
+	return NULL;
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_allocate(
+	sdpmap_header *header,
+	uint32_t slot_size)
+{
+	sdmap_index index;
+	unsigned chunk;
+	if (header->free_node != (sdmap_index)-1)
+	{
+		index = header->free_node;
+		header->free_node = detail_sdpmap_node(header, index)->left;
+		return index;
+	}
+	index = header->node_count++;
+	chunk = detail_sdpmap_chunk_of(index);
+	sdpmap_assert(chunk < sizeof(header->chunks) / sizeof(*header->chunks) && "sdpmap is full");
+	if (header->chunks[chunk] == NULL)
+	{
+		header->chunks[chunk] = sdpmap_malloc(((size_t)SDPMAP_CHUNK_SIZE << chunk) * slot_size);
+		sdpmap_assert(header->chunks[chunk] != NULL && "sdpmap_malloc returned NULL");
+	}
+	return index;
+}
+
+/*Can a snapshot still see the node*/
+SDPMAP_API int detail_sdpmap_is_shared(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	return header->newest != NULL &&
+		detail_sdpmap_node(header, index)->version <= header->newest->number;
+}
+
+/*Give up a node that was unlinked from the current version*/
+SDPMAP_API void detail_sdpmap_dispose(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	struct sdpmap_version *newest = header->newest;
+	if (!detail_sdpmap_is_shared(header, slot_size, index))
+	{
+		detail_sdpmap_node(header, index)->left = header->free_node;
+		header->free_node = index;
+		return;
+	}
+	if (newest->retired_count == newest->retired_capacity)
+	{
+		newest->retired_capacity = newest->retired_capacity ? newest->retired_capacity * 2 : 16;
+		newest->retired = sdpmap_realloc(newest->retired, newest->retired_capacity * sizeof(sdmap_index));
+		sdpmap_assert(newest->retired != NULL && "sdpmap_realloc returned NULL");
+	}
+	newest->retired[newest->retired_count++] = index;
+}
+
+/*Return a node that may be modified, copying it if a snapshot can see it*/
+SDPMAP_API sdmap_index detail_sdpmap_writable(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	sdmap_index copy;
+	if (!detail_sdpmap_is_shared(header, slot_size, index))
+	{
+		return index;
+	}
+	copy = detail_sdpmap_allocate(header, slot_size);
+	memcpy(detail_sdpmap_node(header, copy), detail_sdpmap_node(header, index), slot_size);
+	detail_sdpmap_node(header, copy)->version = header->version;
+	detail_sdpmap_dispose(header, slot_size, index);
+	return copy;
+}
+
+SDPMAP_API void detail_sdpmap_update_height(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	sdpmap_node *node = detail_sdpmap_node(header, index);
+	int left = detail_sdpmap_height(header, node->left);
+	int right = detail_sdpmap_height(header, node->right);
+	node->height = (int8_t)((left > right ? left : right) + 1);
+}
+
+/*The node itself has to be writable already*/
+SDPMAP_API sdmap_index detail_sdpmap_rotate_l(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	sdmap_index right = detail_sdpmap_writable(header, slot_size, detail_sdpmap_node(header, index)->right);
+	detail_sdpmap_node(header, index)->right = detail_sdpmap_node(header, right)->left;
+	detail_sdpmap_node(header, right)->left = index;
+	detail_sdpmap_update_height(header, slot_size, index);
+	detail_sdpmap_update_height(header, slot_size, right);
+	return right;
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_rotate_r(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	sdmap_index left = detail_sdpmap_writable(header, slot_size, detail_sdpmap_node(header, index)->left);
+	detail_sdpmap_node(header, index)->left = detail_sdpmap_node(header, left)->right;
+	detail_sdpmap_node(header, left)->right = index;
+	detail_sdpmap_update_height(header, slot_size, index);
+	detail_sdpmap_update_height(header, slot_size, left);
+	return left;
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_balance(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index)
+{
+	sdpmap_node *node = detail_sdpmap_node(header, index);
+	sdpmap_node *child;
+	int balance;
+	detail_sdpmap_update_height(header, slot_size, index);
+	balance = detail_sdpmap_height(header, node->right) - detail_sdpmap_height(header, node->left);
+	if (balance > 1)
+	{
+		child = detail_sdpmap_node(header, node->right);
+		if (detail_sdpmap_height(header, child->left) > detail_sdpmap_height(header, child->right))
+		{
+			node->right = detail_sdpmap_writable(header, slot_size, node->right);
+			node->right = detail_sdpmap_rotate_r(header, slot_size, node->right);
+		}
+		return detail_sdpmap_rotate_l(header, slot_size, index);
+	}
+	if (balance < -1)
+	{
+		child = detail_sdpmap_node(header, node->left);
+		if (detail_sdpmap_height(header, child->right) > detail_sdpmap_height(header, child->left))
+		{
+			node->left = detail_sdpmap_writable(header, slot_size, node->left);
+			node->left = detail_sdpmap_rotate_l(header, slot_size, node->left);
+		}
+		return detail_sdpmap_rotate_r(header, slot_size, index);
+	}
+	return index;
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_insert(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	sdmap_index index,
+	const void *key,
+	sdmap_index *inserted)
+{
+	int compare_result;
+	sdmap_index child;
+	sdpmap_node *node;
+	if (index == (sdmap_index)-1)
+	{
+		index = detail_sdpmap_allocate(header, slot_size);
+		node = detail_sdpmap_node(header, index);
+		node->left = (sdmap_index)-1;
+		node->right = (sdmap_index)-1;
+		node->height = 0;
+		node->version = header->version;
+		memcpy(node + 1, key, key_size);
+		header->count++;
+		*inserted = index;
+		return index;
+	}
+	compare_result = header->compare_func(detail_sdpmap_key(header, index), key);
+	index = detail_sdpmap_writable(header, slot_size, index);
+	if (compare_result == 0)
+	{
+		*inserted = index;
+		return index;
+	}
+	if (compare_result > 0)
+	{
+		child = detail_sdpmap_insert(header, slot_size, key_size, detail_sdpmap_node(header, index)->left, key, inserted);
+		detail_sdpmap_node(header, index)->left = child;
+	}
+	else
+	{
+		child = detail_sdpmap_insert(header, slot_size, key_size, detail_sdpmap_node(header, index)->right, key, inserted);
+		detail_sdpmap_node(header, index)->right = child;
+	}
+	return detail_sdpmap_balance(header, slot_size, index);
+}
+
+SDPMAP_API void *detail_sdpmap_set_impl(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	uint32_t key_size,
+	uint32_t value_offset,
+	const void *key)
+{
+	sdmap_index inserted;
+	sdpmap_assert(header->compare_func != NULL && "sdpmap does not have a compare function");
+	header->root = detail_sdpmap_insert(header, slot_size, key_size, header->root, key, &inserted);
+	header->dirty = 1;
+	return (char *)detail_sdpmap_node(header, inserted) + value_offset;
+}
+
+/*Unlink the smallest node of a subtree, it is made writable and returned in minimum*/
+SDPMAP_API sdmap_index detail_sdpmap_erase_min(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index,
+	sdmap_index *minimum)
+{
+	sdmap_index child;
+	if (detail_sdpmap_node(header, index)->left == (sdmap_index)-1)
+	{
+		*minimum = detail_sdpmap_writable(header, slot_size, index);
+		return detail_sdpmap_node(header, *minimum)->right;
+	}
+	child = detail_sdpmap_erase_min(header, slot_size, detail_sdpmap_node(header, index)->left, minimum);
+	index = detail_sdpmap_writable(header, slot_size, index);
+	detail_sdpmap_node(header, index)->left = child;
+	return detail_sdpmap_balance(header, slot_size, index);
+}
+
+SDPMAP_API sdmap_index detail_sdpmap_erase(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	sdmap_index index,
+	const void *key,
+	int *found)
+{
+	int compare_result;
+	sdmap_index left;
+	sdmap_index right;
+	sdmap_index child;
+	if (index == (sdmap_index)-1)
+	{
+		return index;
+	}
+	compare_result = header->compare_func(detail_sdpmap_key(header, index), key);
+	if (compare_result != 0)
+	{
+		child = compare_result > 0 ? detail_sdpmap_node(header, index)->left : detail_sdpmap_node(header, index)->right;
+		child = detail_sdpmap_erase(header, slot_size, child, key, found);
+		if (!*found)
+		{
+			return index;
+		}
+		index = detail_sdpmap_writable(header, slot_size, index);
+		if (compare_result > 0)
+		{
+			detail_sdpmap_node(header, index)->left = child;
+		}
+		else
+		{
+			detail_sdpmap_node(header, index)->right = child;
+		}
+		return detail_sdpmap_balance(header, slot_size, index);
+	}
+	*found = 1;
+	left = detail_sdpmap_node(header, index)->left;
+	right = detail_sdpmap_node(header, index)->right;
+	detail_sdpmap_dispose(header, slot_size, index);
+	if (left == (sdmap_index)-1)
+	{
+		return right;
+	}
+	if (right == (sdmap_index)-1)
+	{
+		return left;
+	}
+	right = detail_sdpmap_erase_min(header, slot_size, right, &index);
+	detail_sdpmap_node(header, index)->left = left;
+	detail_sdpmap_node(header, index)->right = right;
+	return detail_sdpmap_balance(header, slot_size, index);
+}
+
+SDPMAP_API void detail_sdpmap_erase_impl(
+	sdpmap_header *header,
+	uint32_t slot_size,
+	const void *key)
+{
+	int found = 0;
+	if (header == NULL)
+	{
+		return;
+	}
+	header->root = detail_sdpmap_erase(header, slot_size, header->root, key, &found);
+	if (found)
+	{
+		header->count--;
+		header->dirty = 1;
+	}
+}
+
+SDPMAP_API struct sdpmap_version *detail_sdpmap_snapshot_impl(
+	sdpmap_header *header,
+	uint32_t slot_size)
+{
+	struct sdpmap_version *version;
+	detail_sdpmap_reclaim_impl(header, slot_size);
+	if (header->newest != NULL && !header->dirty)
+	{
+		atomic_fetch_add(&header->newest->refs, 1);
+		return header->newest;
+	}
+	version = sdpmap_malloc(sizeof(struct sdpmap_version));
+	sdpmap_assert(version != NULL && "sdpmap_malloc returned NULL");
+	version->next = NULL;
+	version->header = header;
+	version->root = header->root;
+	version->count = header->count;
+	version->number = header->version;
+	atomic_init(&version->refs, 1);
+	version->retired = NULL;
+	version->retired_count = 0;
+	version->retired_capacity = 0;
+	if (header->newest != NULL)
+	{
+		header->newest->next = version;
+	}
+	else
+	{
+		header->oldest = version;
+	}
+	header->newest = version;
+	header->version++;
+	header->dirty = 0;
+	return version;
+}
+
+SDPMAP_API void detail_sdpmap_release_impl(struct sdpmap_version **version)
+{
+	if (*version != NULL)
+	{
+		atomic_fetch_sub(&(*version)->refs, 1);
+		*version = NULL;
+	}
+}
+
+SDPMAP_API void detail_sdpmap_reclaim_impl(
+	sdpmap_header *header,
+	uint32_t slot_size)
+{
+	sdmap_index i;
+	struct sdpmap_version *version;
+	if (header == NULL)
+	{
+		return;
+	}
+	/*A version can go once nothing holds it or anything older*/
+	while (header->oldest != NULL && atomic_load(&header->oldest->refs) == 0)
+	{
+		version = header->oldest;
+		for (i = 0; i < version->retired_count; i++)
+		{
+			detail_sdpmap_node(header, version->retired[i])->left = header->free_node;
+			header->free_node = version->retired[i];
+		}
+		header->oldest = version->next;
+		if (header->newest == version)
+		{
+			header->newest = NULL;
+		}
+		sdpmap_free(version->retired);
+		sdpmap_free(version);
+	}
+}
+
+SDPMAP_API void detail_sdpmap_delete_impl(sdpmap_header **header)
+{
+	unsigned i;
+	struct sdpmap_version *version;
+	if (*header == NULL)
+	{
+		return;
+	}
+	while ((*header)->oldest != NULL)
+	{
+		version = (*header)->oldest;
+		sdpmap_assert(atomic_load(&version->refs) == 0 && "sdpmap deleted while a snapshot is held");
+		(*header)->oldest = version->next;
+		sdpmap_free(version->retired);
+		sdpmap_free(version);
+	}
+	for (i = 0; i < sizeof((*header)->chunks) / sizeof(*(*header)->chunks); i++)
+	{
+		sdpmap_free((*header)->chunks[i]);
+	}
+	sdpmap_free(*header);
+	*header = NULL;
+}
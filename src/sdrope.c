@@ -0,0 +1,364 @@
+#include <sdrope.h>
+
+#define detail_sdrope_weight(node) ((node) == NULL ? 0 : (node)->weight)
+
+static void detail_sdrope_update(sdrope_node *node)
+{
+	node->weight = detail_sdrope_weight(node->left) + node->size + detail_sdrope_weight(node->right);
+}
+
+static sdrope_node *detail_sdrope_alloc(const char *data, sdstr_index size)
+{
+	sdrope_node *node;
+	uint64_t hash;
+	node = sdstr_malloc(sizeof(sdrope_node) + SDROPE_CHUNK_SIZE);
+	sdstr_assert(node != NULL && "sdstr_malloc returned NULL");
+	node->left = NULL;
+	node->right = NULL;
+	node->size = size;
+	node->weight = size;
+	/*Mixing the address gives a random enough priority without any state*/
+	hash = (uint64_t)(uintptr_t)node;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9u;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBu;
+	node->priority = (uint32_t)(hash ^ (hash >> 31));
+	memcpy(node->bytes, data, size);
+	return node;
+}
+
+static void detail_sdrope_free(sdrope_node *node)
+{
+	if (node == NULL)
+	{
+		return;
+	}
+	detail_sdrope_free(node->left);
+	detail_sdrope_free(node->right);
+	sdstr_free(node);
+}
+
+/*Joins two ropes, every byte of left ends up in front of right*/
+static sdrope_node *detail_sdrope_merge(sdrope_node *left, sdrope_node *right)
+{
+	if (left == NULL)
+	{
+		return right;
+	}
+	if (right == NULL)
+	{
+		return left;
+	}
+	if (left->priority > right->priority)
+	{
+		left->right = detail_sdrope_merge(left->right, right);
+		detail_sdrope_update(left);
+		return left;
+	}
+	right->left = detail_sdrope_merge(left, right->left);
+	detail_sdrope_update(right);
+	return right;
+}
+
+/*Splits a rope into the first index bytes and the rest, a chunk that
+straddles the index is split into two. The new chunk may have a higher
+priority than the nodes above it, so they are merged back instead of just
+linked, which is as cheap when it doesn't*/
+static void detail_sdrope_split(
+	sdrope_node *node,
+	sdstr_index index,
+	sdrope_node **left,
+	sdrope_node **right)
+{
+	sdrope_node *rest;
+	sdstr_index left_weight;
+	if (node == NULL)
+	{
+		*left = NULL;
+		*right = NULL;
+		return;
+	}
+	left_weight = detail_sdrope_weight(node->left);
+	if (index <= left_weight)
+	{
+		detail_sdrope_split(node->left, index, left, &rest);
+		node->left = NULL;
+		detail_sdrope_update(node);
+		*right = detail_sdrope_merge(rest, node);
+	}
+	else if (index >= left_weight + node->size)
+	{
+		detail_sdrope_split(node->right, index - left_weight - node->size, &rest, right);
+		node->right = NULL;
+		detail_sdrope_update(node);
+		*left = detail_sdrope_merge(node, rest);
+	}
+	else
+	{
+		index -= left_weight;
+		rest = detail_sdrope_alloc(node->bytes + index, node->size - index);
+		node->size = index;
+		*right = detail_sdrope_merge(rest, node->right);
+		node->right = NULL;
+		detail_sdrope_update(node);
+		*left = node;
+	}
+}
+
+/*Joins two ropes like merge, the chunks on both sides of the seam are
+combined when they fit in one so edits don't leave many small chunks*/
+static sdrope_node *detail_sdrope_join(sdrope_node *left, sdrope_node *right)
+{
+	sdrope_node *last;
+	sdrope_node *first;
+	sdrope_node *rest;
+	if (left == NULL || right == NULL)
+	{
+		return detail_sdrope_merge(left, right);
+	}
+	last = left;
+	while (last->right != NULL)
+	{
+		last = last->right;
+	}
+	first = right;
+	while (first->left != NULL)
+	{
+		first = first->left;
+	}
+	if (last->size + first->size > SDROPE_CHUNK_SIZE)
+	{
+		return detail_sdrope_merge(left, right);
+	}
+	detail_sdrope_split(left, left->weight - last->size, &left, &last);
+	detail_sdrope_split(right, first->size, &first, &right);
+	memcpy(last->bytes + last->size, first->bytes, first->size);
+	last->size += first->size;
+	detail_sdrope_update(last);
+	sdstr_free(first);
+	rest = detail_sdrope_merge(last, right);
+	return detail_sdrope_merge(left, rest);
+}
+
+/*Tries to replace count bytes at index with value inside of one chunk*/
+static int detail_sdrope_splice_in_place(
+	sdrope_node *node,
+	sdstr_index index,
+	sdstr_index count,
+	detail_sdstr_bytes value)
+{
+	sdstr_index left_weight;
+	int result;
+	if (node == NULL)
+	{
+		return 0;
+	}
+	left_weight = detail_sdrope_weight(node->left);
+	if (index < left_weight)
+	{
+		result = detail_sdrope_splice_in_place(node->left, index, count, value);
+	}
+	else if (index > left_weight + node->size ||
+		(index == left_weight + node->size && count > 0))
+	{
+		result = detail_sdrope_splice_in_place(node->right, index - left_weight - node->size, count, value);
+	}
+	else
+	{
+		index -= left_weight;
+		/*Chunks never become empty, and the value may be in the bytes that
+		are moved*/
+		if (index + count > node->size ||
+			node->size - count + value.size > SDROPE_CHUNK_SIZE ||
+			node->size - count + value.size == 0 ||
+			((uintptr_t)value.data >= (uintptr_t)node->bytes &&
+				(uintptr_t)value.data <= (uintptr_t)(node->bytes + SDROPE_CHUNK_SIZE)))
+		{
+			return 0;
+		}
+		memmove(node->bytes + index + value.size,
+			node->bytes + index + count,
+			node->size - index - count);
+		memcpy(node->bytes + index, value.data, value.size);
+		node->size = node->size - count + value.size;
+		result = 1;
+	}
+	if (result)
+	{
+		node->weight = node->weight - count + value.size;
+	}
+	return result;
+}
+
+/*Builds a rope of full chunks from bytes*/
+static sdrope_node *detail_sdrope_build(const char *data, sdstr_index size)
+{
+	sdrope_node *result;
+	sdstr_index chunk_size;
+	result = NULL;
+	while (size > 0)
+	{
+		chunk_size = size < SDROPE_CHUNK_SIZE ? size : SDROPE_CHUNK_SIZE;
+		result = detail_sdrope_merge(result, detail_sdrope_alloc(data, chunk_size));
+		data += chunk_size;
+		size -= chunk_size;
+	}
+	return result;
+}
+
+/*Copies count bytes starting at index, returns how many there were*/
+static sdstr_index detail_sdrope_copy(
+	sdrope_node *node,
+	sdstr_index index,
+	sdstr_index count,
+	char *buffer)
+{
+	sdstr_index left_weight;
+	sdstr_index copied;
+	sdstr_index size;
+	if (node == NULL || count == 0)
+	{
+		return 0;
+	}
+	left_weight = detail_sdrope_weight(node->left);
+	copied = 0;
+	if (index < left_weight)
+	{
+		copied = detail_sdrope_copy(node->left, index, count, buffer);
+		index = left_weight;
+	}
+	if (copied < count && index < left_weight + node->size)
+	{
+		size = left_weight + node->size - index;
+		if (size > count - copied)
+		{
+			size = count - copied;
+		}
+		memcpy(buffer + copied, node->bytes + index - left_weight, size);
+		copied += size;
+		index += size;
+	}
+	if (copied < count)
+	{
+		copied += detail_sdrope_copy(node->right,
+			index - left_weight - node->size,
+			count - copied,
+			buffer + copied);
+	}
+	return copied;
+}
+
+SDSTR_API sdstr_index detail_sdrope_size_impl(sdrope_node *rope)
+{
+	return detail_sdrope_weight(rope);
+}
+
+SDSTR_API char detail_sdrope_get_impl(sdrope_node *rope, sdstr_index index)
+{
+	sdstr_index size;
+	const char *chunk;
+	chunk = detail_sdrope_chunk_impl(rope, index, &size);
+	return chunk == NULL ? '\0' : *chunk;
+}
+
+SDSTR_API const char *detail_sdrope_chunk_impl(
+	sdrope_node *rope,
+	sdstr_index index,
+	sdstr_index *size)
+{
+	sdstr_index left_weight;
+	while (rope != NULL)
+	{
+		left_weight = detail_sdrope_weight(rope->left);
+		if (index < left_weight)
+		{
+			rope = rope->left;
+		}
+		else if (index < left_weight + rope->size)
+		{
+			*size = left_weight + rope->size - index;
+			return rope->bytes + index - left_weight;
+		}
+		else
+		{
+			index -= left_weight + rope->size;
+			rope = rope->right;
+		}
+	}
+	*size = 0;
+	return NULL;
+}
+
+SDSTR_API sdstr_index detail_sdrope_copy_impl(
+	sdrope_node *rope,
+	sdstr_index index,
+	sdstr_index count,
+	char *buffer)
+{
+	return detail_sdrope_copy(rope, index, count, buffer);
+}
+
+SDSTR_API void detail_sdrope_new_impl(sdrope_node **rope, const char *data, sdstr_index size)
+{
+	*rope = detail_sdrope_build(data, size);
+}
+
+SDSTR_API void detail_sdrope_to_str_impl(sdrope_node *rope, void *str, sdstr_index kind)
+{
+	detail_sdstr_bytes value;
+	char *buffer;
+	/*Goes through a buffer, the chunks of a UTF-8 str on their own may not
+	be valid*/
+	value.size = detail_sdrope_weight(rope);
+	buffer = sdstr_malloc((size_t)value.size + 1);
+	sdstr_assert(buffer != NULL && "sdstr_malloc returned NULL");
+	detail_sdrope_copy(rope, 0, value.size, buffer);
+	value.data = buffer;
+	detail_sdstr_new_impl(str, kind, value, 0);
+	sdstr_free(buffer);
+}
+
+SDSTR_API void detail_sdrope_splice_impl(
+	sdrope_node **rope,
+	sdstr_index index,
+	sdstr_index count,
+	detail_sdstr_bytes value)
+{
+	sdrope_node *left;
+	sdrope_node *middle;
+	sdrope_node *right;
+	char *copy;
+	sdstr_assert(index <= detail_sdrope_weight(*rope) && "position is not in the rope");
+	if (count > detail_sdrope_weight(*rope) - index)
+	{
+		count = detail_sdrope_weight(*rope) - index;
+	}
+	if ((count == 0 && value.size == 0) ||
+		detail_sdrope_splice_in_place(*rope, index, count, value))
+	{
+		return;
+	}
+	copy = NULL;
+	/*The value may be a part of a chunk that is freed below*/
+	if (count > 0)
+	{
+		copy = sdstr_malloc(value.size > 0 ? value.size : 1);
+		sdstr_assert(copy != NULL && "sdstr_malloc returned NULL");
+		memcpy(copy, value.data, value.size);
+		value.data = copy;
+	}
+	detail_sdrope_split(*rope, index, &left, &right);
+	detail_sdrope_split(right, count, &middle, &right);
+	detail_sdrope_free(middle);
+	middle = detail_sdrope_build(value.data, value.size);
+	*rope = detail_sdrope_join(detail_sdrope_join(left, middle), right);
+	if (copy != NULL)
+	{
+		sdstr_free(copy);
+	}
+}
+
+SDSTR_API void detail_sdrope_delete_impl(sdrope_node **rope)
+{
+	detail_sdrope_free(*rope);
+	*rope = NULL;
+}
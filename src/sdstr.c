@@ -1 +1,2593 @@
-#include <sdstr.h>
\ No newline at end of file
+#include <sdstr.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i detail_sdstr_vector;
+#define detail_sdstr_vector_size 32
+#define detail_sdstr_splat(byte) _mm256_set1_epi8((char)(byte))
+#define detail_sdstr_match(vector, data) ((uint32_t)_mm256_movemask_epi8(\
+	_mm256_cmpeq_epi8(vector, _mm256_loadu_si256((const __m256i *)(const void *)(data)))))
+#define detail_sdstr_greater(vector, data) ((uint32_t)_mm256_movemask_epi8(\
+	_mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i *)(const void *)(data)), vector)))
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+typedef __m128i detail_sdstr_vector;
+#define detail_sdstr_vector_size 16
+#define detail_sdstr_splat(byte) _mm_set1_epi8((char)(byte))
+#define detail_sdstr_match(vector, data) ((uint32_t)_mm_movemask_epi8(\
+	_mm_cmpeq_epi8(vector, _mm_loadu_si128((const __m128i *)(const void *)(data)))))
+#define detail_sdstr_greater(vector, data) ((uint32_t)_mm_movemask_epi8(\
+	_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i *)(const void *)(data)), vector)))
+#endif
+
+#if defined(__GNUC__)
+#define detail_sdstr_lowest_bit(mask) ((uint32_t)__builtin_ctz(mask))
+#define detail_sdstr_highest_bit(mask) (31u - (uint32_t)__builtin_clz(mask))
+#define detail_sdstr_popcount(mask) ((uint32_t)__builtin_popcount(mask))
+#else
+static uint32_t detail_sdstr_popcount(uint32_t mask)
+{
+	uint32_t result;
+	result = 0;
+	while (mask != 0)
+	{
+		mask &= mask - 1;
+		result++;
+	}
+	return result;
+}
+
+static uint32_t detail_sdstr_lowest_bit(uint32_t mask)
+{
+	uint32_t result;
+	result = 0;
+	while ((mask & 1u) == 0)
+	{
+		mask >>= 1;
+		result++;
+	}
+	return result;
+}
+
+static uint32_t detail_sdstr_highest_bit(uint32_t mask)
+{
+	uint32_t result;
+	result = 0;
+	while (mask > 1u)
+	{
+		mask >>= 1;
+		result++;
+	}
+	return result;
+}
+#endif
+
+#define detail_sdstr_not_found ((size_t)-1)
+
+#define detail_sdstr_small_tag(str)\
+	(((unsigned char *)((sdstr_small *)(str))->bytes)[SDSTR_SMALL_CAPACITY + 1])
+
+#define detail_sdstr_small_on_heap 0xFF
+
+#define detail_sdstr_is_stack(kind) ((kind) > detail_sdstr_kind_view)
+
+#define detail_sdstr_is_continuation(byte) ((((unsigned char)(byte)) & 0xC0) == 0x80)
+
+/*Where the bytes of a str are, whatever its kind*/
+typedef struct detail_sdstr_state
+{
+	char *data;
+	sdstr_index size;
+	sdstr_index count;
+	sdstr_index capacity;
+} detail_sdstr_state;
+
+/*Heap-type UTF-8 strs keep the byte offset of every
+SDSTR_UTF8_INDEX_STRIDE-th code point in front of their heap header*/
+typedef struct detail_sdstr_utf8_heap
+{
+	sdstr_index *offsets;
+	sdstr_index offset_count;
+	sdstr_index offset_capacity;
+	sdstr_heap heap;
+} detail_sdstr_utf8_heap;
+
+/*Bytes in front of the data of a heap block*/
+#define detail_sdstr_prefix(kind) ((kind) == detail_sdstr_kind_utf8 ?\
+	offsetof(detail_sdstr_utf8_heap, heap) + sizeof(sdstr_heap) :\
+	sizeof(sdstr_heap))
+
+static sdstr_heap *detail_sdstr_heap(char *data)
+{
+	return (sdstr_heap *)((void *)(data - sizeof(sdstr_heap)));
+}
+
+static detail_sdstr_utf8_heap *detail_sdstr_utf8_heap_of(char *data)
+{
+	return (detail_sdstr_utf8_heap *)((void *)(data - detail_sdstr_prefix(detail_sdstr_kind_utf8)));
+}
+
+/*Returns the bytes of a heap-type str or a small-type str that has moved to
+the heap, NULL otherwise*/
+static char *detail_sdstr_load_heap(void *str, sdstr_index kind)
+{
+	char *result;
+	if (detail_sdstr_is_stack(kind) || kind == detail_sdstr_kind_view)
+	{
+		return NULL;
+	}
+	if (kind == detail_sdstr_kind_small)
+	{
+		if (detail_sdstr_small_tag(str) != detail_sdstr_small_on_heap)
+		{
+			return NULL;
+		}
+		/*The pointer in the bytes isn't necessarily aligned*/
+		memcpy(&result, ((sdstr_small *)str)->bytes, sizeof(char *));
+		return result;
+	}
+	return *(char **)str;
+}
+
+static void detail_sdstr_store_heap(void *str, sdstr_index kind, char *data)
+{
+	if (kind == detail_sdstr_kind_small)
+	{
+		memcpy(((sdstr_small *)str)->bytes, &data, sizeof(char *));
+		detail_sdstr_small_tag(str) = detail_sdstr_small_on_heap;
+		return;
+	}
+	*(char **)str = data;
+}
+
+static detail_sdstr_state detail_sdstr_read(void *str, sdstr_index kind)
+{
+	detail_sdstr_state state;
+	sdstr_header header;
+	sdstr_heap *heap;
+	if (detail_sdstr_is_stack(kind))
+	{
+		/*Stack-type strs keep their header at the end, possibly unaligned*/
+		memcpy(&header, (char *)str + kind - sizeof(sdstr_header), sizeof(sdstr_header));
+		state.data = str;
+		state.size = header.size;
+		state.count = header.count;
+		state.capacity = kind - sizeof(sdstr_header) - 1;
+		return state;
+	}
+	if (kind == detail_sdstr_kind_small &&
+		detail_sdstr_small_tag(str) != detail_sdstr_small_on_heap)
+	{
+		state.data = ((sdstr_small *)str)->bytes;
+		state.size = detail_sdstr_small_tag(str);
+		state.count = state.size;
+		state.capacity = SDSTR_SMALL_CAPACITY;
+		return state;
+	}
+	if (kind == detail_sdstr_kind_view)
+	{
+		/*Views are only read, the bytes aren't modified through data*/
+		state.data = (char *)((sdstr_view *)str)->data;
+		state.size = state.data == NULL ? 0 : ((sdstr_view *)str)->size;
+		state.count = state.size;
+		state.capacity = state.size;
+		return state;
+	}
+	state.data = detail_sdstr_load_heap(str, kind);
+	if (state.data == NULL)
+	{
+		state.size = 0;
+		state.count = 0;
+		state.capacity = 0;
+		return state;
+	}
+	heap = detail_sdstr_heap(state.data);
+	state.size = heap->header.size;
+	state.count = heap->header.count;
+	state.capacity = heap->capacity;
+	return state;
+}
+
+/*Stores the size and count of the state and terminates the bytes*/
+static void detail_sdstr_write(void *str, sdstr_index kind, detail_sdstr_state *state)
+{
+	sdstr_header header;
+	sdstr_heap *heap;
+	if (state->data == NULL)
+	{
+		return;
+	}
+	state->data[state->size] = '\0';
+	if (detail_sdstr_is_stack(kind))
+	{
+		header.size = state->size;
+		header.count = state->count;
+		memcpy((char *)str + kind - sizeof(sdstr_header), &header, sizeof(sdstr_header));
+	}
+	else if (kind == detail_sdstr_kind_small &&
+		detail_sdstr_small_tag(str) != detail_sdstr_small_on_heap)
+	{
+		detail_sdstr_small_tag(str) = (unsigned char)state->size;
+	}
+	else
+	{
+		heap = detail_sdstr_heap(state->data);
+		heap->header.size = state->size;
+		heap->header.count = state->count;
+	}
+}
+
+/*Moves the bytes to a heap block that fits capacity bytes*/
+static void detail_sdstr_realloc(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_state *state,
+	sdstr_index capacity)
+{
+	detail_sdstr_utf8_heap *utf8_heap;
+	char *block;
+	char *inline_data;
+	size_t prefix;
+	inline_data = NULL;
+	prefix = detail_sdstr_prefix(kind);
+	if (kind == detail_sdstr_kind_small &&
+		detail_sdstr_small_tag(str) != detail_sdstr_small_on_heap)
+	{
+		inline_data = state->data;
+		block = sdstr_malloc(prefix + (size_t)capacity + 1);
+	}
+	else
+	{
+		block = sdstr_realloc(state->data == NULL ? NULL : state->data - prefix,
+			prefix + (size_t)capacity + 1);
+	}
+	sdstr_assert(block != NULL && "sdstr_realloc returned NULL");
+	if (kind == detail_sdstr_kind_utf8 && state->data == NULL)
+	{
+		utf8_heap = (detail_sdstr_utf8_heap *)((void *)block);
+		utf8_heap->offsets = NULL;
+		utf8_heap->offset_count = 0;
+		utf8_heap->offset_capacity = 0;
+	}
+	state->data = block + prefix;
+	detail_sdstr_heap(state->data)->capacity = capacity;
+	state->capacity = capacity;
+	if (inline_data != NULL)
+	{
+		memcpy(state->data, inline_data, state->size);
+	}
+	detail_sdstr_store_heap(str, kind, state->data);
+	detail_sdstr_write(str, kind, state);
+}
+
+/*Capacity to grow to for at least size bytes*/
+static sdstr_index detail_sdstr_grown_capacity(sdstr_index capacity, sdstr_index size)
+{
+	capacity *= 2;
+	if (capacity < SDSTR_DEFAULT_CAPACITY)
+	{
+		capacity = SDSTR_DEFAULT_CAPACITY;
+	}
+	if (capacity < size)
+	{
+		capacity = size;
+	}
+	return capacity;
+}
+
+static void detail_sdstr_grow(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_state *state,
+	sdstr_index size)
+{
+	if (size <= state->capacity)
+	{
+		return;
+	}
+	sdstr_assert(!detail_sdstr_is_stack(kind) && "sdstr_stack capacity exceeded");
+	detail_sdstr_realloc(str, kind, state, detail_sdstr_grown_capacity(state->capacity, size));
+}
+
+static void detail_sdstr_autoshrink(void *str, sdstr_index kind, detail_sdstr_state *state)
+{
+	char *data;
+	if (!SDSTR_ENABLE_AUTOSHRINK ||
+		detail_sdstr_load_heap(str, kind) == NULL ||
+		state->capacity <= SDSTR_DEFAULT_CAPACITY ||
+		state->capacity < state->size * SDSTR_SHRINK_DENOMINATOR)
+	{
+		return;
+	}
+	if (kind == detail_sdstr_kind_small && state->size <= SDSTR_SMALL_CAPACITY)
+	{
+		/*Fits inline again*/
+		data = state->data;
+		memcpy(((sdstr_small *)str)->bytes, data, state->size);
+		sdstr_free(detail_sdstr_heap(data));
+		detail_sdstr_small_tag(str) = 0;
+		state->data = ((sdstr_small *)str)->bytes;
+		state->capacity = SDSTR_SMALL_CAPACITY;
+		detail_sdstr_write(str, kind, state);
+		return;
+	}
+	detail_sdstr_realloc(str, kind, state,
+		state->size > SDSTR_DEFAULT_CAPACITY ? state->size : SDSTR_DEFAULT_CAPACITY);
+}
+
+/*Counts the bytes that aren't continuation bytes, which are the only ones
+below -0x40 as signed bytes*/
+static sdstr_index detail_sdstr_count_utf8(const char *data, size_t size)
+{
+	sdstr_index result;
+	size_t i;
+	result = 0;
+	i = 0;
+#if defined(detail_sdstr_vector_size)
+	{
+		detail_sdstr_vector bound;
+		bound = detail_sdstr_splat(-0x41);
+		for (; i + detail_sdstr_vector_size <= size; i += detail_sdstr_vector_size)
+		{
+			result += detail_sdstr_popcount(detail_sdstr_greater(bound, data + i));
+		}
+	}
+#endif
+	for (; i < size; i++)
+	{
+		result += !detail_sdstr_is_continuation(data[i]);
+	}
+	return result;
+}
+
+#if !defined(__AVX2__)
+static int detail_sdstr_validate_utf8_scalar(const char *data, size_t size)
+{
+	const unsigned char *bytes;
+	size_t i;
+	bytes = (const unsigned char *)data;
+	i = 0;
+	while (i < size)
+	{
+		if (bytes[i] < 0x80)
+		{
+#if defined(detail_sdstr_vector_size)
+			{
+				detail_sdstr_vector bound;
+				bound = detail_sdstr_splat(-1);
+				/*Runs of ASCII are skipped a vector at a time*/
+				while (i + detail_sdstr_vector_size <= size &&
+					detail_sdstr_greater(bound, data + i) == (uint32_t)-1 >> (32 - detail_sdstr_vector_size))
+				{
+					i += detail_sdstr_vector_size;
+				}
+			}
+#endif
+			while (i < size && bytes[i] < 0x80)
+			{
+				i++;
+			}
+			continue;
+		}
+		if (bytes[i] < 0xC2)
+		{
+			/*A stray continuation byte or an overlong 2 byte sequence*/
+			return 0;
+		}
+		if (bytes[i] < 0xE0)
+		{
+			if (size - i < 2 || !detail_sdstr_is_continuation(bytes[i + 1]))
+			{
+				return 0;
+			}
+			i += 2;
+		}
+		else if (bytes[i] < 0xF0)
+		{
+			if (size - i < 3 ||
+				!detail_sdstr_is_continuation(bytes[i + 1]) ||
+				!detail_sdstr_is_continuation(bytes[i + 2]) ||
+				(bytes[i] == 0xE0 && bytes[i + 1] < 0xA0) ||
+				(bytes[i] == 0xED && bytes[i + 1] >= 0xA0))
+			{
+				return 0;
+			}
+			i += 3;
+		}
+		else if (bytes[i] < 0xF5)
+		{
+			if (size - i < 4 ||
+				!detail_sdstr_is_continuation(bytes[i + 1]) ||
+				!detail_sdstr_is_continuation(bytes[i + 2]) ||
+				!detail_sdstr_is_continuation(bytes[i + 3]) ||
+				(bytes[i] == 0xF0 && bytes[i + 1] < 0x90) ||
+				(bytes[i] == 0xF4 && bytes[i + 1] >= 0x90))
+			{
+				return 0;
+			}
+			i += 4;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+#endif
+
+#if defined(__AVX2__)
+/*Error classes of the lookup tables, an error is found where all three
+lookups for a pair of bytes share a class*/
+#define detail_sdstr_too_short (1 << 0)
+#define detail_sdstr_too_long (1 << 1)
+#define detail_sdstr_overlong_3 (1 << 2)
+#define detail_sdstr_too_large (1 << 3)
+#define detail_sdstr_surrogate (1 << 4)
+#define detail_sdstr_overlong_2 (1 << 5)
+#define detail_sdstr_too_large_1000 (1 << 6)
+#define detail_sdstr_overlong_4 (1 << 6)
+#define detail_sdstr_two_conts (-0x80)
+#define detail_sdstr_carry\
+	(detail_sdstr_too_short | detail_sdstr_too_long | detail_sdstr_two_conts)
+
+#define detail_sdstr_table(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+/*Bytes that end the input before the sequence they start is complete*/
+#define detail_sdstr_incomplete(input) _mm256_subs_epu8(input, _mm256_setr_epi8(\
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,\
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,\
+	(char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1)))
+
+/*Lookup-table validation, every byte is checked against the 3 before it
+with 3 nibble lookups and a check for missing 3rd and 4th bytes*/
+static int detail_sdstr_validate_utf8(const char *data, size_t size, sdstr_index *count)
+{
+	__m256i byte_1_high_table;
+	__m256i byte_1_low_table;
+	__m256i byte_2_high_table;
+	__m256i nibble;
+	__m256i bound;
+	__m256i input;
+	__m256i previous_input;
+	__m256i previous_incomplete;
+	__m256i error;
+	__m256i shifted;
+	__m256i previous_1;
+	__m256i special_cases;
+	__m256i must_continue;
+	char tail[32];
+	uint32_t lanes;
+	size_t i;
+	byte_1_high_table = detail_sdstr_table(
+		detail_sdstr_too_long, detail_sdstr_too_long,
+		detail_sdstr_too_long, detail_sdstr_too_long,
+		detail_sdstr_too_long, detail_sdstr_too_long,
+		detail_sdstr_too_long, detail_sdstr_too_long,
+		detail_sdstr_two_conts, detail_sdstr_two_conts,
+		detail_sdstr_two_conts, detail_sdstr_two_conts,
+		detail_sdstr_too_short | detail_sdstr_overlong_2,
+		detail_sdstr_too_short,
+		detail_sdstr_too_short | detail_sdstr_overlong_3 | detail_sdstr_surrogate,
+		detail_sdstr_too_short | detail_sdstr_too_large | detail_sdstr_too_large_1000 | detail_sdstr_overlong_4);
+	byte_1_low_table = detail_sdstr_table(
+		detail_sdstr_carry | detail_sdstr_overlong_3 | detail_sdstr_overlong_2 | detail_sdstr_overlong_4,
+		detail_sdstr_carry | detail_sdstr_overlong_2,
+		detail_sdstr_carry,
+		detail_sdstr_carry,
+		detail_sdstr_carry | detail_sdstr_too_large,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000 | detail_sdstr_surrogate,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000,
+		detail_sdstr_carry | detail_sdstr_too_large | detail_sdstr_too_large_1000);
+	byte_2_high_table = detail_sdstr_table(
+		detail_sdstr_too_short, detail_sdstr_too_short,
+		detail_sdstr_too_short, detail_sdstr_too_short,
+		detail_sdstr_too_short, detail_sdstr_too_short,
+		detail_sdstr_too_short, detail_sdstr_too_short,
+		detail_sdstr_too_long | detail_sdstr_overlong_2 | detail_sdstr_two_conts |
+			detail_sdstr_overlong_3 | detail_sdstr_too_large_1000 | detail_sdstr_overlong_4,
+		detail_sdstr_too_long | detail_sdstr_overlong_2 | detail_sdstr_two_conts |
+			detail_sdstr_overlong_3 | detail_sdstr_too_large,
+		detail_sdstr_too_long | detail_sdstr_overlong_2 | detail_sdstr_two_conts |
+			detail_sdstr_surrogate | detail_sdstr_too_large,
+		detail_sdstr_too_long | detail_sdstr_overlong_2 | detail_sdstr_two_conts |
+			detail_sdstr_surrogate | detail_sdstr_too_large,
+		detail_sdstr_too_short, detail_sdstr_too_short,
+		detail_sdstr_too_short, detail_sdstr_too_short);
+	nibble = _mm256_set1_epi8(0x0F);
+	bound = _mm256_set1_epi8(-0x41);
+	previous_input = _mm256_setzero_si256();
+	previous_incomplete = _mm256_setzero_si256();
+	error = _mm256_setzero_si256();
+	*count = 0;
+	for (i = 0; i < size; i += 32)
+	{
+		lanes = (uint32_t)-1;
+		if (size - i >= 32)
+		{
+			input = _mm256_loadu_si256((const __m256i *)(const void *)(data + i));
+		}
+		else
+		{
+			/*The padding is ASCII, so a sequence cut short by it is an error*/
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, data + i, size - i);
+			input = _mm256_loadu_si256((const __m256i *)(const void *)tail);
+			lanes = (1u << (size - i)) - 1;
+		}
+		*count += detail_sdstr_popcount(lanes & (uint32_t)_mm256_movemask_epi8(
+			_mm256_cmpgt_epi8(input, bound)));
+		if (_mm256_movemask_epi8(input) == 0)
+		{
+			error = _mm256_or_si256(error, previous_incomplete);
+			previous_incomplete = _mm256_setzero_si256();
+			previous_input = input;
+			continue;
+		}
+		/*The previous bytes of every lane, reaching into the previous input*/
+		shifted = _mm256_permute2x128_si256(previous_input, input, 0x21);
+		previous_1 = _mm256_alignr_epi8(input, shifted, 15);
+		special_cases = _mm256_and_si256(
+			_mm256_and_si256(
+				_mm256_shuffle_epi8(byte_1_high_table,
+					_mm256_and_si256(_mm256_srli_epi16(previous_1, 4), nibble)),
+				_mm256_shuffle_epi8(byte_1_low_table,
+					_mm256_and_si256(previous_1, nibble))),
+			_mm256_shuffle_epi8(byte_2_high_table,
+				_mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+		/*Only 111_____ 2 bytes back and 1111____ 3 bytes back need a continuation*/
+		must_continue = _mm256_or_si256(
+			_mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14), _mm256_set1_epi8(0xE0 - 0x80)),
+			_mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13), _mm256_set1_epi8(0xF0 - 0x80)));
+		must_continue = _mm256_and_si256(must_continue, _mm256_set1_epi8(-0x80));
+		error = _mm256_or_si256(error, _mm256_xor_si256(must_continue, special_cases));
+		previous_incomplete = detail_sdstr_incomplete(input);
+		previous_input = input;
+	}
+	error = _mm256_or_si256(error, previous_incomplete);
+	return _mm256_testz_si256(error, error);
+}
+#else
+static int detail_sdstr_validate_utf8(const char *data, size_t size, sdstr_index *count)
+{
+	*count = 0;
+	if (!detail_sdstr_validate_utf8_scalar(data, size))
+	{
+		return 0;
+	}
+	*count = detail_sdstr_count_utf8(data, size);
+	return 1;
+}
+#endif
+
+/*Byte offset of pos, the size for NULL*/
+static sdstr_index detail_sdstr_offset(detail_sdstr_state *state, char *pos)
+{
+	if (pos == NULL)
+	{
+		return state->size;
+	}
+	sdstr_assert(pos >= state->data && pos <= state->data + state->size &&
+		"position is not in the str");
+	return (sdstr_index)(pos - state->data);
+}
+
+/*Pointer to offset, NULL for the end*/
+static char *detail_sdstr_at(detail_sdstr_state *state, sdstr_index offset)
+{
+	if (offset >= state->size)
+	{
+		return NULL;
+	}
+	return state->data + offset;
+}
+
+/*Byte offset of the code point count code points after the one at offset,
+the size if there aren't as many*/
+static sdstr_index detail_sdstr_skip(
+	const char *data,
+	sdstr_index size,
+	sdstr_index offset,
+	sdstr_index count)
+{
+#if defined(detail_sdstr_vector_size)
+	{
+		detail_sdstr_vector bound;
+		uint32_t leads;
+		bound = detail_sdstr_splat(-0x41);
+		/*Whole vectors are skipped while they don't hold the code point that
+		is looked for*/
+		while (offset + detail_sdstr_vector_size <= size)
+		{
+			leads = detail_sdstr_popcount(detail_sdstr_greater(bound, data + offset));
+			if (leads > count)
+			{
+				break;
+			}
+			count -= leads;
+			offset += detail_sdstr_vector_size;
+		}
+	}
+#endif
+	while (offset < size)
+	{
+		if (!detail_sdstr_is_continuation(data[offset]))
+		{
+			if (count == 0)
+			{
+				break;
+			}
+			count--;
+		}
+		offset++;
+	}
+	return offset;
+}
+
+/*Amount of bytes count characters take up starting from offset*/
+static sdstr_index detail_sdstr_span(
+	detail_sdstr_state *state,
+	sdstr_index kind,
+	sdstr_index offset,
+	sdstr_index count)
+{
+	if (kind != detail_sdstr_kind_utf8)
+	{
+		return count < state->size - offset ? count : state->size - offset;
+	}
+	return detail_sdstr_skip(state->data, state->size, offset, count) - offset;
+}
+
+/*Byte offset of the index-th code point of a heap-type UTF-8 str, the
+offsets up to it are found and remembered on the first lookup*/
+static sdstr_index detail_sdstr_utf8_offset(detail_sdstr_state *state, sdstr_index index)
+{
+	detail_sdstr_utf8_heap *heap;
+	sdstr_index entry;
+	sdstr_index capacity;
+	if (index < SDSTR_UTF8_INDEX_STRIDE)
+	{
+		return detail_sdstr_skip(state->data, state->size, 0, index);
+	}
+	heap = detail_sdstr_utf8_heap_of(state->data);
+	entry = index / SDSTR_UTF8_INDEX_STRIDE;
+	if (entry >= heap->offset_count)
+	{
+		if (entry >= heap->offset_capacity)
+		{
+			capacity = heap->offset_capacity * 2;
+			if (capacity < SDSTR_DEFAULT_CAPACITY)
+			{
+				capacity = SDSTR_DEFAULT_CAPACITY;
+			}
+			if (capacity <= entry)
+			{
+				capacity = entry + 1;
+			}
+			heap->offsets = sdstr_realloc(heap->offsets, sizeof(sdstr_index) * capacity);
+			sdstr_assert(heap->offsets != NULL && "sdstr_realloc returned NULL");
+			heap->offset_capacity = capacity;
+		}
+		if (heap->offset_count == 0)
+		{
+			heap->offsets[0] = 0;
+			heap->offset_count = 1;
+		}
+		for (; heap->offset_count <= entry; heap->offset_count++)
+		{
+			heap->offsets[heap->offset_count] = detail_sdstr_skip(state->data, state->size,
+				heap->offsets[heap->offset_count - 1], SDSTR_UTF8_INDEX_STRIDE);
+		}
+	}
+	return detail_sdstr_skip(state->data, state->size,
+		heap->offsets[entry], index % SDSTR_UTF8_INDEX_STRIDE);
+}
+
+/*Updates the offsets after size bytes at offset were replaced with
+value_size bytes. Offsets up to the edit are kept, the ones after it are
+moved if the amount of code points didn't change and forgotten otherwise*/
+static void detail_sdstr_utf8_patch(
+	char *data,
+	sdstr_index offset,
+	sdstr_index size,
+	sdstr_index value_size,
+	int same_count)
+{
+	detail_sdstr_utf8_heap *heap;
+	sdstr_index low;
+	sdstr_index high;
+	sdstr_index middle;
+	heap = detail_sdstr_utf8_heap_of(data);
+	low = 0;
+	high = heap->offset_count;
+	while (low < high)
+	{
+		middle = low + (high - low) / 2;
+		if (heap->offsets[middle] <= offset)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	if (!same_count ||
+		(low < heap->offset_count && heap->offsets[low] < offset + size))
+	{
+		heap->offset_count = low;
+		return;
+	}
+	for (; low < heap->offset_count; low++)
+	{
+		heap->offsets[low] = heap->offsets[low] - size + value_size;
+	}
+}
+
+static uint32_t detail_sdstr_decode(const char *data)
+{
+	const unsigned char *bytes;
+	bytes = (const unsigned char *)data;
+	if (bytes[0] < 0x80)
+	{
+		return bytes[0];
+	}
+	if (bytes[0] < 0xE0)
+	{
+		return ((uint32_t)(bytes[0] & 0x1F) << 6) | (bytes[1] & 0x3F);
+	}
+	if (bytes[0] < 0xF0)
+	{
+		return ((uint32_t)(bytes[0] & 0x0F) << 12) |
+			((uint32_t)(bytes[1] & 0x3F) << 6) |
+			(bytes[2] & 0x3F);
+	}
+	return ((uint32_t)(bytes[0] & 0x07) << 18) |
+		((uint32_t)(bytes[1] & 0x3F) << 12) |
+		((uint32_t)(bytes[2] & 0x3F) << 6) |
+		(bytes[3] & 0x3F);
+}
+
+/*Amount of characters in size bytes at offset, which have to start and end
+at code points in UTF-8 strs*/
+static sdstr_index detail_sdstr_count_range(
+	detail_sdstr_state *state,
+	sdstr_index kind,
+	sdstr_index offset,
+	sdstr_index size)
+{
+	if (kind != detail_sdstr_kind_utf8)
+	{
+		return size;
+	}
+	sdstr_assert((offset == state->size || !detail_sdstr_is_continuation(state->data[offset])) &&
+		(offset + size == state->size || !detail_sdstr_is_continuation(state->data[offset + size])) &&
+		"position is not at a code point");
+	return detail_sdstr_count_utf8(state->data + offset, size);
+}
+
+/*Replaces size bytes at offset with value, returns the new state*/
+static detail_sdstr_state detail_sdstr_replace_bytes(
+	void *str,
+	sdstr_index kind,
+	sdstr_index offset,
+	sdstr_index size,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index new_size;
+	sdstr_index value_count;
+	sdstr_index removed_count;
+	int valid;
+	char *copy;
+	state = detail_sdstr_read(str, kind);
+	if (size == 0 && value.size == 0)
+	{
+		return state;
+	}
+	copy = NULL;
+	/*The value may be a part of the str itself, which moves around below*/
+	if (state.data != NULL &&
+		(uintptr_t)value.data >= (uintptr_t)state.data &&
+		(uintptr_t)value.data <= (uintptr_t)(state.data + state.capacity))
+	{
+		copy = sdstr_malloc(value.size > 0 ? value.size : 1);
+		sdstr_assert(copy != NULL && "sdstr_malloc returned NULL");
+		memcpy(copy, value.data, value.size);
+		value.data = copy;
+	}
+	new_size = state.size - size + value.size;
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		/*Only the changed bytes are validated and counted*/
+		valid = detail_sdstr_validate_utf8(value.data, value.size, &value_count);
+		sdstr_assert(valid && "value is not valid UTF-8");
+		(void)valid;
+		removed_count = detail_sdstr_count_range(&state, kind, offset, size);
+		state.count = state.count - removed_count + value_count;
+	}
+	else
+	{
+		removed_count = 0;
+		value_count = 0;
+		state.count = new_size;
+	}
+	detail_sdstr_grow(str, kind, &state, new_size);
+	memmove(state.data + offset + value.size,
+		state.data + offset + size,
+		state.size - offset - size);
+	memcpy(state.data + offset, value.data, value.size);
+	state.size = new_size;
+	detail_sdstr_write(str, kind, &state);
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		detail_sdstr_utf8_patch(state.data, offset, size, value.size,
+			removed_count == value_count);
+	}
+	if (copy != NULL)
+	{
+		sdstr_free(copy);
+	}
+	if (size > value.size)
+	{
+		detail_sdstr_autoshrink(str, kind, &state);
+	}
+	return state;
+}
+
+SDSTR_API detail_sdstr_bytes detail_sdstr_cstr_impl(const char *value)
+{
+	detail_sdstr_bytes result;
+	result.data = value == NULL ? "" : value;
+	result.size = (sdstr_index)strlen(result.data);
+	return result;
+}
+
+/*An empty view may have no data, the library never hands NULL to memcpy*/
+SDSTR_API detail_sdstr_bytes detail_sdstr_view_impl(sdstr_view value)
+{
+	if (value.data == NULL)
+	{
+		value.data = "";
+	}
+	return value;
+}
+
+SDSTR_API detail_sdstr_bytes detail_sdstr_char_impl(
+	sdstr_index kind,
+	uint32_t value,
+	char *buffer)
+{
+	detail_sdstr_bytes result;
+	unsigned char *bytes;
+	bytes = (unsigned char *)buffer;
+	result.data = buffer;
+	if (kind != detail_sdstr_kind_utf8 || value < 0x80)
+	{
+		bytes[0] = (unsigned char)value;
+		result.size = 1;
+	}
+	else if (value < 0x800)
+	{
+		bytes[0] = (unsigned char)(0xC0 | (value >> 6));
+		bytes[1] = (unsigned char)(0x80 | (value & 0x3F));
+		result.size = 2;
+	}
+	else if (value < 0x10000)
+	{
+		bytes[0] = (unsigned char)(0xE0 | (value >> 12));
+		bytes[1] = (unsigned char)(0x80 | ((value >> 6) & 0x3F));
+		bytes[2] = (unsigned char)(0x80 | (value & 0x3F));
+		result.size = 3;
+	}
+	else
+	{
+		bytes[0] = (unsigned char)(0xF0 | (value >> 18));
+		bytes[1] = (unsigned char)(0x80 | ((value >> 12) & 0x3F));
+		bytes[2] = (unsigned char)(0x80 | ((value >> 6) & 0x3F));
+		bytes[3] = (unsigned char)(0x80 | (value & 0x3F));
+		result.size = 4;
+	}
+	return result;
+}
+
+SDSTR_API int detail_sdstr_utf8_valid_impl(detail_sdstr_bytes value)
+{
+	sdstr_index count;
+	return detail_sdstr_validate_utf8(value.data, value.size, &count);
+}
+
+SDSTR_API sdstr_index detail_sdstr_size_impl(void *str, sdstr_index kind)
+{
+	return detail_sdstr_read(str, kind).size;
+}
+
+SDSTR_API sdstr_index detail_sdstr_count_impl(void *str, sdstr_index kind)
+{
+	return detail_sdstr_read(str, kind).count;
+}
+
+SDSTR_API sdstr_index detail_sdstr_capacity_impl(void *str, sdstr_index kind)
+{
+	return detail_sdstr_read(str, kind).capacity;
+}
+
+SDSTR_API char *detail_sdstr_data_impl(void *str, sdstr_index kind)
+{
+	detail_sdstr_state state;
+	state = detail_sdstr_read(str, kind);
+	return state.data == NULL ? (char *)"" : state.data;
+}
+
+#define detail_sdstr_byte(data, size, i, reverse)\
+	((unsigned char)(data)[(reverse) ? (size) - 1 - (i) : (i)])
+
+/*Start of the maximal suffix of the needle for one ordering of the bytes,
+the needle is read back to front for reverse searches*/
+static size_t detail_sdstr_maximal_suffix(
+	const char *needle,
+	size_t needle_size,
+	int reverse,
+	int greater,
+	size_t *period)
+{
+	size_t suffix;
+	size_t candidate;
+	size_t k;
+	unsigned char a;
+	unsigned char b;
+	suffix = (size_t)-1;
+	candidate = 0;
+	k = 1;
+	*period = 1;
+	while (candidate + k < needle_size)
+	{
+		a = detail_sdstr_byte(needle, needle_size, suffix + k, reverse);
+		b = detail_sdstr_byte(needle, needle_size, candidate + k, reverse);
+		if (a == b)
+		{
+			if (k == *period)
+			{
+				candidate += *period;
+				k = 1;
+			}
+			else
+			{
+				k++;
+			}
+		}
+		else if ((a > b) == greater)
+		{
+			candidate += k;
+			k = 1;
+			*period = candidate - suffix;
+		}
+		else
+		{
+			suffix = candidate++;
+			k = 1;
+			*period = 1;
+		}
+	}
+	return suffix;
+}
+
+/*Two-Way string matching with a bad byte shift, linear in the haystack size
+whatever the needle. Reverse searches read both back to front and return the
+position of the last match counted from the end*/
+static size_t detail_sdstr_two_way(
+	const char *haystack,
+	size_t haystack_size,
+	const char *needle,
+	size_t needle_size,
+	int reverse)
+{
+	size_t shift[256];
+	size_t suffix;
+	size_t other_suffix;
+	size_t period;
+	size_t other_period;
+	size_t memory;
+	size_t periodic_memory;
+	size_t pos;
+	size_t i;
+	size_t k;
+	for (i = 0; i < 256; i++)
+	{
+		shift[i] = 0;
+	}
+	for (i = 0; i < needle_size; i++)
+	{
+		shift[detail_sdstr_byte(needle, needle_size, i, reverse)] = i + 1;
+	}
+	/*Critical factorization from the later of the two maximal suffixes*/
+	suffix = detail_sdstr_maximal_suffix(needle, needle_size, reverse, 1, &period);
+	other_suffix = detail_sdstr_maximal_suffix(needle, needle_size, reverse, 0, &other_period);
+	if (other_suffix + 1 > suffix + 1)
+	{
+		suffix = other_suffix;
+		period = other_period;
+	}
+	periodic_memory = needle_size - period;
+	for (i = 0; i < suffix + 1; i++)
+	{
+		if (detail_sdstr_byte(needle, needle_size, i, reverse) !=
+			detail_sdstr_byte(needle, needle_size, i + period, reverse))
+		{
+			periodic_memory = 0;
+			period = (suffix + 1 > needle_size - suffix - 1 ?
+				suffix + 1 : needle_size - suffix - 1) + 1;
+			break;
+		}
+	}
+	memory = 0;
+	pos = 0;
+	while (haystack_size - pos >= needle_size)
+	{
+		/*Line up the last byte of the window with its last occurrence in the needle*/
+		k = needle_size - shift[detail_sdstr_byte(haystack, haystack_size, pos + needle_size - 1, reverse)];
+		if (k != 0)
+		{
+			pos += k;
+			memory = 0;
+			continue;
+		}
+		k = suffix + 1 > memory ? suffix + 1 : memory;
+		while (k < needle_size &&
+			detail_sdstr_byte(needle, needle_size, k, reverse) ==
+				detail_sdstr_byte(haystack, haystack_size, pos + k, reverse))
+		{
+			k++;
+		}
+		if (k < needle_size)
+		{
+			pos += k - suffix;
+			memory = 0;
+			continue;
+		}
+		k = suffix + 1;
+		while (k > memory &&
+			detail_sdstr_byte(needle, needle_size, k - 1, reverse) ==
+				detail_sdstr_byte(haystack, haystack_size, pos + k - 1, reverse))
+		{
+			k--;
+		}
+		if (k <= memory)
+		{
+			return pos;
+		}
+		pos += period;
+		memory = periodic_memory;
+	}
+	return detail_sdstr_not_found;
+}
+
+/*Too many candidates that turn out not to match send the filters over to the
+Two-Way search, which keeps the worst case linear*/
+#define detail_sdstr_filter_budget(scanned) (64 + (scanned) / 8)
+
+/*Finds candidates whose first and last bytes match the needle a vector at a
+time and only compares those*/
+static size_t detail_sdstr_search(
+	const char *haystack,
+	size_t haystack_size,
+	const char *needle,
+	size_t needle_size)
+{
+	const char *found;
+	size_t last;
+	size_t misses;
+	size_t pos;
+	size_t result;
+	if (needle_size > haystack_size)
+	{
+		return detail_sdstr_not_found;
+	}
+	if (needle_size <= 1)
+	{
+		found = needle_size == 0 ? haystack : memchr(haystack, needle[0], haystack_size);
+		return found == NULL ? detail_sdstr_not_found : (size_t)(found - haystack);
+	}
+	last = haystack_size - needle_size;
+	misses = 0;
+	pos = 0;
+#if defined(detail_sdstr_vector_size)
+	{
+		detail_sdstr_vector first;
+		detail_sdstr_vector final;
+		uint32_t mask;
+		uint32_t bit;
+		first = detail_sdstr_splat(needle[0]);
+		final = detail_sdstr_splat(needle[needle_size - 1]);
+		for (; pos + detail_sdstr_vector_size <= last + 1; pos += detail_sdstr_vector_size)
+		{
+			/*Skip two vectors at a time while nothing matches*/
+			while (pos + 2 * detail_sdstr_vector_size <= last + 1 &&
+				(detail_sdstr_match(first, haystack + pos) &
+					detail_sdstr_match(final, haystack + pos + needle_size - 1)) == 0 &&
+				(detail_sdstr_match(first, haystack + pos + detail_sdstr_vector_size) &
+					detail_sdstr_match(final, haystack + pos + detail_sdstr_vector_size + needle_size - 1)) == 0)
+			{
+				pos += 2 * detail_sdstr_vector_size;
+			}
+			if (pos + detail_sdstr_vector_size > last + 1)
+			{
+				break;
+			}
+			mask = detail_sdstr_match(first, haystack + pos) &
+				detail_sdstr_match(final, haystack + pos + needle_size - 1);
+			while (mask != 0)
+			{
+				bit = detail_sdstr_lowest_bit(mask);
+				if (memcmp(haystack + pos + bit, needle, needle_size) == 0)
+				{
+					return pos + bit;
+				}
+				mask &= mask - 1;
+				misses++;
+			}
+			if (misses > detail_sdstr_filter_budget(pos))
+			{
+				break;
+			}
+		}
+	}
+#endif
+	for (; pos <= last; pos++)
+	{
+		if (misses > detail_sdstr_filter_budget(pos))
+		{
+			result = detail_sdstr_two_way(haystack + pos, haystack_size - pos,
+				needle, needle_size, 0);
+			return result == detail_sdstr_not_found ? result : pos + result;
+		}
+		if (haystack[pos] == needle[0] &&
+			haystack[pos + needle_size - 1] == needle[needle_size - 1])
+		{
+			if (memcmp(haystack + pos, needle, needle_size) == 0)
+			{
+				return pos;
+			}
+			misses++;
+		}
+	}
+	return detail_sdstr_not_found;
+}
+
+/*Same as detail_sdstr_search, but finds the last match*/
+static size_t detail_sdstr_search_back(
+	const char *haystack,
+	size_t haystack_size,
+	const char *needle,
+	size_t needle_size)
+{
+	size_t end;
+	size_t misses;
+	size_t result;
+	if (needle_size > haystack_size)
+	{
+		return detail_sdstr_not_found;
+	}
+	if (needle_size == 0)
+	{
+		return haystack_size;
+	}
+	/*Candidates are the positions before end*/
+	end = haystack_size - needle_size + 1;
+	misses = 0;
+#if defined(detail_sdstr_vector_size)
+	{
+		detail_sdstr_vector first;
+		detail_sdstr_vector final;
+		uint32_t mask;
+		uint32_t bit;
+		first = detail_sdstr_splat(needle[0]);
+		final = detail_sdstr_splat(needle[needle_size - 1]);
+		while (end >= detail_sdstr_vector_size &&
+			misses <= detail_sdstr_filter_budget(haystack_size - end))
+		{
+			end -= detail_sdstr_vector_size;
+			mask = detail_sdstr_match(first, haystack + end) &
+				detail_sdstr_match(final, haystack + end + needle_size - 1);
+			while (mask != 0)
+			{
+				bit = detail_sdstr_highest_bit(mask);
+				if (memcmp(haystack + end + bit, needle, needle_size) == 0)
+				{
+					return end + bit;
+				}
+				mask &= ~(1u << bit);
+				misses++;
+			}
+		}
+	}
+#endif
+	while (end > 0)
+	{
+		if (misses > detail_sdstr_filter_budget(haystack_size - end))
+		{
+			result = detail_sdstr_two_way(haystack, end + needle_size - 1,
+				needle, needle_size, 1);
+			return result == detail_sdstr_not_found ? result : end - 1 - result;
+		}
+		end--;
+		if (haystack[end] == needle[0] &&
+			haystack[end + needle_size - 1] == needle[needle_size - 1])
+		{
+			if (memcmp(haystack + end, needle, needle_size) == 0)
+			{
+				return end;
+			}
+			misses++;
+		}
+	}
+	return detail_sdstr_not_found;
+}
+
+SDSTR_API int detail_sdstr_contains_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	state = detail_sdstr_read(str, kind);
+	return value.size == 0 ||
+		detail_sdstr_find_impl(str, kind, state.data, value) != NULL;
+}
+
+SDSTR_API char *detail_sdstr_find_impl(
+	void *str,
+	sdstr_index kind,
+	char *start,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	size_t result;
+	state = detail_sdstr_read(str, kind);
+	if (start == NULL)
+	{
+		return NULL;
+	}
+	offset = detail_sdstr_offset(&state, start);
+	result = detail_sdstr_search(start, state.size - offset, value.data, value.size);
+	return result == detail_sdstr_not_found ? NULL : start + result;
+}
+
+SDSTR_API char *detail_sdstr_find_back_impl(
+	void *str,
+	sdstr_index kind,
+	char *start,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	size_t result;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, start);
+	if (offset == 0)
+	{
+		return NULL;
+	}
+	/*Only matches that start before the offset count*/
+	result = detail_sdstr_search_back(state.data,
+		offset - 1 + value.size < state.size ? offset - 1 + value.size : state.size,
+		value.data, value.size);
+	return result == detail_sdstr_not_found ? NULL : state.data + result;
+}
+
+SDSTR_API int detail_sdstr_compare_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	int result;
+	state = detail_sdstr_read(str, kind);
+	result = state.size == 0 || value.size == 0 ? 0 :
+		memcmp(state.data, value.data, state.size < value.size ? state.size : value.size);
+	if (result != 0)
+	{
+		return result;
+	}
+	return (state.size > value.size) - (state.size < value.size);
+}
+
+SDSTR_API void detail_sdstr_reserve_impl(
+	void *str,
+	sdstr_index kind,
+	sdstr_index capacity)
+{
+	detail_sdstr_state state;
+	state = detail_sdstr_read(str, kind);
+	if (capacity <= state.capacity)
+	{
+		return;
+	}
+	sdstr_assert(!detail_sdstr_is_stack(kind) && "sdstr_stack capacity exceeded");
+	detail_sdstr_realloc(str, kind, &state, capacity);
+}
+
+SDSTR_API void detail_sdstr_new_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes value,
+	sdstr_index capacity)
+{
+	detail_sdstr_state state;
+	if (detail_sdstr_is_stack(kind) || kind == detail_sdstr_kind_small)
+	{
+		state.data = str;
+		state.size = 0;
+		state.count = 0;
+		if (kind == detail_sdstr_kind_small)
+		{
+			detail_sdstr_small_tag(str) = 0;
+		}
+		detail_sdstr_write(str, kind, &state);
+	}
+	else
+	{
+		*(char **)str = NULL;
+	}
+	detail_sdstr_reserve_impl(str, kind, capacity);
+	detail_sdstr_replace_bytes(str, kind, 0, 0, value);
+}
+
+SDSTR_API void detail_sdstr_dup_impl(
+	void *str,
+	sdstr_index kind,
+	void *source,
+	sdstr_index source_kind)
+{
+	detail_sdstr_state source_state;
+	detail_sdstr_bytes value;
+	source_state = detail_sdstr_read(source, source_kind);
+	value.data = source_state.data;
+	value.size = source_state.size;
+	detail_sdstr_new_impl(str, kind, value, 0);
+}
+
+SDSTR_API void detail_sdstr_substr_impl(
+	void *str,
+	sdstr_index kind,
+	void *source,
+	sdstr_index source_kind,
+	char *pos,
+	sdstr_index count)
+{
+	detail_sdstr_new_impl(str, kind,
+		detail_sdstr_view_substr_impl(source, source_kind, pos, count), 0);
+}
+
+SDSTR_API sdstr_view detail_sdstr_view_substr_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos,
+	sdstr_index count)
+{
+	detail_sdstr_state state;
+	sdstr_view result;
+	sdstr_index offset;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, pos);
+	result.data = state.data == NULL ? "" : state.data + offset;
+	result.size = detail_sdstr_span(&state, kind, offset, count);
+	return result;
+}
+
+#define detail_sdstr_split_block 64
+
+#define detail_sdstr_is_delim(split, byte)\
+	(((split)->table[(unsigned char)(byte) >> 7][(byte) & 15] >> (((unsigned char)(byte) >> 4) & 7)) & 1)
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#if defined(__AVX2__)
+typedef __m256i detail_sdstr_lookup_vector;
+#define detail_sdstr_lookup_size 32
+#define detail_sdstr_lookup_load(data) _mm256_loadu_si256((const __m256i *)(const void *)(data))
+#define detail_sdstr_lookup_table(table) _mm256_broadcastsi128_si256(\
+	_mm_loadu_si128((const __m128i *)(const void *)(table)))
+#define detail_sdstr_lookup_splat _mm256_set1_epi8
+#define detail_sdstr_lookup_shuffle _mm256_shuffle_epi8
+#define detail_sdstr_lookup_and _mm256_and_si256
+#define detail_sdstr_lookup_or _mm256_or_si256
+#define detail_sdstr_lookup_xor _mm256_xor_si256
+#define detail_sdstr_lookup_shift_right _mm256_srli_epi16
+#define detail_sdstr_lookup_mask(vector) ((uint32_t)_mm256_movemask_epi8(vector))
+#define detail_sdstr_lookup_equal _mm256_cmpeq_epi8
+#else
+typedef __m128i detail_sdstr_lookup_vector;
+#define detail_sdstr_lookup_size 16
+#define detail_sdstr_lookup_load(data) _mm_loadu_si128((const __m128i *)(const void *)(data))
+#define detail_sdstr_lookup_table(table) _mm_loadu_si128((const __m128i *)(const void *)(table))
+#define detail_sdstr_lookup_splat _mm_set1_epi8
+#define detail_sdstr_lookup_shuffle _mm_shuffle_epi8
+#define detail_sdstr_lookup_and _mm_and_si128
+#define detail_sdstr_lookup_or _mm_or_si128
+#define detail_sdstr_lookup_xor _mm_xor_si128
+#define detail_sdstr_lookup_shift_right _mm_srli_epi16
+#define detail_sdstr_lookup_mask(vector) ((uint32_t)_mm_movemask_epi8(vector))
+#define detail_sdstr_lookup_equal _mm_cmpeq_epi8
+#endif
+
+static const unsigned char detail_sdstr_lookup_bits[16] =
+	{1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+#endif
+
+/*Bit i is set when the byte at data + i is a delimiter, for the
+detail_sdstr_split_block bytes at data*/
+static uint64_t detail_sdstr_split_mask(const sdstr_split *split, const char *data)
+{
+	uint64_t result;
+	size_t i;
+	result = 0;
+#if defined(__AVX2__) || defined(__SSSE3__)
+	{
+		detail_sdstr_lookup_vector low_table;
+		detail_sdstr_lookup_vector high_table;
+		detail_sdstr_lookup_vector bits;
+		detail_sdstr_lookup_vector nibbles;
+		detail_sdstr_lookup_vector input;
+		detail_sdstr_lookup_vector index;
+		detail_sdstr_lookup_vector row;
+		detail_sdstr_lookup_vector bit;
+		/*The low nibble picks a row of the bitmap and the high one a bit in
+		it. Indexes with the top bit set shuffle in 0, so every byte is only
+		looked up in the half of the table it belongs to*/
+		low_table = detail_sdstr_lookup_table(split->table[0]);
+		high_table = detail_sdstr_lookup_table(split->table[1]);
+		bits = detail_sdstr_lookup_table(detail_sdstr_lookup_bits);
+		nibbles = detail_sdstr_lookup_splat(0x0F);
+		for (i = 0; i < detail_sdstr_split_block; i += detail_sdstr_lookup_size)
+		{
+			input = detail_sdstr_lookup_load(data + i);
+			index = detail_sdstr_lookup_and(input, detail_sdstr_lookup_splat((char)0x8F));
+			row = detail_sdstr_lookup_or(
+				detail_sdstr_lookup_shuffle(low_table, index),
+				detail_sdstr_lookup_shuffle(high_table,
+					detail_sdstr_lookup_xor(index, detail_sdstr_lookup_splat((char)0x80))));
+			bit = detail_sdstr_lookup_shuffle(bits,
+				detail_sdstr_lookup_and(detail_sdstr_lookup_shift_right(input, 4), nibbles));
+			result |= (uint64_t)detail_sdstr_lookup_mask(detail_sdstr_lookup_equal(
+				detail_sdstr_lookup_and(row, bit), bit)) << i;
+		}
+	}
+#elif defined(detail_sdstr_vector_size)
+	{
+		uint32_t mask;
+		size_t j;
+		/*Without a byte shuffle every delimiter is compared on its own*/
+		for (i = 0; i < detail_sdstr_split_block; i += detail_sdstr_vector_size)
+		{
+			mask = 0;
+			for (j = 0; j < split->delim_count; j++)
+			{
+				mask |= detail_sdstr_match(detail_sdstr_splat(split->delims[j]), data + i);
+			}
+			result |= (uint64_t)mask << i;
+		}
+	}
+#else
+	for (i = 0; i < detail_sdstr_split_block; i++)
+	{
+		result |= (uint64_t)detail_sdstr_is_delim(split, data[i]) << i;
+	}
+#endif
+	return result;
+}
+
+SDSTR_API sdstr_split detail_sdstr_split_iter_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes delims)
+{
+	detail_sdstr_state state;
+	sdstr_split result;
+	unsigned char byte;
+	sdstr_index i;
+	sdstr_assert(delims.size <= sizeof(result.delims) && "sdstr_split_iter takes up to 16 delimiters");
+	state = detail_sdstr_read(str, kind);
+	result.data = state.data == NULL ? "" : state.data;
+	result.size = state.size;
+	result.offset = 0;
+	result.mask = 0;
+	result.done = 0;
+	memset(result.table, 0, sizeof(result.table));
+	result.delim_count = 0;
+	for (i = 0; i < delims.size; i++)
+	{
+		byte = (unsigned char)delims.data[i];
+		sdstr_assert((kind != detail_sdstr_kind_utf8 || byte < 0x80) &&
+			"delimiters of a UTF-8 str have to be ASCII");
+		if (!detail_sdstr_is_delim(&result, byte))
+		{
+			result.table[byte >> 7][byte & 15] |= (unsigned char)(1 << ((byte >> 4) & 7));
+			result.delims[result.delim_count++] = (char)byte;
+		}
+	}
+	/*The first block is looked at by the first call to next*/
+	result.block = 0 - (sdstr_index)detail_sdstr_split_block;
+	return result;
+}
+
+SDSTR_API int detail_sdstr_split_next_impl(sdstr_split *split, sdstr_view *view)
+{
+	sdstr_index end;
+	sdstr_index i;
+	if (split->done)
+	{
+		return 0;
+	}
+	while (split->mask == 0)
+	{
+		split->block += detail_sdstr_split_block;
+		if (split->block >= split->size)
+		{
+			/*The last field ends at the end of the str*/
+			view->data = split->data + split->offset;
+			view->size = split->size - split->offset;
+			split->done = 1;
+			return 1;
+		}
+		if (split->size - split->block >= detail_sdstr_split_block)
+		{
+			split->mask = detail_sdstr_split_mask(split, split->data + split->block);
+		}
+		else
+		{
+			for (i = split->block; i < split->size; i++)
+			{
+				split->mask |= (uint64_t)detail_sdstr_is_delim(split, split->data[i]) << (i - split->block);
+			}
+		}
+	}
+	end = split->block + ((uint32_t)split->mask != 0 ?
+		detail_sdstr_lowest_bit((uint32_t)split->mask) :
+		32 + detail_sdstr_lowest_bit((uint32_t)(split->mask >> 32)));
+	split->mask &= split->mask - 1;
+	view->data = split->data + split->offset;
+	view->size = end - split->offset;
+	split->offset = end + 1;
+	return 1;
+}
+
+SDSTR_API char *detail_sdstr_index_to_pointer_impl(
+	void *str,
+	sdstr_index kind,
+	sdstr_index index)
+{
+	detail_sdstr_state state;
+	state = detail_sdstr_read(str, kind);
+	if (index >= state.count)
+	{
+		return NULL;
+	}
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		return state.data + detail_sdstr_utf8_offset(&state, index);
+	}
+	return state.data + index;
+}
+
+SDSTR_API uint32_t detail_sdstr_get_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos)
+{
+	if (pos == NULL)
+	{
+		return 0;
+	}
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		return detail_sdstr_decode(pos);
+	}
+	(void)str;
+	return (unsigned char)*pos;
+}
+
+SDSTR_API void detail_sdstr_set_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos,
+	uint32_t value)
+{
+	char buffer[4];
+	if (pos == NULL)
+	{
+		return;
+	}
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		detail_sdstr_splice_impl(str, kind, pos, 1,
+			detail_sdstr_char_impl(kind, value, buffer));
+		return;
+	}
+	*pos = (char)value;
+}
+
+SDSTR_API char *detail_sdstr_next_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, pos);
+	return detail_sdstr_at(&state, offset + detail_sdstr_span(&state, kind, offset, 1));
+}
+
+SDSTR_API char *detail_sdstr_prev_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, pos);
+	if (offset == 0)
+	{
+		return NULL;
+	}
+	offset--;
+	while (kind == detail_sdstr_kind_utf8 &&
+		offset > 0 &&
+		detail_sdstr_is_continuation(state.data[offset]))
+	{
+		offset--;
+	}
+	return state.data + offset;
+}
+
+SDSTR_API uint32_t detail_sdstr_pop_impl(void *str, sdstr_index kind)
+{
+	char *last;
+	uint32_t result;
+	last = detail_sdstr_prev_impl(str, kind, NULL);
+	if (last == NULL)
+	{
+		return 0;
+	}
+	result = detail_sdstr_get_impl(str, kind, last);
+	detail_sdstr_splice_impl(str, kind, last, 1, detail_sdstr_cstr_impl(NULL));
+	return result;
+}
+
+SDSTR_API char *detail_sdstr_splice_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos,
+	sdstr_index count,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	sdstr_index size;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, pos);
+	size = detail_sdstr_span(&state, kind, offset, count);
+	state = detail_sdstr_replace_bytes(str, kind, offset, size, value);
+	return detail_sdstr_at(&state, offset);
+}
+
+static void detail_sdstr_reverse_bytes(char *begin, char *end)
+{
+	char byte;
+	while (begin + 1 < end)
+	{
+		end--;
+		byte = *begin;
+		*begin = *end;
+		*end = byte;
+		begin++;
+	}
+}
+
+/*Formatted values that can't be formatted into the str itself are tried in
+a buffer of this size first*/
+#define detail_sdstr_format_buffer_size 256
+
+/*Formats into buffer, or into an allocation that the caller frees when it
+doesn't fit*/
+static detail_sdstr_bytes detail_sdstr_format(char *buffer, const char *format, va_list args)
+{
+	detail_sdstr_bytes result;
+	va_list copy;
+	char *data;
+	int size;
+	va_copy(copy, args);
+	size = vsnprintf(buffer, detail_sdstr_format_buffer_size, format, copy);
+	va_end(copy);
+	sdstr_assert(size >= 0 && "invalid format");
+	result.data = buffer;
+	result.size = (sdstr_index)size;
+	if (size >= detail_sdstr_format_buffer_size)
+	{
+		data = sdstr_malloc((size_t)size + 1);
+		sdstr_assert(data != NULL && "sdstr_malloc returned NULL");
+		vsnprintf(data, (size_t)size + 1, format, args);
+		result.data = data;
+	}
+	return result;
+}
+
+/*Replaces size bytes at offset with formatted bytes, returns the new state.
+They are formatted into the spare capacity past the terminator and rotated
+into place, or right into place in the block a heap str moves to when they
+don't fit. Either way the arguments may point into the str itself*/
+static detail_sdstr_state detail_sdstr_replace_format(
+	void *str,
+	sdstr_index kind,
+	sdstr_index offset,
+	sdstr_index size,
+	const char *format,
+	va_list args)
+{
+	detail_sdstr_state state;
+	detail_sdstr_bytes value;
+	va_list copy;
+	char buffer[detail_sdstr_format_buffer_size];
+	char *block;
+	char *data;
+	size_t prefix;
+	sdstr_index spare;
+	sdstr_index new_size;
+	sdstr_index removed_count;
+	sdstr_index value_count;
+	sdstr_index capacity;
+	int length;
+	int valid;
+	state = detail_sdstr_read(str, kind);
+	removed_count = detail_sdstr_count_range(&state, kind, offset, size);
+	spare = state.data == NULL ? 0 : state.capacity - state.size;
+	va_copy(copy, args);
+	length = vsnprintf(spare > 0 ? state.data + state.size + 1 : NULL, spare, format, copy);
+	va_end(copy);
+	sdstr_assert(length >= 0 && "invalid format");
+	value.size = (sdstr_index)length;
+	new_size = state.size - size + value.size;
+	if (value.size < spare)
+	{
+		data = state.data;
+		if (offset + size < state.size)
+		{
+			detail_sdstr_reverse_bytes(data + offset, data + state.size + 1);
+			detail_sdstr_reverse_bytes(data + state.size + 1, data + state.size + 1 + value.size);
+			detail_sdstr_reverse_bytes(data + offset, data + state.size + 1 + value.size);
+			memmove(data + offset + value.size,
+				data + offset + value.size + size,
+				state.size - offset - size);
+		}
+		else
+		{
+			memmove(data + offset, data + state.size + 1, value.size);
+		}
+	}
+	else if (detail_sdstr_load_heap(str, kind) != NULL)
+	{
+		/*The old block is freed after the arguments are formatted*/
+		prefix = detail_sdstr_prefix(kind);
+		capacity = detail_sdstr_grown_capacity(state.capacity, new_size);
+		block = sdstr_malloc(prefix + (size_t)capacity + 1);
+		sdstr_assert(block != NULL && "sdstr_malloc returned NULL");
+		memcpy(block, state.data - prefix, prefix + offset);
+		data = block + prefix;
+		vsnprintf(data + offset, (size_t)value.size + 1, format, args);
+		memcpy(data + offset + value.size,
+			state.data + offset + size,
+			state.size - offset - size);
+		sdstr_free(state.data - prefix);
+		detail_sdstr_heap(data)->capacity = capacity;
+		state.data = data;
+		state.capacity = capacity;
+		detail_sdstr_store_heap(str, kind, data);
+	}
+	else
+	{
+		/*Empty heap strs and strs that keep their bytes inside of them*/
+		value = detail_sdstr_format(buffer, format, args);
+		state = detail_sdstr_replace_bytes(str, kind, offset, size, value);
+		if (value.data != buffer)
+		{
+			sdstr_free((char *)value.data);
+		}
+		return state;
+	}
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		valid = detail_sdstr_validate_utf8(state.data + offset, value.size, &value_count);
+		sdstr_assert(valid && "value is not valid UTF-8");
+		(void)valid;
+		state.count = state.count - removed_count + value_count;
+	}
+	else
+	{
+		value_count = 0;
+		state.count = new_size;
+	}
+	state.size = new_size;
+	detail_sdstr_write(str, kind, &state);
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		detail_sdstr_utf8_patch(state.data, offset, size, value.size,
+			removed_count == value_count);
+	}
+	if (size > value.size)
+	{
+		detail_sdstr_autoshrink(str, kind, &state);
+	}
+	return state;
+}
+
+SDSTR_API char *detail_sdstr_splicef_impl(
+	void *str,
+	sdstr_index kind,
+	char *pos,
+	sdstr_index count,
+	const char *format,
+	...)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	sdstr_index size;
+	va_list args;
+	state = detail_sdstr_read(str, kind);
+	offset = detail_sdstr_offset(&state, pos);
+	size = detail_sdstr_span(&state, kind, offset, count);
+	va_start(args, format);
+	state = detail_sdstr_replace_format(str, kind, offset, size, format, args);
+	va_end(args);
+	return detail_sdstr_at(&state, offset);
+}
+
+SDSTR_API char *detail_sdstr_replace_first_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	char *found;
+	state = detail_sdstr_read(str, kind);
+	found = detail_sdstr_find_impl(str, kind, state.data, search);
+	if (found == NULL || search.size == 0)
+	{
+		return NULL;
+	}
+	offset = (sdstr_index)(found - state.data);
+	state = detail_sdstr_replace_bytes(str, kind, offset, search.size, value);
+	return detail_sdstr_at(&state, offset + value.size);
+}
+
+SDSTR_API char *detail_sdstr_replacef_first_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	const char *format,
+	...)
+{
+	detail_sdstr_state state;
+	sdstr_index offset;
+	sdstr_index size;
+	va_list args;
+	char *found;
+	state = detail_sdstr_read(str, kind);
+	found = detail_sdstr_find_impl(str, kind, state.data, search);
+	if (found == NULL || search.size == 0)
+	{
+		return NULL;
+	}
+	offset = (sdstr_index)(found - state.data);
+	size = state.size;
+	va_start(args, format);
+	state = detail_sdstr_replace_format(str, kind, offset, search.size, format, args);
+	va_end(args);
+	return detail_sdstr_at(&state, offset + search.size + state.size - size);
+}
+
+SDSTR_API sdstr_index detail_sdstr_replace_all_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_state state;
+	sdstr_index *matches;
+	sdstr_index match_count;
+	sdstr_index match_capacity;
+	sdstr_index search_count;
+	sdstr_index value_count;
+	sdstr_index new_size;
+	sdstr_index read;
+	sdstr_index write;
+	sdstr_index i;
+	size_t found;
+	int valid;
+	char *copy;
+	state = detail_sdstr_read(str, kind);
+	if (search.size == 0 || state.size < search.size)
+	{
+		return 0;
+	}
+	/*The offsets of all the matches are collected first, so the result is
+	built with at most one allocation*/
+	matches = NULL;
+	match_count = 0;
+	match_capacity = 0;
+	read = 0;
+	while ((found = detail_sdstr_search(state.data + read, state.size - read,
+		search.data, search.size)) != detail_sdstr_not_found)
+	{
+		if (match_count == match_capacity)
+		{
+			match_capacity = match_capacity > 0 ? match_capacity * 2 : SDSTR_DEFAULT_CAPACITY;
+			matches = sdstr_realloc(matches, sizeof(sdstr_index) * match_capacity);
+			sdstr_assert(matches != NULL && "sdstr_realloc returned NULL");
+		}
+		matches[match_count++] = read + (sdstr_index)found;
+		read += (sdstr_index)found + search.size;
+	}
+	if (match_count == 0)
+	{
+		return 0;
+	}
+	copy = NULL;
+	/*The value may be a part of the str itself, which is overwritten below*/
+	if ((uintptr_t)value.data >= (uintptr_t)state.data &&
+		(uintptr_t)value.data <= (uintptr_t)(state.data + state.capacity))
+	{
+		copy = sdstr_malloc(value.size > 0 ? value.size : 1);
+		sdstr_assert(copy != NULL && "sdstr_malloc returned NULL");
+		memcpy(copy, value.data, value.size);
+		value.data = copy;
+	}
+	if (kind == detail_sdstr_kind_utf8)
+	{
+		valid = detail_sdstr_validate_utf8(value.data, value.size, &value_count);
+		sdstr_assert(valid && "value is not valid UTF-8");
+		/*Only a valid search can match at code points of a valid str*/
+		valid = detail_sdstr_validate_utf8(search.data, search.size, &search_count);
+		sdstr_assert(valid && "position is not at a code point");
+		(void)valid;
+		state.count = state.count - match_count * search_count + match_count * value_count;
+		if (search.size != value.size || search_count != value_count)
+		{
+			detail_sdstr_utf8_patch(state.data, matches[0], 0, 0, 0);
+		}
+	}
+	new_size = state.size - match_count * search.size + match_count * value.size;
+	if (kind != detail_sdstr_kind_utf8)
+	{
+		state.count = new_size;
+	}
+	if (value.size <= search.size)
+	{
+		/*Shrinking in place, everything that is written has already been read*/
+		read = matches[0];
+		write = matches[0];
+		for (i = 0; i < match_count; i++)
+		{
+			memmove(state.data + write, state.data + read, matches[i] - read);
+			write += matches[i] - read;
+			memcpy(state.data + write, value.data, value.size);
+			write += value.size;
+			read = matches[i] + search.size;
+		}
+		memmove(state.data + write, state.data + read, state.size - read);
+	}
+	else
+	{
+		/*Growing in place from the back, everything that is read is still
+		ahead of what is written*/
+		detail_sdstr_grow(str, kind, &state, new_size);
+		read = state.size;
+		write = new_size;
+		for (i = match_count; i-- > 0;)
+		{
+			write -= read - matches[i] - search.size;
+			memmove(state.data + write, state.data + matches[i] + search.size,
+				read - matches[i] - search.size);
+			write -= value.size;
+			memcpy(state.data + write, value.data, value.size);
+			read = matches[i];
+		}
+	}
+	state.size = new_size;
+	detail_sdstr_write(str, kind, &state);
+	sdstr_free(matches);
+	if (copy != NULL)
+	{
+		sdstr_free(copy);
+	}
+	if (value.size < search.size)
+	{
+		detail_sdstr_autoshrink(str, kind, &state);
+	}
+	return match_count;
+}
+
+SDSTR_API sdstr_index detail_sdstr_replacef_all_impl(
+	void *str,
+	sdstr_index kind,
+	detail_sdstr_bytes search,
+	const char *format,
+	...)
+{
+	detail_sdstr_bytes value;
+	va_list args;
+	sdstr_index result;
+	char buffer[detail_sdstr_format_buffer_size];
+	/*The value is put in many places, so it is formatted once on the side*/
+	va_start(args, format);
+	value = detail_sdstr_format(buffer, format, args);
+	va_end(args);
+	result = detail_sdstr_replace_all_impl(str, kind, search, value);
+	if (value.data != buffer)
+	{
+		sdstr_free((char *)value.data);
+	}
+	return result;
+}
+
+static const char detail_sdstr_digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/*Writes the digits of value so that they end at end, returns where they
+start*/
+static char *detail_sdstr_write_digits(char *end, uint64_t value)
+{
+	uint32_t pair;
+	while (value >= 100)
+	{
+		pair = (uint32_t)(value % 100) * 2;
+		value /= 100;
+		*--end = detail_sdstr_digit_pairs[pair + 1];
+		*--end = detail_sdstr_digit_pairs[pair];
+	}
+	if (value >= 10)
+	{
+		pair = (uint32_t)value * 2;
+		*--end = detail_sdstr_digit_pairs[pair + 1];
+		*--end = detail_sdstr_digit_pairs[pair];
+	}
+	else
+	{
+		*--end = (char)('0' + value);
+	}
+	return end;
+}
+
+/*Shortest round-trip digits of doubles, following Ryu by Ulf Adams. The
+125 bit powers of 5 and their inverses are computed from every 26th one and
+a table of corrections*/
+#define detail_sdstr_pow5_bits 125
+#define detail_sdstr_pow5_step 26
+
+static const uint64_t detail_sdstr_pow5_table[26] =
+{
+	0x1u, 0x5u, 0x19u, 0x7du,
+	0x271u, 0xc35u, 0x3d09u, 0x1312du,
+	0x5f5e1u, 0x1dcd65u, 0x9502f9u, 0x2e90eddu,
+	0xe8d4a51u, 0x48c27395u, 0x16bcc41e9u, 0x71afd498du,
+	0x2386f26fc1u, 0xb1a2bc2ec5u, 0x3782dace9d9u, 0x1158e460913du,
+	0x56bc75e2d631u, 0x1b1ae4d6e2ef5u, 0x878678326eac9u, 0x2a5a058fc295edu,
+	0xd3c21bcecceda1u, 0x422ca8b0a00a425u
+};
+
+static const uint64_t detail_sdstr_pow5_split[13][2] =
+{
+	{0x0000000000000000u, 0x1000000000000000u},
+	{0x0000000000000000u, 0x14adf4b7320334b9u},
+	{0x0e549208b31adb10u, 0x1aba4714957d300du},
+	{0x6dc6ad264d8f0866u, 0x1145b7e285bf98f5u},
+	{0xeb1dbd923d8596cau, 0x1652efdc6018a1fcu},
+	{0xb4c1b80b22ae923cu, 0x1cda62055b2d9d83u},
+	{0x5bb28b4e8f7e4c30u, 0x12a5568b9f52f416u},
+	{0xf08aed437682d4fbu, 0x1819651531f9e78fu},
+	{0xb4ee134ad99bf150u, 0x1f25c186a6f04c28u},
+	{0x16499ecb70c25f03u, 0x1420eb449c8842e6u},
+	{0x85a56ead360865b0u, 0x1a03fde214caf085u},
+	{0x093db1d57999890bu, 0x10cfeb353a97dad8u},
+	{0xcf38bb735e3f36acu, 0x15baaf44fa52673eu}
+};
+
+static const uint64_t detail_sdstr_pow5_inv_split[15][2] =
+{
+	{0x0000000000000001u, 0x2000000000000000u},
+	{0x52a6c95fc0655034u, 0x18c240c4aecb13bbu},
+	{0x7ca8d50071dfc806u, 0x1327fc58da0f6ff5u},
+	{0x6520247d3556476eu, 0x1da48ce468e7c702u},
+	{0x6139cdd76802e6e9u, 0x16ef5b40c2fc7779u},
+	{0xf951a7ff43de8c79u, 0x11bebdf578b2f391u},
+	{0x7be8bee8d6e957e8u, 0x1b758d848fac54b0u},
+	{0x8bd3f9e999a423eau, 0x153eda614071a3b7u},
+	{0x0848f973cb3ee3ceu, 0x10701bd527b4978cu},
+	{0x153285ebb9efbfa2u, 0x196fbb9bb44db44du},
+	{0xadeee7f86c07b696u, 0x13ae3591f5b4d936u},
+	{0x4d686a4eaf182222u, 0x1e74404f3daada91u},
+	{0x98c0a106e09ebd9fu, 0x17900ea4fda7c257u},
+	{0x8f20e37371497d0eu, 0x123b140576d820b2u},
+	{0xb043138134743d85u, 0x1c35f4275f7a29adu}
+};
+
+static const uint32_t detail_sdstr_pow5_offsets[21] =
+{
+	0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u,
+	0x40000000u, 0x59695995u, 0x55545555u, 0x56555515u,
+	0x41150504u, 0x40555410u, 0x44555145u, 0x44504540u,
+	0x45555550u, 0x40004000u, 0x96440440u, 0x55565565u,
+	0x54454045u, 0x40154151u, 0x55559155u, 0x51405555u,
+	0x00000105u
+};
+
+static const uint32_t detail_sdstr_pow5_inv_offsets[22] =
+{
+	0x54544554u, 0x04055545u, 0x10041000u, 0x00400414u,
+	0x40010000u, 0x41155555u, 0x00000454u, 0x00010044u,
+	0x40000000u, 0x44000041u, 0x50454450u, 0x55550054u,
+	0x51655554u, 0x40004000u, 0x01000001u, 0x00010500u,
+	0x51515411u, 0x05555554u, 0x50411500u, 0x40040000u,
+	0x05040110u, 0x00000000u
+};
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 detail_sdstr_uint128;
+
+static uint64_t detail_sdstr_multiply(uint64_t a, uint64_t b, uint64_t *high)
+{
+	detail_sdstr_uint128 product;
+	product = (detail_sdstr_uint128)a * b;
+	*high = (uint64_t)(product >> 64);
+	return (uint64_t)product;
+}
+#else
+static uint64_t detail_sdstr_multiply(uint64_t a, uint64_t b, uint64_t *high)
+{
+	uint64_t low_low;
+	uint64_t low_high;
+	uint64_t high_low;
+	uint64_t middle;
+	low_low = (a & 0xFFFFFFFFu) * (b & 0xFFFFFFFFu);
+	low_high = (a & 0xFFFFFFFFu) * (b >> 32);
+	high_low = (a >> 32) * (b & 0xFFFFFFFFu);
+	middle = high_low + (low_low >> 32);
+	low_high += middle & 0xFFFFFFFFu;
+	*high = (a >> 32) * (b >> 32) + (middle >> 32) + (low_high >> 32);
+	return (low_high << 32) | (low_low & 0xFFFFFFFFu);
+}
+#endif
+
+/*Shift has to be between 1 and 63*/
+#define detail_sdstr_shift_right(low, high, shift)\
+	(((high) << (64 - (shift))) | ((low) >> (shift)))
+
+/*Bit length of 5^exponent*/
+#define detail_sdstr_pow5_length(exponent) ((int32_t)(((uint32_t)(exponent) * 1217359) >> 19) + 1)
+
+#define detail_sdstr_log10_pow2(exponent) ((uint32_t)(((uint32_t)(exponent) * 78913) >> 18))
+
+#define detail_sdstr_log10_pow5(exponent) ((uint32_t)(((uint32_t)(exponent) * 732923) >> 20))
+
+/*The top 125 bits of 5^exponent*/
+static void detail_sdstr_pow5(uint32_t exponent, uint64_t result[2])
+{
+	const uint64_t *base;
+	uint64_t factor;
+	uint64_t low_0;
+	uint64_t high_0;
+	uint64_t low_1;
+	uint64_t high_1;
+	uint64_t sum;
+	uint32_t base_exponent;
+	uint32_t shift;
+	base_exponent = exponent / detail_sdstr_pow5_step * detail_sdstr_pow5_step;
+	base = detail_sdstr_pow5_split[exponent / detail_sdstr_pow5_step];
+	if (exponent == base_exponent)
+	{
+		result[0] = base[0];
+		result[1] = base[1];
+		return;
+	}
+	factor = detail_sdstr_pow5_table[exponent - base_exponent];
+	low_1 = detail_sdstr_multiply(factor, base[1], &high_1);
+	low_0 = detail_sdstr_multiply(factor, base[0], &high_0);
+	sum = high_0 + low_1;
+	high_1 += sum < high_0;
+	shift = (uint32_t)(detail_sdstr_pow5_length(exponent) - detail_sdstr_pow5_length(base_exponent));
+	result[0] = detail_sdstr_shift_right(low_0, sum, shift) +
+		((detail_sdstr_pow5_offsets[exponent / 16] >> ((exponent % 16) * 2)) & 3);
+	result[1] = detail_sdstr_shift_right(sum, high_1, shift);
+}
+
+/*2^(124 + bit length of 5^exponent) / 5^exponent, rounded up*/
+static void detail_sdstr_pow5_inv(uint32_t exponent, uint64_t result[2])
+{
+	const uint64_t *base;
+	uint64_t factor;
+	uint64_t low_0;
+	uint64_t high_0;
+	uint64_t low_1;
+	uint64_t high_1;
+	uint64_t sum;
+	uint32_t base_exponent;
+	uint32_t shift;
+	base_exponent = (exponent + detail_sdstr_pow5_step - 1) / detail_sdstr_pow5_step * detail_sdstr_pow5_step;
+	base = detail_sdstr_pow5_inv_split[base_exponent / detail_sdstr_pow5_step];
+	if (exponent == base_exponent)
+	{
+		result[0] = base[0];
+		result[1] = base[1];
+		return;
+	}
+	factor = detail_sdstr_pow5_table[base_exponent - exponent];
+	low_1 = detail_sdstr_multiply(factor, base[1], &high_1);
+	low_0 = detail_sdstr_multiply(factor, base[0] - 1, &high_0);
+	sum = high_0 + low_1;
+	high_1 += sum < high_0;
+	shift = (uint32_t)(detail_sdstr_pow5_length(base_exponent) - detail_sdstr_pow5_length(exponent));
+	result[0] = detail_sdstr_shift_right(low_0, sum, shift) + 1 +
+		((detail_sdstr_pow5_inv_offsets[exponent / 16] >> ((exponent % 16) * 2)) & 3);
+	result[1] = detail_sdstr_shift_right(sum, high_1, shift);
+}
+
+/*(value * factor) >> shift, shift has to be between 65 and 127*/
+static uint64_t detail_sdstr_multiply_shift(uint64_t value, const uint64_t factor[2], int32_t shift)
+{
+	uint64_t high_0;
+	uint64_t low_1;
+	uint64_t high_1;
+	uint64_t sum;
+	detail_sdstr_multiply(value, factor[0], &high_0);
+	low_1 = detail_sdstr_multiply(value, factor[1], &high_1);
+	sum = high_0 + low_1;
+	high_1 += sum < high_0;
+	return detail_sdstr_shift_right(sum, high_1, (uint32_t)(shift - 64));
+}
+
+static uint32_t detail_sdstr_pow5_factor(uint64_t value)
+{
+	uint32_t result;
+	result = 0;
+	while (value % 5 == 0)
+	{
+		value /= 5;
+		result++;
+	}
+	return result;
+}
+
+/*Finds the shortest digits that round to the double with the given IEEE
+mantissa and biased exponent, which has to be finite and not 0. Returns the
+digits and writes the power of 10 they are multiplied by*/
+static uint64_t detail_sdstr_shortest(uint64_t ieee_mantissa, uint32_t ieee_exponent, int32_t *exponent)
+{
+	uint64_t factor[2];
+	uint64_t mantissa;
+	uint64_t middle;
+	uint64_t upper;
+	uint64_t lower;
+	uint64_t middle_digits;
+	int32_t binary_exponent;
+	int32_t removed;
+	uint32_t lower_shift;
+	uint32_t q;
+	uint32_t last_removed;
+	int even;
+	int lower_trailing_zeros;
+	int middle_trailing_zeros;
+	int round_up;
+	if (ieee_exponent == 0)
+	{
+		binary_exponent = 1 - 1023 - 52 - 2;
+		mantissa = ieee_mantissa;
+	}
+	else
+	{
+		binary_exponent = (int32_t)ieee_exponent - 1023 - 52 - 2;
+		mantissa = ((uint64_t)1 << 52) | ieee_mantissa;
+	}
+	even = (mantissa & 1) == 0;
+	/*The halfway points to the neighbours are 4 * mantissa + 2 and
+	4 * mantissa - 1 - lower_shift, the lower one is closer at powers of 2*/
+	middle_digits = 4 * mantissa;
+	lower_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+	lower_trailing_zeros = 0;
+	middle_trailing_zeros = 0;
+	if (binary_exponent >= 0)
+	{
+		q = detail_sdstr_log10_pow2(binary_exponent) - (binary_exponent > 3);
+		*exponent = (int32_t)q;
+		detail_sdstr_pow5_inv(q, factor);
+		binary_exponent = -binary_exponent + (int32_t)q +
+			detail_sdstr_pow5_bits + detail_sdstr_pow5_length(q) - 1;
+		middle = detail_sdstr_multiply_shift(middle_digits, factor, binary_exponent);
+		upper = detail_sdstr_multiply_shift(middle_digits + 2, factor, binary_exponent);
+		lower = detail_sdstr_multiply_shift(middle_digits - 1 - lower_shift, factor, binary_exponent);
+		if (q <= 21)
+		{
+			/*Only one of the three can be a multiple of 5, if any*/
+			if (middle_digits % 5 == 0)
+			{
+				middle_trailing_zeros = detail_sdstr_pow5_factor(middle_digits) >= q;
+			}
+			else if (even)
+			{
+				lower_trailing_zeros = detail_sdstr_pow5_factor(middle_digits - 1 - lower_shift) >= q;
+			}
+			else
+			{
+				upper -= detail_sdstr_pow5_factor(middle_digits + 2) >= q;
+			}
+		}
+	}
+	else
+	{
+		q = detail_sdstr_log10_pow5(-binary_exponent) - (-binary_exponent > 1);
+		*exponent = (int32_t)q + binary_exponent;
+		detail_sdstr_pow5((uint32_t)(-binary_exponent - (int32_t)q), factor);
+		binary_exponent = (int32_t)q -
+			(detail_sdstr_pow5_length(-binary_exponent - (int32_t)q) - detail_sdstr_pow5_bits);
+		middle = detail_sdstr_multiply_shift(middle_digits, factor, binary_exponent);
+		upper = detail_sdstr_multiply_shift(middle_digits + 2, factor, binary_exponent);
+		lower = detail_sdstr_multiply_shift(middle_digits - 1 - lower_shift, factor, binary_exponent);
+		if (q <= 1)
+		{
+			middle_trailing_zeros = 1;
+			if (even)
+			{
+				lower_trailing_zeros = lower_shift == 1;
+			}
+			else
+			{
+				upper--;
+			}
+		}
+		else if (q < 63)
+		{
+			middle_trailing_zeros = (middle_digits & (((uint64_t)1 << q) - 1)) == 0;
+		}
+	}
+	/*Digits are removed while the bounds still differ*/
+	removed = 0;
+	last_removed = 0;
+	if (lower_trailing_zeros || middle_trailing_zeros)
+	{
+		while (upper / 10 > lower / 10)
+		{
+			lower_trailing_zeros &= lower % 10 == 0;
+			middle_trailing_zeros &= last_removed == 0;
+			last_removed = (uint32_t)(middle % 10);
+			middle /= 10;
+			upper /= 10;
+			lower /= 10;
+			removed++;
+		}
+		if (lower_trailing_zeros)
+		{
+			while (lower % 10 == 0)
+			{
+				middle_trailing_zeros &= last_removed == 0;
+				last_removed = (uint32_t)(middle % 10);
+				middle /= 10;
+				upper /= 10;
+				lower /= 10;
+				removed++;
+			}
+		}
+		if (middle_trailing_zeros && last_removed == 5 && middle % 2 == 0)
+		{
+			/*Exactly halfway rounds to even*/
+			last_removed = 4;
+		}
+		*exponent += removed;
+		return middle +
+			((middle == lower && (!even || !lower_trailing_zeros)) || last_removed >= 5);
+	}
+	round_up = 0;
+	if (upper / 100 > lower / 100)
+	{
+		round_up = middle % 100 >= 50;
+		middle /= 100;
+		upper /= 100;
+		lower /= 100;
+		removed += 2;
+	}
+	while (upper / 10 > lower / 10)
+	{
+		round_up = middle % 10 >= 5;
+		middle /= 10;
+		upper /= 10;
+		lower /= 10;
+		removed++;
+	}
+	*exponent += removed;
+	return middle + (middle == lower || round_up);
+}
+
+/*Writes the shortest digits that read back as value, in plain notation when
+the decimal point is within 21 digits of them and in scientific notation
+otherwise. Returns the amount of bytes written, at most 25*/
+static sdstr_index detail_sdstr_write_double(char *buffer, double value)
+{
+	char digits[20];
+	char *first;
+	char *out;
+	uint64_t bits;
+	uint64_t ieee_mantissa;
+	uint32_t ieee_exponent;
+	int32_t exponent;
+	int32_t point;
+	int32_t length;
+	memcpy(&bits, &value, sizeof(bits));
+	ieee_mantissa = bits & (((uint64_t)1 << 52) - 1);
+	ieee_exponent = (uint32_t)(bits >> 52) & 0x7FF;
+	out = buffer;
+	if (ieee_exponent == 0x7FF && ieee_mantissa != 0)
+	{
+		memcpy(out, "nan", 3);
+		return 3;
+	}
+	if (bits >> 63)
+	{
+		*out++ = '-';
+	}
+	if (ieee_exponent == 0x7FF)
+	{
+		memcpy(out, "inf", 3);
+		return (sdstr_index)(out - buffer) + 3;
+	}
+	if (ieee_exponent == 0 && ieee_mantissa == 0)
+	{
+		*out++ = '0';
+		return (sdstr_index)(out - buffer);
+	}
+	first = detail_sdstr_write_digits(digits + sizeof(digits),
+		detail_sdstr_shortest(ieee_mantissa, ieee_exponent, &exponent));
+	length = (int32_t)(digits + sizeof(digits) - first);
+	/*Digits before the decimal point*/
+	point = length + exponent;
+	if (point >= length && point <= 21)
+	{
+		memcpy(out, first, (size_t)length);
+		memset(out + length, '0', (size_t)(point - length));
+		out += point;
+	}
+	else if (point > 0 && point <= 21)
+	{
+		memcpy(out, first, (size_t)point);
+		out[point] = '.';
+		memcpy(out + point + 1, first + point, (size_t)(length - point));
+		out += length + 1;
+	}
+	else if (point > -6 && point <= 0)
+	{
+		out[0] = '0';
+		out[1] = '.';
+		memset(out + 2, '0', (size_t)-point);
+		memcpy(out + 2 - point, first, (size_t)length);
+		out += 2 - point + length;
+	}
+	else
+	{
+		*out++ = first[0];
+		if (length > 1)
+		{
+			*out++ = '.';
+			memcpy(out, first + 1, (size_t)(length - 1));
+			out += length - 1;
+		}
+		*out++ = 'e';
+		*out++ = point > 0 ? '+' : '-';
+		exponent = point > 0 ? point - 1 : 1 - point;
+		out += exponent >= 100 ? 3 : exponent >= 10 ? 2 : 1;
+		detail_sdstr_write_digits(out, (uint64_t)exponent);
+	}
+	return (sdstr_index)(out - buffer);
+}
+
+static char *detail_sdstr_push_bytes(void *str, sdstr_index kind, const char *data, sdstr_index size)
+{
+	detail_sdstr_state state;
+	detail_sdstr_bytes value;
+	sdstr_index offset;
+	value.data = data;
+	value.size = size;
+	offset = detail_sdstr_read(str, kind).size;
+	state = detail_sdstr_replace_bytes(str, kind, offset, 0, value);
+	return detail_sdstr_at(&state, offset);
+}
+
+SDSTR_API char *detail_sdstr_push_int_impl(void *str, sdstr_index kind, int64_t value)
+{
+	char buffer[20];
+	char *first;
+	first = detail_sdstr_write_digits(buffer + sizeof(buffer),
+		value < 0 ? 0 - (uint64_t)value : (uint64_t)value);
+	if (value < 0)
+	{
+		*--first = '-';
+	}
+	return detail_sdstr_push_bytes(str, kind, first, (sdstr_index)(buffer + sizeof(buffer) - first));
+}
+
+SDSTR_API char *detail_sdstr_push_uint_impl(void *str, sdstr_index kind, uint64_t value)
+{
+	char buffer[20];
+	char *first;
+	first = detail_sdstr_write_digits(buffer + sizeof(buffer), value);
+	return detail_sdstr_push_bytes(str, kind, first, (sdstr_index)(buffer + sizeof(buffer) - first));
+}
+
+SDSTR_API char *detail_sdstr_push_double_impl(void *str, sdstr_index kind, double value)
+{
+	char buffer[32];
+	return detail_sdstr_push_bytes(str, kind, buffer, detail_sdstr_write_double(buffer, value));
+}
+
+SDSTR_API void detail_sdstr_reverse_impl(void *str, sdstr_index kind)
+{
+	detail_sdstr_state state;
+	sdstr_index begin;
+	sdstr_index i;
+	state = detail_sdstr_read(str, kind);
+	if (state.data == NULL)
+	{
+		return;
+	}
+	detail_sdstr_reverse_bytes(state.data, state.data + state.size);
+	if (kind != detail_sdstr_kind_utf8)
+	{
+		return;
+	}
+	/*Every code point now ends with its first byte, put its bytes back in order*/
+	begin = 0;
+	for (i = 0; i < state.size; i++)
+	{
+		if (!detail_sdstr_is_continuation(state.data[i]))
+		{
+			detail_sdstr_reverse_bytes(state.data + begin, state.data + i + 1);
+			begin = i + 1;
+		}
+	}
+}
+
+SDSTR_API void detail_sdstr_delete_impl(void *str, sdstr_index kind)
+{
+	char *data;
+	data = detail_sdstr_load_heap(str, kind);
+	if (data != NULL)
+	{
+		if (kind == detail_sdstr_kind_utf8 && detail_sdstr_utf8_heap_of(data)->offsets != NULL)
+		{
+			sdstr_free(detail_sdstr_utf8_heap_of(data)->offsets);
+		}
+		sdstr_free(data - detail_sdstr_prefix(kind));
+	}
+	detail_sdstr_new_impl(str, kind, detail_sdstr_cstr_impl(NULL), 0);
+}
@@ -0,0 +1,242 @@
+#include <sdstr_intern.h>
+
+/*The map keys hold the hash so that growing the map doesn't hash the bytes
+again*/
+typedef struct detail_sdstr_intern_key
+{
+	sdhmap_index hash;
+	sdstr_index size;
+	const char *data;
+} detail_sdstr_intern_key;
+
+typedef struct detail_sdstr_intern_slot
+{
+	sdhmap_slot slot;
+	detail_sdstr_intern_key key;
+	sdhmap_index handle;
+} detail_sdstr_intern_slot;
+
+static sdhmap_index detail_sdstr_intern_hash_bytes(const char *data, sdstr_index size)
+{
+	uint64_t hash;
+	uint64_t word;
+	hash = 0x9E3779B97F4A7C15u ^ size;
+	while (size >= 8)
+	{
+		memcpy(&word, data, 8);
+		hash = (hash ^ word) * 0xBF58476D1CE4E5B9u;
+		hash ^= hash >> 29;
+		data += 8;
+		size -= 8;
+	}
+	word = 0;
+	if (size > 0)
+	{
+		memcpy(&word, data, size);
+	}
+	hash = (hash ^ word) * 0x94D049BB133111EBu;
+	hash ^= hash >> 31;
+	return (sdhmap_index)(hash ^ (hash >> 32));
+}
+
+SDSTR_API sdhmap_index detail_sdstr_view_hash_impl(const void *view)
+{
+	const sdstr_view *value = view;
+	return detail_sdstr_intern_hash_bytes(value->data, value->size);
+}
+
+SDSTR_API int detail_sdstr_view_eq_impl(const void *a, const void *b)
+{
+	const sdstr_view *first = a;
+	const sdstr_view *second = b;
+	if (first->size != second->size)
+	{
+		return 1;
+	}
+	return first->size == 0 ? 0 : memcmp(first->data, second->data, first->size);
+}
+
+static sdhmap_index detail_sdstr_intern_hash(const void *a)
+{
+	return ((const detail_sdstr_intern_key *)a)->hash;
+}
+
+static int detail_sdstr_intern_eq(const void *a, const void *b)
+{
+	const detail_sdstr_intern_key *first;
+	const detail_sdstr_intern_key *second;
+	first = a;
+	second = b;
+	if (first->hash != second->hash || first->size != second->size)
+	{
+		return 1;
+	}
+	return first->size == 0 ? 0 : memcmp(first->data, second->data, first->size);
+}
+
+SDSTR_API sdhmap_index detail_sdstr_intern_ptr_hash_impl(const void *a)
+{
+	uint64_t hash;
+	hash = (uint64_t)(uintptr_t)*(const char *const *)a * 0x9E3779B97F4A7C15u;
+	return (sdhmap_index)(hash ^ (hash >> 32));
+}
+
+SDSTR_API int detail_sdstr_intern_ptr_eq_impl(const void *a, const void *b)
+{
+	return *(const char *const *)a != *(const char *const *)b;
+}
+
+static detail_sdstr_intern_key detail_sdstr_intern_make_key(detail_sdstr_bytes value)
+{
+	detail_sdstr_intern_key key;
+	key.hash = detail_sdstr_intern_hash_bytes(value.data, value.size);
+	key.size = value.size;
+	key.data = value.data;
+	return key;
+}
+
+/*Copies bytes into the newest block, a new block is started when they don't
+fit so the bytes before never move*/
+static const char *detail_sdstr_intern_store(sdstr_intern_header *pool, detail_sdstr_bytes value)
+{
+	char *chunk;
+	char *result;
+	size_t offset;
+	offset = sizeof(char *);
+	if (pool->chunks == NULL || pool->chunk_used + value.size + 1 > pool->chunk_capacity)
+	{
+		pool->chunk_capacity = pool->chunks != NULL ? pool->chunk_capacity * 2 : SDSTR_INTERN_CHUNK_SIZE;
+		if (pool->chunk_capacity < (size_t)value.size + 1)
+		{
+			pool->chunk_capacity = (size_t)value.size + 1;
+		}
+		chunk = sdstr_malloc(offset + pool->chunk_capacity);
+		sdstr_assert(chunk != NULL && "sdstr_malloc returned NULL");
+		memcpy(chunk, &pool->chunks, sizeof(char *));
+		pool->chunks = chunk;
+		pool->chunk_used = 0;
+	}
+	result = pool->chunks + offset + pool->chunk_used;
+	if (value.size > 0)
+	{
+		memcpy(result, value.data, value.size);
+	}
+	result[value.size] = '\0';
+	pool->chunk_used += (size_t)value.size + 1;
+	return result;
+}
+
+SDSTR_API sdhmap_index detail_sdstr_intern_count_impl(sdstr_intern_header *pool)
+{
+	if (pool == NULL)
+	{
+		return 0;
+	}
+	return pool->map->count;
+}
+
+SDSTR_API sdhmap_index detail_sdstr_intern_get_impl(
+	sdstr_intern_header **pool,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_intern_key key;
+	detail_sdstr_intern_entry *entries;
+	sdhmap_index count;
+	sdhmap_index *handle;
+	if (*pool == NULL)
+	{
+		*pool = sdstr_malloc(sizeof(sdstr_intern_header));
+		sdstr_assert(*pool != NULL && "sdstr_malloc returned NULL");
+		(*pool)->map = NULL;
+		(*pool)->entries = NULL;
+		(*pool)->entry_capacity = 0;
+		(*pool)->chunks = NULL;
+		(*pool)->chunk_capacity = 0;
+		(*pool)->chunk_used = 0;
+		detail_sdhmap_new_heap_impl(&(*pool)->map,
+			detail_sdstr_intern_hash,
+			detail_sdstr_intern_eq,
+			SDHMAP_DEFAULT_CAPACITY,
+			sizeof(detail_sdstr_intern_slot),
+			offsetof(detail_sdstr_intern_slot, key),
+			offsetof(detail_sdstr_intern_slot, handle));
+	}
+	key = detail_sdstr_intern_make_key(value);
+	count = (*pool)->map->count;
+	handle = detail_sdhmap_set_heap_impl(&(*pool)->map,
+		sizeof(detail_sdstr_intern_slot),
+		sizeof(detail_sdstr_intern_key),
+		&key);
+	if ((*pool)->map->count == count)
+	{
+		return *handle;
+	}
+	sdstr_assert((*pool)->map->count != 0 && "sdstr_intern ran out of handles");
+	if (count == (*pool)->entry_capacity)
+	{
+		(*pool)->entry_capacity = count > 0 ? count * 2 : SDHMAP_DEFAULT_CAPACITY;
+		entries = sdstr_realloc((*pool)->entries,
+			sizeof(detail_sdstr_intern_entry) * (*pool)->entry_capacity);
+		sdstr_assert(entries != NULL && "sdstr_realloc returned NULL");
+		(*pool)->entries = entries;
+	}
+	/*The key still points to the value, it is moved to the copy*/
+	value.data = detail_sdstr_intern_store(*pool, value);
+	((detail_sdstr_intern_slot *)((char *)handle - offsetof(detail_sdstr_intern_slot, handle)))->key.data = value.data;
+	(*pool)->entries[count].data = value.data;
+	(*pool)->entries[count].size = value.size;
+	*handle = count + 1;
+	return *handle;
+}
+
+SDSTR_API const char *detail_sdstr_intern_str_impl(
+	sdstr_intern_header **pool,
+	detail_sdstr_bytes value)
+{
+	sdhmap_index handle;
+	handle = detail_sdstr_intern_get_impl(pool, value);
+	return (*pool)->entries[handle - 1].data;
+}
+
+SDSTR_API sdhmap_index detail_sdstr_intern_find_impl(
+	sdstr_intern_header *pool,
+	detail_sdstr_bytes value)
+{
+	detail_sdstr_intern_key key;
+	sdhmap_index *handle;
+	if (pool == NULL)
+	{
+		return 0;
+	}
+	key = detail_sdstr_intern_make_key(value);
+	handle = detail_sdhmap_getp_impl(pool->map,
+		sizeof(detail_sdstr_intern_slot),
+		sizeof(detail_sdstr_intern_key),
+		&key);
+	if (handle == NULL)
+	{
+		return 0;
+	}
+	return *handle;
+}
+
+SDSTR_API void detail_sdstr_intern_delete_impl(sdstr_intern_header **pool)
+{
+	char *chunk;
+	char *previous;
+	if (*pool == NULL)
+	{
+		return;
+	}
+	chunk = (*pool)->chunks;
+	while (chunk != NULL)
+	{
+		memcpy(&previous, chunk, sizeof(char *));
+		sdstr_free(chunk);
+		chunk = previous;
+	}
+	sdstr_free((*pool)->entries);
+	detail_sdhmap_delete_impl(&(*pool)->map);
+	sdstr_free(*pool);
+	*pool = NULL;
+}
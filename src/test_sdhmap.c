@@ -29,6 +29,7 @@ void custom_free(void *initial)
 #define sdhmap_free custom_free
 
 #include <sdhmap.h>
+#include <sdhmap_stable.h>
 
 #define TEST_MAX_SIZE 512
 
@@ -86,16 +87,210 @@ void test_0(char solution[TEST_MAX_SIZE])
 			(int)detail_sdhmap_slot(header, i)->slot,
 			(int)detail_sdhmap_slot(header, i)->next,
 			(int)detail_sdhmap_slot(header, i)->prev,
-			*((int *)(detail_sdhmap_slot(header, i)+1)),
-			*((int *)(detail_sdhmap_slot(header, i)+1)+1));
+			*((int *)((char *)detail_sdhmap_slot(header, i) + header->key_offset)),
+			*((int *)((char *)detail_sdhmap_slot(header, i) + header->value_offset)));
 	}
 
 	sdhmap_delete(a);
 }
 
+/*Test inline-type maps moving to the heap and back*/
+void test_1(char solution[TEST_MAX_SIZE])
+{
+	sdhmap_inline(int, int, 8) a;
+	sdhmap_inline(int, int, 8) b;
+	int i;
+	int ok = 1;
+	sdhmap_new(a);
+	sdhmap_new(b);
+	for (i = 0; i < 8; i++)
+	{
+		sdhmap_set(a, i, i * i);
+	}
+	strcatf(solution, "%d %d ", (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a));
+	for (i = 8; i < 100; i++)
+	{
+		sdhmap_set(a, i, i * i);
+	}
+	strcatf(solution, "%d %d ", (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a));
+	for (i = 0; i < 100; i++)
+	{
+		ok &= *sdhmap_getp(a, i) == i * i;
+	}
+	for (i = 5; i < 100; i++)
+	{
+		sdhmap_erase(a, i);
+	}
+	sdhmap_shrink(a);
+	for (i = 0; i < 5; i++)
+	{
+		ok &= *sdhmap_getp(a, i) == i * i;
+	}
+	ok &= !sdhmap_contains(a, 5);
+	strcatf(solution, "%d %d %d ", ok, (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a));
+	sdhmap_duplicate(b, a);
+	strcatf(solution, "%d %d ", (int)sdhmap_count(b), detail_sdhmap_inline_in_place(b));
+	sdhmap_delete(a);
+	strcatf(solution, "%d %d", (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a));
+	sdhmap_delete(b);
+}
+
+/*Keys and values aligned stricter than the slot header*/
+void test_2(char solution[TEST_MAX_SIZE])
+{
+	static char names[100][16];
+	sdhmap(char *, int) a = NULL;
+	sdhmap(uint8_t, double) b = NULL;
+	sdhmap_stack(char *, int64_t, 16) c;
+	sdhmap_inline(double, char, 4) d;
+	char *const *key;
+	int i;
+	int ok = 1;
+	sdhmap_new(c);
+	sdhmap_new(d);
+	for (i = 0; i < 100; i++)
+	{
+		snprintf(names[i], sizeof(names[i]), "key%d", i);
+		sdhmap_set(a, names[i], i);
+		sdhmap_set(b, (uint8_t)i, i / 4.0);
+		sdhmap_set(d, i / 2.0, (char)i);
+	}
+	for (i = 0; i < 10; i++)
+	{
+		sdhmap_set(c, names[i], (int64_t)i << 40);
+	}
+	for (i = 0; i < 100; i++)
+	{
+		ok &= *sdhmap_getp(a, names[i]) == i;
+		ok &= *sdhmap_getp(b, (uint8_t)i) == i / 4.0;
+		ok &= *sdhmap_getp(d, i / 2.0) == (char)i;
+		ok &= ((uintptr_t)sdhmap_getp(b, (uint8_t)i) % _Alignof(double)) == 0;
+	}
+	for (i = 0; i < 10; i++)
+	{
+		ok &= *sdhmap_getp(c, names[i]) == (int64_t)i << 40;
+	}
+	strcatf(solution, "%d %d %d %d %d ", ok, (int)sdhmap_count(a), (int)sdhmap_count(b),
+		(int)sdhmap_count(c), (int)sdhmap_count(d));
+	/*Iterated keys find their values without hashing*/
+	i = 0;
+	key = sdhmap_first(a);
+	while (key)
+	{
+		ok &= ((uintptr_t)key % _Alignof(char *)) == 0;
+		i += sdhmap_get(a, key);
+		key = sdhmap_next(a, key);
+	}
+	strcatf(solution, "%d %d", ok, i);
+	sdhmap_delete(a);
+	sdhmap_delete(b);
+	sdhmap_delete(d);
+}
+
+/*Value pointers survive unlinking keys from the middle and the head of a chain*/
+void test_3(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	int ok = 1;
+	int key;
+	int found = 1;
+	int keys[3] = {0};
+	int *values[3];
+	sdhmap_index bucket;
+	sdhmap_header *map;
+	sdhmap_stable(int, int) x = NULL;
+	sdhmap_stable_set(x, keys[0], 0);
+	map = ((sdhmap_stable_header *)x)->map;
+	bucket = map->hash_func(&keys[0]) % map->slot_count;
+	for (key = 1; found < 3; key++)
+	{
+		if (map->hash_func(&key) % map->slot_count == bucket)
+		{
+			keys[found++] = key;
+		}
+	}
+	for (i = 0; i < 3; i++)
+	{
+		values[i] = &sdhmap_stable_get(x, keys[i]);
+		*values[i] = keys[i] * 10;
+	}
+	sdhmap_stable_erase(x, keys[1]);
+	ok &= sdhmap_stable_getp(x, keys[0]) == values[0] && sdhmap_stable_getp(x, keys[2]) == values[2];
+	sdhmap_stable_erase(x, keys[0]);
+	ok &= sdhmap_stable_getp(x, keys[2]) == values[2] && *values[2] == keys[2] * 10;
+	ok &= map == ((sdhmap_stable_header *)x)->map;
+	strcatf(solution, "%d %d %d ", ok, (int)sdhmap_stable_count(x), sdhmap_stable_contains(x, keys[1]));
+	/*Erased values are handed out again, the latest first*/
+	ok = &sdhmap_stable_get(x, keys[1]) == values[0];
+	ok &= &sdhmap_stable_get(x, keys[0]) == values[1];
+	strcatf(solution, "%d", ok);
+	sdhmap_stable_delete(x);
+}
+
+/*Duplicating into inline-type maps that were never constructed*/
+void test_4(char solution[TEST_MAX_SIZE])
+{
+	sdhmap_inline(int, int, 8) a;
+	sdhmap_inline(int, int, 8) b;
+	sdhmap(int, int) c = NULL;
+	int i;
+	memset(&a, 0xa5, sizeof(a));
+	memset(&b, 0xa5, sizeof(b));
+	for (i = 0; i < 4; i++)
+	{
+		sdhmap_set(c, i, i * 2);
+	}
+	sdhmap_duplicate(a, c);
+	strcatf(solution, "%d %d %d ", (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a), sdhmap_get(a, 3));
+	for (i = 4; i < 20; i++)
+	{
+		sdhmap_set(c, i, i * 2);
+	}
+	sdhmap_duplicate(b, c);
+	strcatf(solution, "%d %d %d ", (int)sdhmap_count(b), detail_sdhmap_inline_in_place(b), sdhmap_get(b, 19));
+	for (i = 4; i < 20; i++)
+	{
+		sdhmap_erase(b, i);
+	}
+	sdhmap_shrink(b);
+	strcatf(solution, "%d %d %d", (int)sdhmap_count(b), detail_sdhmap_inline_in_place(b), sdhmap_get(b, 3));
+	sdhmap_delete(a);
+	sdhmap_delete(b);
+	sdhmap_delete(c);
+}
+
+/*A byte copy of an in-place inline-type map is a separate map*/
+void test_5(char solution[TEST_MAX_SIZE])
+{
+	sdhmap_inline(int, int, 8) a;
+	sdhmap_inline(int, int, 8) b;
+	int i;
+	sdhmap_new(a);
+	for (i = 0; i < 4; i++)
+	{
+		sdhmap_set(a, i, i * 2);
+	}
+	memcpy(&b, &a, sizeof(a));
+	sdhmap_set(b, 1, 100);
+	sdhmap_erase(b, 0);
+	strcatf(solution, "%d %d %d %d ", (int)sdhmap_count(a), sdhmap_get(a, 1), (int)sdhmap_count(b), sdhmap_get(b, 1));
+	for (i = 4; i < 20; i++)
+	{
+		sdhmap_set(b, i, i * 2);
+	}
+	strcatf(solution, "%d %d %d %d", (int)sdhmap_count(a), detail_sdhmap_inline_in_place(a), (int)sdhmap_count(b), detail_sdhmap_inline_in_place(b));
+	sdhmap_delete(a);
+	sdhmap_delete(b);
+}
+
 const test_t tests[] =
 {
 	{"good", test_0},
+	{"8 1 100 0 1 5 1 5 1 0 1", test_1},
+	{"1 100 100 10 100 1 4950", test_2},
+	{"1 1 0 1", test_3},
+	{"4 1 6 20 0 38 4 1 6", test_4},
+	{"4 2 3 100 4 1 19 0", test_5},
 };
 
 void run_test(int i, char solution[TEST_MAX_SIZE])
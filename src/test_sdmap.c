@@ -1,5 +1,7 @@
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -32,6 +34,9 @@ void custom_free(void *initial)
 
 #include <sdmap.h>
 #include <sdmap_debug.h>
+#include <sdmap_shared.h>
+#include <sdmap_stable.h>
+#include <sdimap.h>
 
 #define TEST_MAX_SIZE 512
 
@@ -296,6 +301,768 @@ void test_8(char solution[TEST_MAX_SIZE])
 	}
 }
 
+/*Relayout keeps the map intact*/
+void test_9(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	sdmap(int, int) x = NULL;
+	for (i = 0; i < 10000; i++)
+	{
+		sdmap_set(x, (i * 7919) % 10000, i);
+	}
+	for (i = 0; i < 10000; i += 3)
+	{
+		sdmap_erase(x, i);
+	}
+	sdmap_relayout(x, SDMAP_LAYOUT_VEB);
+	submit_solution(x);
+	strcatf(solution, "%d ", *sdmap_root(x) == *(int *)((char *)x + sizeof(sdmap_header) + sizeof(sdmap_slot)));
+	for (i = 0; i < 10000; i++)
+	{
+		if (sdmap_contains(x, i) != (i % 3 != 0))
+		{
+			strcat(solution, "missing ");
+			break;
+		}
+	}
+	sdmap_relayout(x, SDMAP_LAYOUT_BFS);
+	submit_solution(x);
+	sdmap_set(x, 0, 0);
+	submit_solution(x);
+	strcatf(solution, "%d", (int)sdmap_count(x));
+	sdmap_delete(x);
+}
+
+/*Frozen maps answer the same queries as the map they were built from*/
+void test_10(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	const int *key;
+	sdmap(int, int) x = NULL;
+	sdmap(int, int) y = NULL;
+	sdmap_frozen(int, int) f = NULL;
+	strcatf(solution, "%d ", (int)sdmap_frozen_count(f));
+	for (i = 0; i < 1000; i++)
+	{
+		sdmap_set(x, i * 2, i);
+	}
+	sdmap_freeze(f, x);
+	sdmap_delete(x);
+	strcatf(solution, "%d ", (int)sdmap_frozen_count(f));
+	for (i = 0; i < 2000; i++)
+	{
+		if (sdmap_frozen_contains(f, i) != (i % 2 == 0) ||
+			(i % 2 == 0 && *sdmap_frozen_getp(f, i) != i / 2))
+		{
+			strcat(solution, "missing ");
+			break;
+		}
+	}
+	key = sdmap_frozen_lower_bound(f, 7);
+	strcatf(solution, "%d ", *key);
+	key = sdmap_frozen_lower_bound(f, -5);
+	strcatf(solution, "%d ", *key);
+	strcatf(solution, "%d ", sdmap_frozen_lower_bound(f, 1999) == NULL);
+	sdmap_thaw(y, f);
+	sdmap_frozen_delete(f);
+	submit_solution(y);
+	strcatf(solution, "%d %d", (int)sdmap_count(y), sdmap_get(y, 1998));
+	sdmap_delete(y);
+}
+
+void test_11_sum(const void *key, void *value, const void *source_value)
+{
+	(void)key;
+	*(int *)value += *(const int *)source_value;
+}
+
+/*Merge, intersection and difference*/
+void test_11(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	sdmap(int, int) x = NULL;
+	sdmap(int, int) y = NULL;
+	sdmap(int, int) z = NULL;
+	sdmap_merge(x, y, NULL);
+	strcatf(solution, "%d ", x == NULL);
+	for (i = 0; i < 100; i++)
+	{
+		sdmap_set(x, i, i);
+		sdmap_set(y, i + 50, i + 1050);
+	}
+	sdmap_merge(x, y, test_11_sum);
+	submit_solution(x);
+	strcatf(solution, "%d %d %d ", (int)sdmap_count(x), sdmap_get(x, 60), sdmap_get(x, 120));
+	sdmap_merge(z, y, NULL);
+	submit_solution(z);
+	strcatf(solution, "%d ", (int)sdmap_count(z));
+	sdmap_delete(y);
+	for (i = 0; i < 200; i += 10)
+	{
+		sdmap_set(y, i, 0);
+	}
+	sdmap_intersect(x, y);
+	submit_solution(x);
+	strcatf(solution, "%d ", (int)sdmap_count(x));
+	sdmap_difference(x, z);
+	submit_solution(x);
+	strcatf(solution, "%d %d", (int)sdmap_count(x), *sdmap_max(x));
+	sdmap_delete(x);
+	sdmap_delete(y);
+	sdmap_delete(z);
+}
+
+typedef sdmap(int, int) test_12_map;
+
+/*Split, join and range erase*/
+void test_12(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	test_12_map x = NULL;
+	test_12_map l = NULL;
+	test_12_map r = NULL;
+	for (i = 0; i < 1000; i++)
+	{
+		sdmap_set(x, (i * 7919) % 1000, i);
+	}
+	sdmap_split(x, 300, l, r);
+	submit_solution(l);
+	submit_solution(r);
+	strcatf(solution, "%d %d %d %d %d ", x == NULL, (int)sdmap_count(l), (int)sdmap_count(r), *sdmap_max(l), *sdmap_min(r));
+	sdmap_join(l, r);
+	submit_solution(l);
+	strcatf(solution, "%d %d ", (int)sdmap_count(l), r == NULL);
+	for (i = 0; i < 1000; i += 37)
+	{
+		sdmap_split(l, i, x, r);
+		sdmap_join(x, r);
+		l = x;
+		x = NULL;
+	}
+	submit_solution(l);
+	sdmap_erase_range(l, 100, 900);
+	submit_solution(l);
+	strcatf(solution, "%d %d %d %d %d ", (int)sdmap_count(l),
+		sdmap_contains(l, 99), sdmap_contains(l, 100), sdmap_contains(l, 899), sdmap_contains(l, 900));
+	for (i = 0; i < 1000; i++)
+	{
+		sdmap_set(l, i, i);
+	}
+	submit_solution(l);
+	sdmap_erase_range(l, -1, 1000);
+	submit_solution(l);
+	sdmap_set(l, 5, 5);
+	submit_solution(l);
+	strcatf(solution, "%d", (int)sdmap_count(l));
+	sdmap_delete(l);
+}
+
+typedef struct test_13_pair
+{
+	int major;
+	int minor;
+} test_13_pair;
+
+static int test_13_pair_compare(test_13_pair a, test_13_pair b)
+{
+	if (a.major != b.major)
+	{
+		return SDMAP_COMPARE_NATURAL(a.major, b.major);
+	}
+	return SDMAP_COMPARE_NATURAL(a.minor, b.minor);
+}
+
+SDMAP_DEFINE(test_13_int_map, int, int, SDMAP_COMPARE_NATURAL);
+
+SDMAP_DEFINE(test_13_pair_map, test_13_pair, int, test_13_pair_compare);
+
+/*Generated maps*/
+void test_13(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	test_13_int_map x = NULL;
+	test_13_pair_map y = NULL;
+	strcatf(solution, "%d ", test_13_int_map_contains(x, 5));
+	for (i = 0; i < 10000; i++)
+	{
+		test_13_int_map_set(&x, (i * 7919) % 10000, i);
+		test_13_pair_map_set(&y, (test_13_pair){i % 10, i / 10}, i);
+	}
+	submit_solution(x);
+	submit_solution(y);
+	for (i = 0; i < 10000; i += 2)
+	{
+		test_13_int_map_erase(&x, i);
+		test_13_pair_map_erase(&y, (test_13_pair){i % 10, i / 10});
+	}
+	submit_solution(x);
+	submit_solution(y);
+	*test_13_int_map_get(&x, 1) += 1;
+	strcatf(solution, "%d %d %d %d ", (int)sdmap_count(x), test_13_int_map_contains(x, 4),
+		*test_13_int_map_getp(x, 7919 % 10000), *test_13_int_map_getp(x, 1));
+	strcatf(solution, "%d %d %d", (int)sdmap_count(y), sdmap_min(y)->major,
+		*test_13_pair_map_getp(y, (test_13_pair){3, 7}));
+	sdmap_delete(x);
+	sdmap_delete(y);
+}
+
+/*String keys with inline prefixes*/
+void test_14(char solution[TEST_MAX_SIZE])
+{
+	static const char *urls[] =
+	{
+		"https://example.com/b",
+		"https://example.com/a",
+		"https://example.org",
+		"https://",
+		"https:/",
+		"http://example.com",
+		"https://example.com/a/1",
+		"",
+	};
+	int i;
+	const sdmap_pstr *key;
+	sdmap(sdmap_pstr, int64_t) x = NULL;
+	for (i = 0; i < (int)(sizeof(urls) / sizeof(*urls)); i++)
+	{
+		sdmap_set(x, sdmap_pstr_from(urls[i]), i);
+	}
+	submit_solution(x);
+	key = sdmap_min(x);
+	while (key)
+	{
+		strcatf(solution, "%d ", (int)sdmap_get(x, key));
+		key = sdmap_next(x, key);
+	}
+	sdmap_erase(x, sdmap_pstr_from("https://example.com/a"));
+	submit_solution(x);
+	strcatf(solution, "%d %d %d", (int)sdmap_count(x),
+		sdmap_contains(x, sdmap_pstr_from("https://example.com/a")),
+		sdmap_contains(x, sdmap_pstr_from("https://example.com/a/1")));
+	sdmap_delete(x);
+}
+
+/*Shared maps read without locks*/
+void test_15(char solution[TEST_MAX_SIZE])
+{
+	sdmap_shared(int, int) x = NULL;
+	int i;
+	int value;
+	int ok = 1;
+	strcatf(solution, "%d %d ", (int)sdmap_shared_count(x), sdmap_shared_contains(x, 1));
+	for (i = 0; i < 1000; i++)
+	{
+		sdmap_shared_set(x, i, i * 3);
+	}
+	sdmap_shared_set(x, 10, -1);
+	for (i = 0; i < 1000; i += 2)
+	{
+		sdmap_shared_erase(x, i);
+	}
+	for (i = 0; i < 1000; i++)
+	{
+		value = -2;
+		ok &= sdmap_shared_read(x, i, &value) == i % 2;
+		ok &= value == (i % 2 ? i * 3 : -2);
+	}
+	strcatf(solution, "%d %d %d ", ok, (int)sdmap_shared_count(x),
+		((sdmap_shared_header *)x)->retired_count > 0);
+	sdmap_shared_reclaim(x);
+	strcatf(solution, "%d %d", ((sdmap_shared_header *)x)->retired_count, sdmap_shared_contains(x, 999));
+	sdmap_shared_delete(x);
+}
+
+/*Multimaps with duplicate keys*/
+void test_16(char solution[TEST_MAX_SIZE])
+{
+	sdmultimap(int, int) x = NULL;
+	sdmultimap(int, int) y = NULL;
+	const int keys[] = {5, 1, 5, 3, 1, 5};
+	const int values[] = {0, 1, 2, 3, 4, 5};
+	const int *first;
+	const int *last;
+	const int *key;
+	int i;
+	int n = 0;
+	for (i = 0; i < 100; i++)
+	{
+		sdmultimap_insert(x, i % 10, i);
+	}
+	submit_solution(x);
+	sdmultimap_equal_range(x, 3, first, last);
+	for (key = first; key != last; key = sdmap_next(x, key))
+	{
+		n++;
+	}
+	strcatf(solution, "%d %d %d %d ", (int)sdmultimap_count(x, 3), *sdmap_getp(x, first), *sdmap_getp(x, sdmap_prev(x, last)), n);
+	sdmap_erase(x, first);
+	submit_solution(x);
+	strcatf(solution, "%d %d ", (int)sdmultimap_count(x, 3), (int)sdmap_count(x));
+	sdmultimap_equal_range(x, 42, first, last);
+	strcatf(solution, "%d %d ", first == NULL, last == NULL);
+	sdmultimap_equal_range(x, -1, first, last);
+	strcatf(solution, "%d ", first != NULL && first == last);
+	sdmultimap_insert_many(y, keys, values, 6);
+	submit_solution(y);
+	sdmultimap_insert_many(y, ((int[]){1, 9}), ((int[]){6, 7}), 2);
+	submit_solution(y);
+	for (key = sdmap_min(y); key; key = sdmap_next(y, key))
+	{
+		strcatf(solution, "%d ", *sdmap_getp(y, key));
+	}
+	strcatf(solution, "%d", (int)sdmultimap_count(y, 5));
+	sdmap_delete(x);
+	sdmap_delete(y);
+}
+
+void test_17_helper(const void *key, void *value, void *user)
+{
+	(void)key;
+	*(int *)user += *(int *)value;
+}
+
+/*Interval overlap and stabbing queries*/
+void test_17(char solution[TEST_MAX_SIZE])
+{
+	sdimap(int, int) x = NULL;
+	int starts[500];
+	int ends[500];
+	int i;
+	int j;
+	int sum;
+	int expected;
+	int ok = 1;
+	unsigned seed = 12345;
+	for (i = 0; i < 500; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		starts[i] = (int)((seed >> 8) % 10000);
+		ends[i] = starts[i] + 1 + (int)((seed >> 4) % 300);
+		sdimap_insert(x, starts[i], ends[i], i);
+	}
+	submit_solution(x);
+	for (j = 0; j < 2; j++)
+	{
+		for (i = 0; i < 10000; i += 97)
+		{
+			sum = 0;
+			sdimap_overlaps(x, i, i + 50, test_17_helper, &sum);
+			expected = 0;
+			for (int k = 0; k < 500; k++)
+			{
+				expected += starts[k] >= 0 && starts[k] < i + 50 && ends[k] > i ? k : 0;
+			}
+			ok &= sum == expected;
+			sum = 0;
+			sdimap_stab(x, i, test_17_helper, &sum);
+			expected = 0;
+			for (int k = 0; k < 500; k++)
+			{
+				expected += starts[k] >= 0 && starts[k] <= i && ends[k] > i ? k : 0;
+			}
+			ok &= sum == expected;
+		}
+		for (i = 0; i < 500; i += 2)
+		{
+			sdimap_erase(x, starts[i], ends[i]);
+			starts[i] = -1;
+		}
+		submit_solution(x);
+	}
+	sum = 0;
+	sdimap_stab(x, -1, test_17_helper, &sum);
+	strcatf(solution, "%d %d %d", ok, (int)sdmap_count(x), sum);
+	sdmap_delete(x);
+}
+
+/*Small maps as sorted arrays that turn into trees*/
+void test_18(char solution[TEST_MAX_SIZE])
+{
+	sdmap_small(int, double) x = NULL;
+	sdmap_small(char *, int) y = NULL;
+	char *names[] = {"pear", "apple", "fig", "kiwi", "banana"};
+	const int *key;
+	char *const *name;
+	int i;
+	int ok = 1;
+	int previous = -1;
+	for (i = 99; i >= 0; i -= 3)
+	{
+		sdmap_small_set(x, i, i * 0.5);
+	}
+	strcatf(solution, "%d %d ", (int)sdmap_small_count(x), ((sdmap_small_header *)x)->tree == NULL);
+	for (i = 0; i < 100; i++)
+	{
+		sdmap_small_set(x, i, i * 0.5);
+	}
+	strcatf(solution, "%d %d ", (int)sdmap_small_count(x), ((sdmap_small_header *)x)->tree == NULL);
+	for (i = 0; i < 100; i += 2)
+	{
+		sdmap_small_erase(x, i);
+	}
+	for (key = sdmap_small_min(x); key; key = sdmap_small_next(x, key))
+	{
+		ok &= *key > previous && *key % 2 && *sdmap_small_getp(x, key) == *key * 0.5;
+		previous = *key;
+	}
+	strcatf(solution, "%d %d %d ", ok, (int)sdmap_small_count(x), sdmap_small_contains(x, 50));
+	for (i = 0; i < 5; i++)
+	{
+		sdmap_small_set(y, names[i], i);
+	}
+	sdmap_small_erase(y, "kiwi");
+	for (name = sdmap_small_min(y); name; name = sdmap_small_next(y, name))
+	{
+		strcatf(solution, "%s%d ", *name, *sdmap_small_getp(y, name));
+	}
+	strcatf(solution, "%d %d", (int)sdmap_small_count(y), sdmap_small_contains(y, "fig"));
+	sdmap_small_delete(x);
+	sdmap_small_delete(y);
+}
+
+/*Test inline-type maps moving to the heap and back*/
+void test_19(char solution[TEST_MAX_SIZE])
+{
+	sdmap_inline(int, int, 8) x;
+	sdmap_inline(int, int, 8) y;
+	sdmap(int, int) z = NULL;
+	int i;
+	int ok = 1;
+	sdmap_new(x);
+	sdmap_new(y);
+	for (i = 0; i < 8; i++)
+	{
+		sdmap_set(x, i, i * i);
+	}
+	strcatf(solution, "%d %d ", (int)sdmap_count(x), detail_sdmap_inline_in_place(x));
+	for (i = 8; i < 100; i++)
+	{
+		sdmap_set(x, i, i * i);
+	}
+	strcatf(solution, "%d %d ", (int)sdmap_count(x), detail_sdmap_inline_in_place(x));
+	for (i = 0; i < 100; i++)
+	{
+		ok &= *sdmap_getp(x, i) == i * i;
+	}
+	for (i = 8; i < 100; i++)
+	{
+		sdmap_erase(x, i);
+	}
+	sdmap_shrink(x);
+	strcatf(solution, "%d %d %d ", ok, (int)sdmap_count(x), detail_sdmap_inline_in_place(x));
+	for (i = 0; i < 20; i += 2)
+	{
+		sdmap_set(z, i, -i);
+	}
+	sdmap_duplicate(y, z);
+	strcatf(solution, "%d %d ", (int)sdmap_count(y), detail_sdmap_inline_in_place(y));
+	sdmap_merge(x, z, NULL);
+	strcatf(solution, "%d %d %d ", (int)sdmap_count(x), detail_sdmap_inline_in_place(x), sdmap_get(x, 4));
+	sdmap_difference(x, y);
+	strcatf(solution, "%d %d ", (int)sdmap_count(x), detail_sdmap_inline_in_place(x));
+	sdmap_delete(y);
+	strcatf(solution, "%d %d", (int)sdmap_count(y), detail_sdmap_inline_in_place(y));
+	sdmap_delete(x);
+	sdmap_delete(z);
+}
+
+/*Parent and height accessors, whether or not the slots are packed*/
+void test_20(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	uint16_t key;
+	sdmap_slot slot;
+	sdmap(uint16_t, uint16_t) x = NULL;
+	memset(&slot, 0, sizeof(slot));
+	detail_sdmap_set_parent(&slot, (sdmap_index)-1);
+	detail_sdmap_set_height(&slot, 12);
+	strcatf(solution, "%d %d ", detail_sdmap_parent(&slot) == (sdmap_index)-1, (int)detail_sdmap_height(&slot));
+	detail_sdmap_set_parent(&slot, 1000);
+	detail_sdmap_set_height(&slot, -1);
+	strcatf(solution, "%d %d ", (int)detail_sdmap_parent(&slot), (int)detail_sdmap_height(&slot));
+	for (i = 0; i < 2000; i++)
+	{
+		key = (uint16_t)(i * 7919 % 2000);
+		sdmap_set(x, key, (uint16_t)i);
+	}
+	submit_solution(x);
+	for (i = 0; i < 2000; i += 2)
+	{
+		key = (uint16_t)i;
+		sdmap_erase(x, key);
+	}
+	submit_solution(x);
+	key = 7919 % 2000;
+	strcatf(solution, "%d %d", (int)sdmap_count(x), (int)sdmap_get(x, key));
+	sdmap_delete(x);
+}
+
+SDMAP_DEFINE(test_21_map, char, double, SDMAP_COMPARE_NATURAL);
+
+/*Values aligned stricter than the key that precedes them*/
+void test_21(char solution[TEST_MAX_SIZE])
+{
+	sdmap(uint8_t, double) a = NULL;
+	sdmap_stack(int8_t, int64_t, 16) b;
+	sdmap_inline(double, char, 4) c;
+	sdmap_small(uint8_t, double) d = NULL;
+	test_21_map e = NULL;
+	int i;
+	int ok = 1;
+	sdmap_new(b);
+	sdmap_new(c);
+	for (i = 0; i < 100; i++)
+	{
+		sdmap_set(a, (uint8_t)i, i / 4.0);
+		sdmap_set(c, i / 2.0, (char)i);
+		sdmap_small_set(d, (uint8_t)i, i / 4.0);
+		test_21_map_set(&e, (char)i, i / 4.0);
+	}
+	for (i = 0; i < 10; i++)
+	{
+		sdmap_set(b, (int8_t)i, (int64_t)i << 40);
+	}
+	/*Erasing nodes with two children moves keys and values between slots*/
+	for (i = 0; i < 100; i += 3)
+	{
+		sdmap_erase(a, (uint8_t)i);
+		test_21_map_erase(&e, (char)i);
+	}
+	for (i = 0; i < 100; i++)
+	{
+		if (i % 3 != 0)
+		{
+			ok &= *sdmap_getp(a, (uint8_t)i) == i / 4.0;
+			ok &= ((uintptr_t)sdmap_getp(a, (uint8_t)i) % _Alignof(double)) == 0;
+			ok &= *test_21_map_getp(e, (char)i) == i / 4.0;
+		}
+		ok &= *sdmap_getp(c, i / 2.0) == (char)i;
+		ok &= *sdmap_small_getp(d, (uint8_t)i) == i / 4.0;
+	}
+	for (i = 0; i < 10; i++)
+	{
+		ok &= *sdmap_getp(b, (int8_t)i) == (int64_t)i << 40;
+	}
+	strcatf(solution, "%d %d %d %d %d %d", ok, (int)sdmap_count(a), (int)sdmap_count(b),
+		(int)sdmap_count(c), (int)sdmap_small_count(d), (int)sdmap_count(e));
+	sdmap_delete(a);
+	sdmap_delete(c);
+	sdmap_small_delete(d);
+	sdmap_delete(e);
+}
+
+/*Value pointers survive erasing a node with two children, which moves its successor*/
+void test_22(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	int ok = 1;
+	int root;
+	int two_children;
+	int *values[64];
+	int *reused;
+	uint32_t slot_size;
+	sdmap_slot *slot;
+	sdmap_header *map;
+	sdmap_stable(int, int) x = NULL;
+	slot_size = sizeof(x[0].type_data->slot);
+	for (i = 0; i < 64; i++)
+	{
+		values[i] = &sdmap_stable_get(x, i);
+		*values[i] = i * 10;
+	}
+	map = ((sdmap_stable_header *)x)->map;
+	slot = detail_sdmap_slot(map, map->root_slot);
+	root = *(int *)((char *)slot + map->key_offset);
+	two_children = slot->left != map->root_slot && slot->right != map->root_slot;
+	sdmap_stable_erase(x, root);
+	for (i = 0; i < 64; i++)
+	{
+		if (i != root)
+		{
+			ok &= sdmap_stable_getp(x, i) == values[i] && *values[i] == i * 10;
+		}
+	}
+	reused = &sdmap_stable_get(x, 100);
+	strcatf(solution, "%d %d %d %d %d", two_children, ok, sdmap_stable_contains(x, root),
+		reused == values[root], (int)sdmap_stable_count(x));
+	sdmap_stable_delete(x);
+}
+
+/*Looking up many keys at once matches looking them up one by one*/
+void test_23(char solution[TEST_MAX_SIZE])
+{
+	int i;
+	int ok;
+	int found;
+	int keys[300];
+	int *values[300];
+	sdmap(int, int) x = NULL;
+	for (i = 0; i < 300; i++)
+	{
+		keys[i] = (i * 37) % 1001;
+	}
+	sdmap_getp_many(x, keys, 300, values);
+	ok = values[0] == NULL && values[299] == NULL;
+	for (i = 0; i < 2000; i += 2)
+	{
+		sdmap_set(x, i, i * 3);
+	}
+	sdmap_getp_many(x, keys, 300, values);
+	found = 0;
+	for (i = 0; i < 300; i++)
+	{
+		ok &= values[i] == sdmap_getp(x, keys[i]);
+		found += values[i] != NULL;
+	}
+	sdmap_getp_many(x, keys, 5, values);
+	strcatf(solution, "%d %d %d %d", ok, found, *values[0], values[1] == NULL);
+	sdmap_delete(x);
+}
+
+sdmap_shared(int, int) test_24_map = NULL;
+
+atomic_int test_24_done;
+
+void *test_24_reader(void *arg)
+{
+	int i;
+	int value;
+	int *ok = arg;
+	*ok = 1;
+	while (!atomic_load(&test_24_done))
+	{
+		for (i = 0; i < 4000; i++)
+		{
+			if (sdmap_shared_read(test_24_map, i, &value))
+			{
+				*ok &= value == i * 3;
+			}
+			else
+			{
+				*ok &= i % 2 == 0;
+			}
+		}
+	}
+	return NULL;
+}
+
+/*Shared maps read by four threads while one thread writes*/
+void test_24(char solution[TEST_MAX_SIZE])
+{
+	pthread_t readers[4];
+	int reader_ok[4];
+	int round;
+	int i;
+	int ok = 1;
+	for (i = 1; i < 4000; i += 2)
+	{
+		sdmap_shared_set(test_24_map, i, i * 3);
+	}
+	atomic_init(&test_24_done, 0);
+	for (i = 0; i < 4; i++)
+	{
+		pthread_create(&readers[i], NULL, test_24_reader, &reader_ok[i]);
+	}
+	for (round = 0; round < 20; round++)
+	{
+		for (i = 0; i < 4000; i += 2)
+		{
+			sdmap_shared_set(test_24_map, i, i * 3);
+		}
+		for (i = 0; i < 4000; i += 2)
+		{
+			sdmap_shared_erase(test_24_map, i);
+		}
+	}
+	atomic_store(&test_24_done, 1);
+	for (i = 0; i < 4; i++)
+	{
+		pthread_join(readers[i], NULL);
+		ok &= reader_ok[i];
+	}
+	strcatf(solution, "%d %d ", ok, (int)sdmap_shared_count(test_24_map));
+	sdmap_shared_reclaim(test_24_map);
+	strcatf(solution, "%d", ((sdmap_shared_header *)test_24_map)->retired_count);
+	sdmap_shared_delete(test_24_map);
+}
+
+/*Interval maps erased down to nothing and reused*/
+void test_25(char solution[TEST_MAX_SIZE])
+{
+	sdimap(int, int) x = NULL;
+	int sum;
+	sdimap_insert(x, 1, 5, 10);
+	sdimap_insert(x, 2, 6, 20);
+	sdimap_erase(x, 1, 5);
+	sdimap_erase(x, 2, 6);
+	strcatf(solution, "%d ", (int)sdmap_count(x));
+	sdimap_insert(x, 3, 4, 30);
+	sdimap_insert(x, 0, 9, 40);
+	sum = 0;
+	sdimap_stab(x, 3, test_17_helper, &sum);
+	strcatf(solution, "%d %d ", (int)sdmap_count(x), sum);
+	sum = 0;
+	sdimap_stab(x, 5, test_17_helper, &sum);
+	strcatf(solution, "%d", sum);
+	sdmap_delete(x);
+}
+
+/*Duplicating into inline-type maps that were never constructed*/
+void test_26(char solution[TEST_MAX_SIZE])
+{
+	sdmap_inline(int, int, 8) x;
+	sdmap_inline(int, int, 8) y;
+	sdmap(int, int) z = NULL;
+	int i;
+	memset(&x, 0xa5, sizeof(x));
+	memset(&y, 0xa5, sizeof(y));
+	for (i = 0; i < 4; i++)
+	{
+		sdmap_set(z, i, i * 2);
+	}
+	sdmap_duplicate(x, z);
+	strcatf(solution, "%d %d %d ", (int)sdmap_count(x), detail_sdmap_inline_in_place(x), sdmap_get(x, 3));
+	for (i = 4; i < 20; i++)
+	{
+		sdmap_set(z, i, i * 2);
+	}
+	sdmap_duplicate(y, z);
+	strcatf(solution, "%d %d %d ", (int)sdmap_count(y), detail_sdmap_inline_in_place(y), sdmap_get(y, 19));
+	for (i = 4; i < 20; i++)
+	{
+		sdmap_erase(y, i);
+	}
+	sdmap_shrink(y);
+	strcatf(solution, "%d %d %d", (int)sdmap_count(y), detail_sdmap_inline_in_place(y), sdmap_get(y, 3));
+	sdmap_delete(x);
+	sdmap_delete(y);
+	sdmap_delete(z);
+}
+
+/*A byte copy of an in-place inline-type map is a separate map*/
+void test_27(char solution[TEST_MAX_SIZE])
+{
+	sdmap_inline(int, int, 8) x;
+	sdmap_inline(int, int, 8) y;
+	int i;
+	sdmap_new(x);
+	for (i = 0; i < 4; i++)
+	{
+		sdmap_set(x, i, i * 2);
+	}
+	memcpy(&y, &x, sizeof(x));
+	sdmap_set(y, 1, 100);
+	sdmap_erase(y, 0);
+	strcatf(solution, "%d %d %d %d ", (int)sdmap_count(x), sdmap_get(x, 1), (int)sdmap_count(y), sdmap_get(y, 1));
+	for (i = 4; i < 20; i++)
+	{
+		sdmap_set(y, i, i * 2);
+	}
+	strcatf(solution, "%d %d %d %d", (int)sdmap_count(x), detail_sdmap_inline_in_place(x), (int)sdmap_count(y), detail_sdmap_inline_in_place(y));
+	sdmap_delete(x);
+	sdmap_delete(y);
+}
+
 const test_t tests[] =
 {
 	{"good", test_0},
@@ -307,6 +1074,25 @@ const test_t tests[] =
 	{"", test_6},
 	{"", test_7},
 	{"-4 0 6 8 11 14 14 11 8 6 0 -4 ", test_8},
+	{"1 6667", test_9},
+	{"0 1000 8 0 1 1000 999", test_10},
+	{"1 150 1120 1120 100 15 5 40", test_11},
+	{"1 300 700 299 300 1000 1 200 1 0 0 1 1", test_12},
+	{"0 5000 0 1 7680 5000 1 73", test_13},
+	{"7 5 4 3 1 6 0 2 7 0 1", test_14},
+	{"0 0 1 500 1 0 1", test_15},
+	{"10 3 93 10 9 99 1 1 1 1 4 6 3 0 2 5 7 3", test_16},
+	{"1 250 0", test_17},
+	{"34 0 100 0 1 50 0 apple1 banana4 fig2 pear0 4 1", test_18},
+	{"8 1 100 0 1 8 1 10 0 14 0 -4 4 1 0 1", test_19},
+	{"1 12 1000 -1 1000 1", test_20},
+	{"1 66 10 100 100 66", test_21},
+	{"1 1 0 1 64", test_22},
+	{"1 145 0 1", test_23},
+	{"1 2000 0", test_24},
+	{"0 2 70 40", test_25},
+	{"4 1 6 20 0 38 4 1 6", test_26},
+	{"4 2 3 100 4 1 19 0", test_27},
 };
 
 void run_test(int i, char solution[TEST_MAX_SIZE])
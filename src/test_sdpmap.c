@@ -0,0 +1,188 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdpmap.h>
+
+#define TEST_MAX_SIZE 512
+
+typedef void(*test_fun)(char [TEST_MAX_SIZE]);
+
+typedef struct test_t
+{
+	const char *solution;
+	test_fun test_function;
+} test_t;
+
+void strcatf(char *target, const char *format, ...)
+{
+	char buffer[4096];
+	va_list args;
+	va_start (args, format);
+	vsnprintf(buffer, 4096, format, args);
+	strcat(target, buffer);
+	va_end(args);
+}
+
+/*Test null initialization*/
+void test_0(char solution[TEST_MAX_SIZE])
+{
+	sdpmap(int, int) x = NULL;
+	sdpmap_snapshot(int, int) s = NULL;
+	strcatf(solution, "%d %d ", (int)sdpmap_count(x), sdpmap_contains(x, 5));
+	sdpmap_erase(x, 5);
+	sdpmap_reclaim(x);
+	sdpmap_delete(x);
+	sdpmap_snap(s, x);
+	strcatf(solution, "%d %d ", (int)sdpmap_count(s), sdpmap_contains(s, 5));
+	sdpmap_release(s);
+	sdpmap_delete(x);
+	if (x == NULL && s == NULL)
+	{
+		strcat(solution, "good");
+	}
+}
+
+/*Test that a snapshot keeps seeing the old version*/
+void test_1(char solution[TEST_MAX_SIZE])
+{
+	sdpmap(int, int) x = NULL;
+	sdpmap_snapshot(int, int) s = NULL;
+	int i;
+	int old_ok = 1;
+	int new_ok = 1;
+	for (i = 0; i < 1000; i++)
+	{
+		sdpmap_set(x, i, i);
+	}
+	sdpmap_snap(s, x);
+	for (i = 0; i < 1000; i++)
+	{
+		if (i % 2)
+		{
+			sdpmap_erase(x, i);
+		}
+		else
+		{
+			sdpmap_get(x, i) *= 2;
+		}
+	}
+	sdpmap_set(x, 5000, 1);
+	for (i = 0; i < 1000; i++)
+	{
+		old_ok &= *sdpmap_getp(s, i) == i;
+		new_ok &= i % 2 ? !sdpmap_contains(x, i) : *sdpmap_getp(x, i) == i * 2;
+	}
+	strcatf(solution, "%d %d %d %d %d %d", (int)sdpmap_count(s), (int)sdpmap_count(x),
+		old_ok, new_ok, sdpmap_contains(s, 5000), sdpmap_contains(x, 5000));
+	sdpmap_release(s);
+	sdpmap_delete(x);
+}
+
+/*Test that several snapshots see their own versions*/
+void test_2(char solution[TEST_MAX_SIZE])
+{
+	sdpmap(int, int) x = NULL;
+	sdpmap_snapshot(int, int) s[10] = {NULL};
+	sdpmap_snapshot(int, int) same = NULL;
+	int i;
+	int j;
+	int ok = 1;
+	for (i = 0; i < 10; i++)
+	{
+		for (j = 0; j < 100; j++)
+		{
+			sdpmap_set(x, j * 10 + i, i);
+		}
+		sdpmap_snap(s[i], x);
+	}
+	sdpmap_snap(same, x);
+	for (i = 0; i < 10; i++)
+	{
+		for (j = 0; j < 1000; j++)
+		{
+			ok &= sdpmap_contains(s[i], j) == (j % 10 <= i);
+		}
+		ok &= (int)sdpmap_count(s[i]) == (i + 1) * 100;
+	}
+	strcatf(solution, "%d %d ", ok, (void *)same == (void *)s[9]);
+	for (i = 9; i >= 0; i--)
+	{
+		sdpmap_release(s[i]);
+	}
+	sdpmap_release(same);
+	sdpmap_reclaim(x);
+	strcatf(solution, "%d", ((sdpmap_header *)x)->oldest == NULL);
+	sdpmap_delete(x);
+}
+
+/*Test that nodes of released snapshots are reused*/
+void test_3(char solution[TEST_MAX_SIZE])
+{
+	sdpmap(int, int) x = NULL;
+	sdpmap_snapshot(int, int) s = NULL;
+	int i;
+	int j;
+	int ok = 1;
+	for (i = 0; i < 1000; i++)
+	{
+		sdpmap_set(x, i, 0);
+	}
+	for (i = 1; i <= 200; i++)
+	{
+		sdpmap_snap(s, x);
+		for (j = 0; j < 50; j++)
+		{
+			sdpmap_set(x, (i * 37 + j * 101) % 1000, i);
+			sdpmap_erase(x, 1000 + i - 1);
+			sdpmap_set(x, 1000 + i, i);
+		}
+		ok &= sdpmap_count(s) == 1001 - (i == 1);
+		sdpmap_release(s);
+	}
+	strcatf(solution, "%d %d %d", ok, (int)sdpmap_count(x),
+		((sdpmap_header *)x)->node_count < 3000);
+	sdpmap_delete(x);
+}
+
+const test_t tests[] =
+{
+	{"0 0 0 0 good", test_0},
+	{"1000 501 1 1 0 1", test_1},
+	{"1 1 1", test_2},
+	{"1 1001 1", test_3},
+};
+
+void run_test(int i, char solution[TEST_MAX_SIZE])
+{
+	solution[0] = '\0';
+	tests[i].test_function(solution);
+}
+
+void run_all_tests(void)
+{
+	char solution[TEST_MAX_SIZE];
+	int i;
+	printf("\n---Running all tests for SDPMAP---\n");
+	for (i = 0; i < (int)(sizeof(tests) / sizeof(*tests)); i++)
+	{
+		printf("Running test #%d ...\n", i);
+		run_test(i, solution);
+		if (strcmp(solution, tests[i].solution) == 0)
+		{
+			printf("Test #%d -> Success\n", i);
+		}
+		else
+		{
+			printf("Test #%d -> Fail. Expected '%s'. Got '%s'.\n", i, tests[i].solution, solution);
+		}
+	}
+	printf("---Done---\n\n");
+}
+
+int main(void)
+{
+	run_all_tests();
+	return 0;
+}
@@ -29,6 +29,8 @@ void custom_free(void *initial)
 #define sdhmap_free custom_free
 
 #include <sdstr.h>
+#include <sdrope.h>
+#include <sdstr_intern.h>
 
 #define TEST_MAX_SIZE 512
 
@@ -64,11 +66,441 @@ void test_0(char solution[TEST_MAX_SIZE])
 	sdstr_contains(str, 'a');
 	sdstr_contains(str, "a");
 	sdstr_delete(str);
+	if (str == NULL && sdstr_size(str) == 0)
+	{
+		strcat(solution, "good");
+	}
+}
+
+void test_1(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	sdstr copy = NULL;
+	sdstr_new(str, "hello");
+	sdstr_push(str, ' ');
+	sdstr_push(str, "world");
+	sdstr_insert(str, 0, "<<");
+	sdstr_pushf(str, ">>%d", 42);
+	strcatf(solution, "%s %d %d ", str, (int)sdstr_size(str), sdstr_contains(str, "lo w"));
+	sdstr_erase(str, 0, 2);
+	sdstr_splice(str, sdstr_find(str, "world"), 5, "there");
+	strcatf(solution, "%s ", str);
+	strcatf(solution, "%c ", (char)sdstr_pop(str));
+	sdstr_replace_all(str, "e", "EE");
+	sdstr_replace_first(str, "h", "");
+	sdstr_substr(copy, str, sdstr_find_back(str, "t"), 4);
+	sdstr_reverse(copy);
+	strcatf(solution, "%s %s %d", str, copy, (int)(sdstr_find(str, 1, "EE") - str));
+	sdstr_delete(str);
+	sdstr_delete(copy);
+	strcatf(solution, " %d %d", (int)sdstr_size(str), str == NULL);
+}
+
+/*Small-type strs stay inside the object until they outgrow it*/
+void test_2(char solution[TEST_MAX_SIZE])
+{
+	sdstr_small str = {0};
+	sdstr_small copy;
+	int i;
+	for (i = 0; i < SDSTR_SMALL_CAPACITY; i++)
+	{
+		sdstr_push(str, 'a' + i);
+	}
+	strcatf(solution, "%d %d ", (int)sdstr_size(str), sdstr_data(str) == str.bytes);
+	sdstr_push(str, "xyz");
+	strcatf(solution, "%d %d %s ", (int)sdstr_size(str), sdstr_data(str) == str.bytes, sdstr_data(str) + 20);
+	sdstr_dup(copy, str);
+	sdstr_erase(str, 5, 100);
+	strcatf(solution, "%s %d %d ", sdstr_data(str), sdstr_data(str) == str.bytes, (int)sdstr_capacity(str));
+	strcatf(solution, "%d %c", (int)sdstr_size(copy), (char)sdstr_get(copy, 24));
+	sdstr_delete(str);
+	sdstr_delete(copy);
+}
+
+void test_3(char solution[TEST_MAX_SIZE])
+{
+	sdstr_stack(16) str;
+	sdstr_new(str, "a,b,c");
+	sdstr_replace_all(str, ",", ", ");
+	sdstr_set(str, 0, 'A');
+	strcatf(solution, "%s %d %d", str, (int)sdstr_size(str), (int)sdstr_capacity(str));
+}
+
+void test_4(char solution[TEST_MAX_SIZE])
+{
+	sdstr_utf8 str = NULL;
+	char *pos;
+	sdstr_new(str, "h\xc3\xa9llo w\xc3\xb6rld");
+	strcatf(solution, "%d %d %x ", (int)sdstr_size(str), (int)sdstr_count(str), (unsigned)sdstr_get(str, 1));
+	sdstr_set(str, 1, 0x20AC);
+	sdstr_push(str, 0x1F600);
+	strcatf(solution, "%d %d ", (int)sdstr_size(str), (int)sdstr_count(str));
+	strcatf(solution, "%x ", (unsigned)sdstr_pop(str));
+	sdstr_reverse(str);
+	pos = sdstr_getp(str, 0);
+	pos = sdstr_next(str, pos);
+	strcatf(solution, "%x %x ", (unsigned)sdstr_get(str, 2), (unsigned)sdstr_get(str, pos));
+	sdstr_erase(str, 0, 3);
+	strcatf(solution, "%d %x", (int)sdstr_count(str), (unsigned)sdstr_get(str, sdstr_last(str)));
+	sdstr_delete(str);
+}
+
+/*Long needles and periodic haystacks*/
+void test_5(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	char needle[41];
+	char *found;
+	int i;
+	for (i = 0; i < 200; i++)
+	{
+		sdstr_push(str, "ab");
+	}
+	memset(needle, 'a', 40);
+	needle[40] = '\0';
+	needle[39] = 'b';
+	strcatf(solution, "%d ", sdstr_contains(str, needle));
+	sdstr_splice(str, 250, 40, needle);
+	found = sdstr_find(str, needle);
+	strcatf(solution, "%d %d ", sdstr_contains(str, needle), (int)(found - str));
+	found = sdstr_find(str, "ababab");
+	strcatf(solution, "%d ", (int)(sdstr_find(str, found + 1, "ababab") - str));
+	found = sdstr_find_back(str, "bab");
+	strcatf(solution, "%d ", (int)(found - str));
+	strcatf(solution, "%d ", (int)(sdstr_find_back(str, 250, "bab") - str));
+	strcatf(solution, "%d", sdstr_find_back(str, 1, "bab") == NULL);
+	sdstr_delete(str);
+}
+
+void test_6(char solution[TEST_MAX_SIZE])
+{
+	sdstr_utf8 str = NULL;
+	int i;
+	strcatf(solution, "%d%d%d%d%d%d ",
+		sdstr_utf8_valid("a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"),
+		sdstr_utf8_valid("\xc0\xaf"),
+		sdstr_utf8_valid("\xed\xa0\x80"),
+		sdstr_utf8_valid("\xf4\x90\x80\x80"),
+		sdstr_utf8_valid("abc\xe2\x82"),
+		sdstr_utf8_valid("\x80"));
+	for (i = 0; i < 50; i++)
+	{
+		sdstr_push(str, "x\xc3\xa9\xe2\x82\xac");
+	}
+	strcatf(solution, "%d %d ", (int)sdstr_size(str), (int)sdstr_count(str));
+	sdstr_erase(str, 10, 100);
+	sdstr_insert(str, 0, "\xf0\x9f\x98\x80");
+	strcatf(solution, "%d %d", (int)sdstr_size(str), (int)sdstr_count(str));
+	sdstr_delete(str);
+}
+
+void test_7(char solution[TEST_MAX_SIZE])
+{
+	static const uint32_t characters[] = {0x61, 0xE9, 0x20AC, 0x1F600};
+	uint32_t expected[1000];
+	sdstr_utf8 str = NULL;
+	int mismatches;
+	int count;
+	int i;
+	for (i = 0; i < 1000; i++)
+	{
+		expected[i] = characters[i * 7 % 4];
+		sdstr_push(str, expected[i]);
+	}
+	mismatches = 0;
+	for (i = 999; i >= 0; i -= 3)
+	{
+		mismatches += sdstr_get(str, i) != expected[i];
+	}
+	/*Same amount of code points moves the offsets, others drop them*/
+	for (i = 0; i < 1000; i += 97)
+	{
+		expected[i] = 0x10348;
+		sdstr_set(str, i, expected[i]);
+	}
+	for (i = 0; i < 1000; i += 5)
+	{
+		mismatches += sdstr_get(str, i) != expected[i];
+	}
+	sdstr_erase(str, 500, 10);
+	sdstr_insert(str, 100, "xyz");
+	count = (int)sdstr_count(str);
+	for (i = 0; i < count; i++)
+	{
+		mismatches += sdstr_get(str, i) != (i < 100 ? expected[i] :
+			i < 103 ? (uint32_t)"xyz"[i - 100] :
+			i < 503 ? expected[i - 3] : expected[i + 7]);
+	}
+	strcatf(solution, "%d %d %d", mismatches, count, (int)sdstr_get(str, count - 1));
+	sdstr_delete(str);
+}
+
+void test_8(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	sdstr_utf8 utf8 = NULL;
+	int i;
+	sdstr_push(str, "aaaaa");
+	strcatf(solution, "%d ", (int)sdstr_replace_all(str, "aa", "b"));
+	strcatf(solution, "%s ", str);
+	strcatf(solution, "%d ", (int)sdstr_replace_all(str, 'b', "<a>"));
+	strcatf(solution, "%s ", str);
+	for (i = 0; i < 10000; i++)
+	{
+		sdstr_push(str, "x--");
+	}
+	strcatf(solution, "%d ", (int)sdstr_erase_all(str, "--"));
+	strcatf(solution, "%d %d ", (int)sdstr_size(str), (int)sdstr_count(str));
+	for (i = 0; i < 100; i++)
+	{
+		sdstr_push(utf8, "a\xc3\xa9" "b");
+	}
+	(void)sdstr_getp(utf8, 250);
+	strcatf(solution, "%d ", (int)sdstr_replace_all(utf8, "\xc3\xa9", "\xf0\x9f\x98\x80!"));
+	strcatf(solution, "%d %d %x", (int)sdstr_size(utf8), (int)sdstr_count(utf8),
+		(unsigned)sdstr_get(utf8, 250));
+	sdstr_delete(str);
+	sdstr_delete(utf8);
+}
+
+void test_9(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	sdstr_small small = {0};
+	sdstr_push_int(str, -9223372036854775807LL - 1);
+	sdstr_push(str, ' ');
+	sdstr_push_uint(str, 18446744073709551615ULL);
+	sdstr_push(str, ' ');
+	sdstr_push_int(str, 0);
+	sdstr_push(str, ' ');
+	sdstr_push_double(str, 0.1);
+	sdstr_push(str, ' ');
+	sdstr_push_double(str, -1.5e-7);
+	sdstr_push(str, ' ');
+	sdstr_push_double(str, 1e21);
+	sdstr_push(str, ' ');
+	sdstr_push_double(str, 123456.0);
+	sdstr_push(str, ' ');
+	sdstr_push_double(str, 5e-324);
+	strcatf(solution, "%s|", str);
+	sdstr_delete(str);
+	sdstr_push(small, "ab");
+	/*Formats from the str into itself*/
+	sdstr_insertf(small, 1, "[%s]", sdstr_data(small));
+	sdstr_insertf(small, 0, "%s%s%s", sdstr_data(small), sdstr_data(small), sdstr_data(small));
+	strcatf(solution, "%s %d", sdstr_data(small), (int)sdstr_capacity(small) > SDSTR_SMALL_CAPACITY);
+	sdstr_delete(small);
+}
+
+/*Test rope edits against the same edits on a str*/
+void test_10(char solution[TEST_MAX_SIZE])
+{
+	char buffer[64];
+	sdstr expected = NULL;
+	sdstr result = NULL;
+	sdrope rope = NULL;
+	sdstr_index index;
+	sdstr_index count;
+	uint32_t random;
+	int i;
+	for (i = 0; i < 3000; i++)
+	{
+		sdstr_push(expected, (char)('a' + i % 26));
+	}
+	sdrope_from_str(rope, expected);
+	random = 1;
+	for (i = 0; i < 2000; i++)
+	{
+		random = random * 1103515245u + 12345u;
+		index = (random >> 8) % (sdstr_size(expected) + 1);
+		count = (random >> 20) % 4 == 0 ? (random >> 4) % 2000 : (random >> 4) % 8;
+		sprintf(buffer, "%d", i);
+		sdrope_splice(rope, index, count, buffer);
+		sdstr_splice(expected, index, count, buffer);
+	}
+	sdrope_to_str(rope, result);
+	strcatf(solution, "%d ", sdstr_size(result) == sdstr_size(expected) &&
+		memcmp(result, expected, sdstr_size(expected)) == 0);
+	strcatf(solution, "%d ", sdrope_copy(rope, 5, 3, buffer) == 3 &&
+		memcmp(buffer, expected + 5, 3) == 0 && sdrope_get(rope, 5) == expected[5]);
+	sdrope_erase(rope, 0, sdrope_size(rope));
+	strcatf(solution, "%d %d", (int)sdrope_size(rope), rope == NULL);
+	sdrope_delete(rope);
+	sdstr_delete(expected);
+	sdstr_delete(result);
+}
+
+/*Test interning*/
+void test_11(char solution[TEST_MAX_SIZE])
+{
+	char buffer[32];
+	sdstr_intern pool = NULL;
+	sdhmap(sdhmap_index, int) counts = NULL;
+	sdhmap(const char *, int) hosts = NULL;
+	sdstr_view empty = {0};
+	const char *name;
+	sdhmap_index first;
+	const char *first_data;
+	int mismatches;
+	int i;
+	strcatf(solution, "%d %d ", (int)sdstr_intern_count(pool), (int)sdstr_intern_find(pool, "a"));
+	first_data = sdstr_intern_data(pool, sdstr_intern_get(pool, "host-0"));
+	sdhmap_new(counts);
+	mismatches = 0;
+	for (i = 0; i < 30000; i++)
+	{
+		sprintf(buffer, "host-%d", i % 10000);
+		first = sdstr_intern_get(pool, buffer);
+		if (!sdhmap_contains(counts, first))
+		{
+			sdhmap_set(counts, first, 0);
+		}
+		sdhmap_get(counts, first)++;
+		mismatches += strcmp(sdstr_intern_data(pool, sdstr_intern_find(pool, buffer)), buffer) != 0;
+	}
+	strcatf(solution, "%d %d %d ", (int)sdstr_intern_count(pool), (int)sdhmap_count(counts), mismatches);
+	strcatf(solution, "%d %d ", first_data == sdstr_intern_data(pool, 1),
+		sdhmap_get(counts, sdstr_intern_find(pool, "host-9999")));
+	strcatf(solution, "%d ", (int)sdstr_intern_find(pool, "host-10000"));
+	strcatf(solution, "%d ", (int)sdstr_intern_get(pool, 'x'));
+	strcatf(solution, "%d ", (int)sdstr_intern_get(pool, ""));
+	strcatf(solution, "%d ", (int)sdstr_intern_size(pool, sdstr_intern_get(pool, "host-123")));
+	sdhmap_new(hosts, sdstr_intern_ptr_hash, sdstr_intern_ptr_eq);
+	for (i = 0; i < 3000; i++)
+	{
+		sprintf(buffer, "host-%d", i % 1000);
+		name = sdstr_intern_str(pool, buffer);
+		if (!sdhmap_contains(hosts, name))
+		{
+			sdhmap_set(hosts, name, 0);
+		}
+		sdhmap_get(hosts, name)++;
+	}
+	name = sdstr_intern_str(pool, "host-7");
+	strcatf(solution, "%d %d %d ", name == sdstr_intern_str(pool, "host-7"),
+		name == sdstr_intern_data(pool, sdstr_intern_find(pool, "host-7")), strcmp(name, "host-7"));
+	strcatf(solution, "%d %d %d %d", (int)sdhmap_count(hosts), sdhmap_get(hosts, name),
+		*sdstr_intern_str(pool, "") == '\0', sdstr_intern_str(pool, empty) == sdstr_intern_str(pool, ""));
+	sdhmap_delete(hosts);
+	sdhmap_delete(counts);
+	sdstr_intern_delete(pool);
+}
+
+/*Test views*/
+void test_12(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	sdstr copy = NULL;
+	sdstr_utf8 utf8 = NULL;
+	sdstr_intern pool = NULL;
+	sdhmap(sdstr_view, int) fields = NULL;
+	sdstr_view view;
+	sdstr_view inner;
+	sdstr_view empty = {0};
+	sdstr_push(str, "key=value; other=thing");
+	view = sdstr_view_substr(str, 4, 5);
+	inner = sdstr_view_substr(view, 1, 100);
+	strcatf(solution, "%d %d %d ", (int)sdstr_size(view), (int)sdstr_size(inner),
+		view.data == str + 4);
+	strcatf(solution, "%d %d %d %d ", sdstr_compare(view, "value"),
+		sdstr_compare(view, "valuex") < 0, sdstr_compare(view, "valu") > 0,
+		sdstr_compare(str, view) < 0);
+	strcatf(solution, "%d %d %d %c ", (int)(sdstr_find(view, 'u') - view.data),
+		sdstr_contains(view, "other"), (int)(sdstr_find_back(inner, "a") - inner.data),
+		(char)sdstr_get(view, 1));
+	strcatf(solution, "%d %d ", (int)sdstr_size(empty), sdstr_find(empty, "a") == NULL);
+	sdstr_substr(copy, inner, 0, 3);
+	sdstr_push(copy, view);
+	sdstr_insert(str, 0, sdstr_view_substr(str, 4, 5));
+	strcatf(solution, "%s %s ", copy, str);
+	sdstr_push(utf8, "a\xc3\xa9\xe2\x82\xac" "b");
+	view = sdstr_view_substr(utf8, 1, 2);
+	strcatf(solution, "%d %d ", (int)sdstr_size(view), (int)sdstr_count(view));
+	strcatf(solution, "%d", sdstr_intern_get(pool, "value") ==
+		sdstr_intern_get(pool, sdstr_view_substr(str, 0, 5)));
+	sdhmap_new(fields, sdstr_view_hash, sdstr_view_eq);
+	sdhmap_set(fields, sdstr_view_substr(str, 5, 3), 1);
+	sdhmap_set(fields, sdstr_view_substr(str, 16, 5), 2);
+	view = sdstr_view_substr(copy, 5, 3);
+	sdhmap_set(fields, &view, 3);
+	view = (sdstr_view){"key", 3};
+	inner = (sdstr_view){"other", 5};
+	strcatf(solution, " %d %d %d", (int)sdhmap_count(fields), sdhmap_get(fields, &view),
+		sdhmap_contains(fields, &inner));
+	sdstr_replace_all(copy, "a", empty);
+	sdstr_push(copy, empty);
+	strcatf(solution, " %s", copy);
+	sdhmap_delete(fields);
+	sdstr_delete(str);
+	sdstr_delete(copy);
+	sdstr_delete(utf8);
+	sdstr_intern_delete(pool);
+}
+
+/*Test splitting*/
+void test_13(char solution[TEST_MAX_SIZE])
+{
+	sdstr str = NULL;
+	sdstr empty = NULL;
+	sdstr_utf8 utf8 = NULL;
+	sdstr_split split;
+	sdstr_view field;
+	int count;
+	int total;
+	int i;
+	sdstr_push(str, "a,b,,c\t");
+	split = sdstr_split_iter(str, ",\t");
+	while (sdstr_split_next(split, field))
+	{
+		strcatf(solution, "[%.*s]", (int)field.size, field.data);
+	}
+	strcatf(solution, " %d ", sdstr_split_next(split, field));
+	split = sdstr_split_iter(empty, ',');
+	count = 0;
+	while (sdstr_split_next(split, field))
+	{
+		count++;
+	}
+	strcatf(solution, "%d ", count);
+	sdstr_delete(str);
+	for (i = 0; i < 1000; i++)
+	{
+		sdstr_push(str, i % 7 == 0 ? '\xff' : i % 5 == 0 ? ';' : 'x');
+	}
+	split = sdstr_split_iter(str, "\xff;");
+	count = 0;
+	total = 0;
+	while (sdstr_split_next(split, field))
+	{
+		count++;
+		total += (int)field.size;
+	}
+	strcatf(solution, "%d %d ", count, total);
+	sdstr_push(utf8, "\xc3\xa9t\xc3\xa9 hiver");
+	split = sdstr_split_iter(utf8, ' ');
+	sdstr_split_next(split, field);
+	strcatf(solution, "%d %d", (int)sdstr_count(field), sdstr_compare(field, "\xc3\xa9t\xc3\xa9"));
+	sdstr_delete(str);
+	sdstr_delete(utf8);
 }
 
 const test_t tests[] =
 {
 	{"good", test_0},
+	{"<<hello world>>42 17 1 hello there>>42 2 EEllo thEErEE>>4 EEht 8 0 1", test_1},
+	{"22 1 25 0 uvxyz abcde 1 22 25 z", test_2},
+	{"A, b, c 7 16", test_3},
+	{"13 11 e9 18 12 1f600 72 6c 8 68", test_4},
+	{"0 1 250 2 397 247 1", test_5},
+	{"100000 300 150 104 51", test_6},
+	{"0 993 233", test_7},
+	{"2 bba 2 <a><a>a 10000 10007 10007 100 700 400 21", test_8},
+	{"-9223372036854775808 18446744073709551615 0 0.1 -1.5e-7 1e+21 123456 5e-324|"
+		"a[ab]ba[ab]ba[ab]ba[ab]b 1", test_9},
+	{"1 1 0 1", test_10},
+	{"0 0 10000 10000 0 1 3 0 10001 10002 8 1 1 0 1000 3 1 1", test_11},
+	{"5 4 1 0 1 1 1 3 0 0 a 0 1 aluvalue valuekey=value; other=thing 5 5 1 3 1 1 luvlue", test_12},
+	{"[a][b][][c][] 0 1 315 686 5 0", test_13},
 };
 
 void run_test(int i, char solution[TEST_MAX_SIZE])